@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cassert>
+#include <optional>
+#include <span>
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace MathUtils
+{
+
+/**
+ * A 3D affine transform p -> L * p + t stored as the top 3x4 block [L | t] of its homogeneous 4x4 matrix. The implied
+ * bottom row 0 0 0 1 is never stored or multiplied.
+ * @tparam T The element type.
+ */
+template<typename T>
+class Affine3
+{
+    static_assert(std::is_arithmetic_v<T>, "Affine3's template parameter T must be a numerical type.");
+
+public:
+    Matrix<T, 3, 4> matrix;
+
+    // Constructors
+    // The default transform is the identity.
+    constexpr Affine3() : matrix({{T(1), T(0), T(0), T(0)}, {T(0), T(1), T(0), T(0)}, {T(0), T(0), T(1), T(0)}})
+    {}
+
+    constexpr explicit Affine3(const Matrix<T, 3, 4> &matrix) : matrix(matrix)
+    {}
+
+    constexpr Affine3(const Matrix<T, 3, 3> &linear, const Vector<T, 3> &translation) : matrix()
+    {
+        for (size_t i = 0; i < 3; ++i) {
+            matrix[i] = Vector<T, 4>(linear[i]);
+            matrix(i, 3) = translation[i];
+        }
+    }
+
+    // The bottom row of the matrix must be 0 0 0 1.
+    constexpr explicit Affine3(const Matrix<T, 4, 4> &homogeneous) : matrix()
+    {
+        assert((homogeneous[3] == Vector<T, 4>(T(0), T(0), T(0), T(1))) && "Matrix is not affine.");
+        for (size_t i = 0; i < 3; ++i) {
+            matrix[i] = homogeneous[i];
+        }
+    }
+
+    static constexpr Affine3 identity()
+    {
+        return Affine3();
+    }
+
+    static constexpr Affine3 fromTranslation(const Vector<T, 3> &translation)
+    {
+        Affine3 result;
+        for (size_t i = 0; i < 3; ++i) {
+            result.matrix(i, 3) = translation[i];
+        }
+        return result;
+    }
+
+    // accessor methods
+    constexpr Matrix<T, 3, 3> linear() const
+    {
+        Matrix<T, 3, 3> result;
+        for (size_t i = 0; i < 3; ++i) {
+            result[i] = matrix[i].xyz();
+        }
+        return result;
+    }
+
+    constexpr Vector<T, 3> translation() const
+    {
+        return Vector<T, 3>(matrix(0, 3), matrix(1, 3), matrix(2, 3));
+    }
+
+    // The full homogeneous matrix, with the bottom row 0 0 0 1.
+    constexpr Matrix<T, 4, 4> toMatrix() const
+    {
+        Matrix<T, 4, 4> result;
+        for (size_t i = 0; i < 3; ++i) {
+            result[i] = matrix[i];
+        }
+        result(3, 3) = T(1);
+        return result;
+    }
+
+    // Transforms
+    constexpr Vector<T, 3> transformPoint(const Vector<T, 3> &p) const
+    {
+        return Vector<T, 3>(
+                matrix(0, 0) * p.x + matrix(0, 1) * p.y + matrix(0, 2) * p.z + matrix(0, 3),
+                matrix(1, 0) * p.x + matrix(1, 1) * p.y + matrix(1, 2) * p.z + matrix(1, 3),
+                matrix(2, 0) * p.x + matrix(2, 1) * p.y + matrix(2, 2) * p.z + matrix(2, 3)
+        );
+    }
+
+    // Transforms a direction, which ignores the translation.
+    constexpr Vector<T, 3> transformVector(const Vector<T, 3> &v) const
+    {
+        return Vector<T, 3>(
+                matrix(0, 0) * v.x + matrix(0, 1) * v.y + matrix(0, 2) * v.z,
+                matrix(1, 0) * v.x + matrix(1, 1) * v.y + matrix(1, 2) * v.z,
+                matrix(2, 0) * v.x + matrix(2, 1) * v.y + matrix(2, 2) * v.z
+        );
+    }
+
+    /**
+     * Composition. Applying the result applies other first, then this. Costs 36 multiplies instead of the 64 of a 4x4
+     * product.
+     * @param other The transform to apply first.
+     * @return The composed transform.
+     */
+    constexpr Affine3 operator*(const Affine3 &other) const
+    {
+        Affine3 result;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                result.matrix(i, j) = matrix(i, 0) * other.matrix(0, j) + matrix(i, 1) * other.matrix(1, j)
+                                      + matrix(i, 2) * other.matrix(2, j);
+            }
+            result.matrix(i, 3) += matrix(i, 3);
+        }
+        return result;
+    }
+
+    constexpr Affine3 &operator*=(const Affine3 &other)
+    {
+        return *this = *this * other;
+    }
+
+    constexpr bool operator==(const Affine3 &other) const
+    {
+        for (size_t i = 0; i < 3; ++i) {
+            if (matrix[i] != other.matrix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Inverse function. Inverts the linear part with Matrix::inverse and maps the translation back through it.
+     * @return The transform that undoes this one, or nothing if the linear part is singular.
+     */
+    constexpr std::optional<Affine3> inverse() const
+    {
+        static_assert(std::is_floating_point_v<T>, "Only transforms of a floating point type can be inverted.");
+        std::optional<Matrix<T, 3, 3>> linearInverse = linear().inverse();
+        if (!linearInverse) {
+            return std::nullopt;
+        }
+        Affine3 result(*linearInverse, Vector<T, 3>(T(0)));
+        Matrix<T, 3, 4> &r = result.matrix;
+        for (size_t i = 0; i < 3; ++i) {
+            r(i, 3) = -(r(i, 0) * matrix(0, 3) + r(i, 1) * matrix(1, 3) + r(i, 2) * matrix(2, 3));
+        }
+        return result;
+    }
+
+    /**
+     * Inverse of a rigid transform. Only valid when the linear part is a rotation, whose inverse is its transpose.
+     * @return The transform that undoes this one.
+     */
+    constexpr Affine3 rigidInverse() const
+    {
+        Affine3 result;
+        Matrix<T, 3, 4> &r = result.matrix;
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                r(i, j) = matrix(j, i);
+            }
+        }
+        for (size_t i = 0; i < 3; ++i) {
+            r(i, 3) = -(r(i, 0) * matrix(0, 3) + r(i, 1) * matrix(1, 3) + r(i, 2) * matrix(2, 3));
+        }
+        return result;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Affine3 &transform)
+    {
+        return os << transform.matrix[0] << "\n" << transform.matrix[1] << "\n" << transform.matrix[2];
+    }
+};
+
+namespace detail
+{
+/**
+ * Applies the linear part of an affine transform, plus the translation when Points is true, to packed 3D vectors. Float
+ * spans go through SSE2 4 vectors at a time in structure of arrays form.
+ */
+template<bool Points, typename T>
+void transformBatch(const Affine3<T> &transform, std::span<const Vector<T, 3>> in, std::span<Vector<T, 3>> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t i = 0;
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    if constexpr (std::is_same_v<T, float>) {
+        static_assert(sizeof(Vector<float, 3>) == 3 * sizeof(float), "Vec3 spans are processed as packed floats.");
+        const Matrix<float, 3, 4> &m = transform.matrix;
+        __m128 coefficients[3][4];
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 4; ++c) {
+                coefficients[r][c] = _mm_set1_ps(m(r, c));
+            }
+        }
+        for (; i + 4 <= in.size(); i += 4) {
+            __m128 x, y, z;
+            loadVec3Soa(in[i].data.data(), x, y, z);
+            __m128 result[3];
+            for (size_t r = 0; r < 3; ++r) {
+                __m128 value = _mm_add_ps(_mm_mul_ps(coefficients[r][0], x), _mm_mul_ps(coefficients[r][1], y));
+                value = _mm_add_ps(value, _mm_mul_ps(coefficients[r][2], z));
+                result[r] = Points ? _mm_add_ps(value, coefficients[r][3]) : value;
+            }
+            storeVec3Soa(out[i].data.data(), result[0], result[1], result[2]);
+        }
+    }
+#endif
+    for (; i < in.size(); ++i) {
+        out[i] = Points ? transform.transformPoint(in[i]) : transform.transformVector(in[i]);
+    }
+}
+}
+
+// Batch kernels
+/**
+ * Transforms an array of points. in and out may be the same span.
+ * @param transform The transform to apply.
+ * @param in The points to transform.
+ * @param out The destination, which must be the same size as in.
+ */
+template<typename T>
+void transformPoints(const Affine3<T> &transform, std::type_identity_t<std::span<const Vector<T, 3>>> in,
+                     std::span<Vector<T, 3>> out)
+{
+    detail::transformBatch<true>(transform, in, out);
+}
+
+/**
+ * Transforms an array of directions, ignoring the translation. in and out may be the same span.
+ * @param transform The transform to apply.
+ * @param in The directions to transform.
+ * @param out The destination, which must be the same size as in.
+ */
+template<typename T>
+void transformVectors(const Affine3<T> &transform, std::type_identity_t<std::span<const Vector<T, 3>>> in,
+                      std::span<Vector<T, 3>> out)
+{
+    detail::transformBatch<false>(transform, in, out);
+}
+
+#ifdef USING_ALL_AFFINE_TYPES
+    #define USING_FLOATING_AFFINE_TYPES
+    #define USING_DOUBLE_AFFINE_TYPES
+#endif
+
+#ifdef USING_FLOATING_AFFINE_TYPES
+using Affine3F = Affine3<float>;
+#endif
+
+#ifdef USING_DOUBLE_AFFINE_TYPES
+using Affine3D = Affine3<double>;
+#endif
+
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Bytes an Arena requests from its upstream resource at a time.
+#ifndef MATHUTILS_ARENA_BLOCK_BYTES
+    #define MATHUTILS_ARENA_BLOCK_BYTES (1 << 20)
+#endif
+
+// Default size in bytes from which results of DynVector and DynMatrix operations are placed in the active Arena.
+#ifndef MATHUTILS_ARENA_THRESHOLD
+    #define MATHUTILS_ARENA_THRESHOLD 4096
+#endif
+
+namespace MathUtils
+{
+class Arena;
+
+namespace detail
+{
+// The arena of the innermost Arena::Scope on this thread, or null outside of any scope.
+inline thread_local Arena *activeArena = nullptr;
+}
+
+/**
+ * A bump pointer memory resource for the temporaries of expression chains. Memory is taken from a list of blocks that
+ * are kept when the arena is rewound, so a loop evaluating the same expression allocates from the upstream resource
+ * only in its first iteration. Freeing the most recent allocation returns it to the arena, freeing anything else does
+ * nothing until the arena is rewound.
+ *
+ * While an Arena::Scope is alive, results of DynVector and DynMatrix operations of at least threshold() bytes are
+ * allocated from its arena, and the arena is rewound when the scope ends. Results that must outlive the scope have to
+ * be copied or assigned to an object declared outside of it, which copies them to that object's resource. This also
+ * holds for objects allocated from the arena in an outer scope: assigning a result of a nested scope to them copies it,
+ * and if they have to grow inside the nested scope the memory is taken from the upstream resource. Move constructing
+ * from a result while its scope is open copies it to the upstream resource, so a function may return a named result
+ * computed in its own scope. Returning an unnamed result, as in return a + b, constructs the caller's object in the
+ * arena directly and is not safe inside the function's own scope.
+ */
+class Arena : public std::pmr::memory_resource
+{
+    struct Block
+    {
+        std::byte *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    // The block allocations are taken from and the offset of its first free byte.
+    size_t current = 0;
+    size_t offset = 0;
+    // Bytes handed out, including alignment padding and the unused ends of earlier blocks.
+    size_t usedBytes = 0;
+    size_t peakBytes = 0;
+    size_t blockBytes;
+    size_t thresholdBytes;
+    void *lastAllocation = nullptr;
+    std::pmr::memory_resource *upstream;
+
+public:
+    // A position in an arena to rewind to.
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    class Scope;
+
+    /**
+     * @param blockBytes The size of the blocks requested from upstream. Larger allocations get a block of their own.
+     * @param threshold The size in bytes from which results are placed in this arena while it is active.
+     * @param upstream The resource blocks are allocated from.
+     */
+    explicit Arena(size_t blockBytes = MATHUTILS_ARENA_BLOCK_BYTES, size_t threshold = MATHUTILS_ARENA_THRESHOLD,
+                   std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : blockBytes(std::max<size_t>(blockBytes, 1)), thresholdBytes(threshold), upstream(upstream)
+    {
+        assert(upstream != nullptr && "Upstream memory resource must not be null.");
+    }
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() override
+    {
+        assert(detail::activeArena != this && "An Arena must not be destroyed inside its own scope.");
+        for (const Block &block: blocks) {
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+    }
+
+    // The arena of this thread that Scopes use by default.
+    static Arena &threadLocal()
+    {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    // The arena results are currently placed in on this thread, or null outside of any Scope.
+    static Arena *active()
+    {
+        return detail::activeArena;
+    }
+
+    // accessor methods
+    // Bytes currently allocated, including alignment padding.
+    [[nodiscard]] size_t used() const
+    { return usedBytes; }
+
+    // The largest value used() has had since construction or the last resetPeak().
+    [[nodiscard]] size_t peak() const
+    { return peakBytes; }
+
+    // Bytes held from the upstream resource.
+    [[nodiscard]] size_t capacity() const
+    {
+        size_t total = 0;
+        for (const Block &block: blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+
+    [[nodiscard]] size_t threshold() const
+    { return thresholdBytes; }
+
+    [[nodiscard]] std::pmr::memory_resource *upstreamResource() const
+    { return upstream; }
+
+    void setThreshold(size_t threshold)
+    { thresholdBytes = threshold; }
+
+    void resetPeak()
+    { peakBytes = usedBytes; }
+
+    [[nodiscard]] Marker mark() const
+    {
+        return {current, offset, usedBytes};
+    }
+
+    // Frees everything allocated since marker was taken. The blocks stay allocated for reuse.
+    void rewind(const Marker &marker)
+    {
+        assert(marker.used <= usedBytes && "Arena rewound past its current position.");
+        current = marker.block;
+        offset = marker.offset;
+        usedBytes = marker.used;
+        lastAllocation = nullptr;
+    }
+
+    // Frees everything and returns the blocks to the upstream resource.
+    void release()
+    {
+        for (const Block &block: blocks) {
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+        blocks.clear();
+        rewind({0, 0, 0});
+    }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        size_t start = alignedOffset(alignment);
+        if (current >= blocks.size() || start + bytes > blocks[current].size) {
+            nextBlock(bytes + alignment);
+            start = alignedOffset(alignment);
+        }
+        void *result = blocks[current].data + start;
+        usedBytes += start + bytes - offset;
+        peakBytes = std::max(peakBytes, usedBytes);
+        offset = start + bytes;
+        lastAllocation = result;
+        return result;
+    }
+
+    void do_deallocate(void *p, size_t, size_t) override
+    {
+        if (p != lastAllocation) {
+            return;
+        }
+        size_t start = static_cast<std::byte *>(p) - blocks[current].data;
+        usedBytes -= offset - start;
+        offset = start;
+        lastAllocation = nullptr;
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    [[nodiscard]] size_t alignedOffset(size_t alignment) const
+    {
+        if (current >= blocks.size()) {
+            return 0;
+        }
+        auto address = reinterpret_cast<uintptr_t>(blocks[current].data + offset);
+        return offset + (alignment - address % alignment) % alignment;
+    }
+
+    // Moves to the next block holding at least bytes bytes, reusing blocks a rewind left behind where possible.
+    void nextBlock(size_t bytes)
+    {
+        size_t next = current < blocks.size() ? current + 1 : 0;
+        if (current < blocks.size()) {
+            usedBytes += blocks[current].size - offset;
+        }
+        if (next >= blocks.size() || blocks[next].size < bytes) {
+            size_t size = std::max(blockBytes, bytes);
+            auto *data = static_cast<std::byte *>(upstream->allocate(size, alignof(std::max_align_t)));
+            blocks.insert(blocks.begin() + static_cast<ptrdiff_t>(next), {data, size});
+        }
+        current = next;
+        offset = 0;
+    }
+};
+
+/**
+ * Makes an arena the one results are placed in on this thread for the lifetime of the scope, and rewinds it when the
+ * scope ends. Scopes nest, the innermost one is active.
+ */
+class Arena::Scope
+{
+    Arena &arena;
+    Marker marker;
+    Arena *previous;
+    Scope *outer;
+
+public:
+    Scope() : Scope(Arena::threadLocal())
+    {}
+
+    explicit Scope(Arena &arena);
+
+    Scope(const Scope &) = delete;
+
+    Scope &operator=(const Scope &) = delete;
+
+    ~Scope();
+
+    // The number of scopes of resource open on this thread, 0 if it is not an arena or has no open scope.
+    static size_t depth(const std::pmr::memory_resource *resource);
+};
+
+namespace detail
+{
+// The innermost Arena::Scope on this thread, or null outside of any scope.
+inline thread_local Arena::Scope *innermostScope = nullptr;
+}
+
+inline Arena::Scope::Scope(Arena &arena)
+        : arena(arena), marker(arena.mark()), previous(std::exchange(detail::activeArena, &arena)),
+          outer(std::exchange(detail::innermostScope, this))
+{
+    // Allocations from before the scope are not returned to the arena while it is open, they lie below the marker.
+    arena.lastAllocation = nullptr;
+}
+
+inline Arena::Scope::~Scope()
+{
+    arena.rewind(marker);
+    detail::activeArena = previous;
+    detail::innermostScope = outer;
+}
+
+inline size_t Arena::Scope::depth(const std::pmr::memory_resource *resource)
+{
+    size_t count = 0;
+    for (const Scope *scope = detail::innermostScope; scope != nullptr; scope = scope->outer) {
+        count += &scope->arena == resource;
+    }
+    return count;
+}
+
+namespace detail
+{
+// The resource a result of bytes bytes is allocated from: the active arena for large results, else the operand's.
+inline std::pmr::memory_resource *resultResource(size_t bytes, std::pmr::memory_resource *operand)
+{
+    Arena *arena = activeArena;
+    return arena != nullptr && bytes >= arena->threshold() ? arena : operand;
+}
+
+/**
+ * The resource an object may allocate from, given the resource it was created with and the scope depth of that
+ * resource at the time. Memory an arena hands out inside a deeper scope is rewound when that scope ends, while the
+ * object still holds it, so such allocations are taken from the arena's upstream resource instead.
+ */
+inline std::pmr::memory_resource *allocationResource(std::pmr::memory_resource *memory, size_t level)
+{
+    if (Arena::Scope::depth(memory) > level) {
+        return static_cast<Arena *>(memory)->upstreamResource();
+    }
+    return memory;
+}
+
+/**
+ * The resource of an object move constructed from one created with memory. The new object may outlive the open scopes
+ * of an arena, e.g. when it is returned from a function that opened its own scope, so it takes the arena's upstream
+ * resource and copies the elements instead of taking over memory a scope will rewind.
+ */
+inline std::pmr::memory_resource *movedResource(std::pmr::memory_resource *memory)
+{
+    if (Arena::Scope::depth(memory) > 0) {
+        return static_cast<Arena *>(memory)->upstreamResource();
+    }
+    return memory;
+}
+}
+
+}
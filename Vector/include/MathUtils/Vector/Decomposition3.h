@@ -0,0 +1,460 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace MathUtils
+{
+
+/**
+ * The eigen decomposition A = V diag(values) V^T of a symmetric 3x3 matrix.
+ * @tparam T The floating point element type.
+ */
+template<typename T>
+struct SymmetricEigen3
+{
+    // The eigenvalues in ascending order.
+    Vector<T, 3> values = Vector<T, 3>(T(0));
+    // A rotation whose columns are the unit eigenvectors, in the order of values.
+    Matrix<T, 3, 3> vectors = Matrix<T, 3, 3>::identity();
+};
+
+/**
+ * The singular value decomposition A = U diag(sigma) V^T of a 3x3 matrix, with U and V both rotations. To keep them
+ * rotations the last singular value takes the sign of det(A), so its magnitude is the true singular value.
+ * @tparam T The floating point element type.
+ */
+template<typename T>
+struct Svd3
+{
+    Matrix<T, 3, 3> u = Matrix<T, 3, 3>::identity();
+    // The singular values in descending order of magnitude.
+    Vector<T, 3> sigma = Vector<T, 3>(T(0));
+    Matrix<T, 3, 3> v = Matrix<T, 3, 3>::identity();
+};
+
+namespace detail
+{
+// The kernels below are written once for a lane type L, which is T for a single matrix or Vector<T, Lanes> for a
+// structure of arrays batch with one matrix per lane. These helpers give both the same branch free operations.
+template<typename T>
+constexpr T laneSelect(bool condition, const T &a, const T &b)
+{
+    return condition ? a : b;
+}
+
+template<typename T, size_t W>
+constexpr Vector<T, W> laneSelect(const Mask<W> &condition, const Vector<T, W> &a, const Vector<T, W> &b)
+{
+    return select(condition, a, b);
+}
+
+template<typename T>
+constexpr bool laneLess(const T &a, const T &b)
+{
+    return a < b;
+}
+
+template<typename T, size_t W>
+constexpr Mask<W> laneLess(const Vector<T, W> &a, const Vector<T, W> &b)
+{
+    return lessThan(a, b);
+}
+
+template<typename T>
+constexpr T laneAbs(const T &x)
+{
+    return x < T(0) ? -x : x;
+}
+
+template<typename T, size_t W>
+constexpr Vector<T, W> laneAbs(const Vector<T, W> &x)
+{
+    return abs(x);
+}
+
+template<typename T>
+constexpr T laneMax(const T &a, const T &b)
+{
+    return a < b ? b : a;
+}
+
+template<typename T, size_t W>
+constexpr Vector<T, W> laneMax(const Vector<T, W> &a, const Vector<T, W> &b)
+{
+    return max(a, b);
+}
+
+template<typename T>
+T laneSqrt(const T &x)
+{
+    return std::sqrt(x);
+}
+
+template<typename T, size_t W>
+Vector<T, W> laneSqrt(const Vector<T, W> &x)
+{
+    Vector<T, W> result;
+    for (size_t i = 0; i < W; ++i) {
+        result[i] = std::sqrt(x[i]);
+    }
+    return result;
+}
+
+template<typename L>
+using Lanes3x3 = std::array<std::array<L, 3>, 3>;
+
+// Sweeps of the three Jacobi rotations. Each sweep roughly squares the off diagonal error once the rotations are exact.
+template<typename T>
+inline constexpr int jacobiSweeps = sizeof(T) <= 4 ? 8 : 6;
+
+template<typename L>
+void condSwap(const auto &condition, L &x, L &y)
+{
+    L z = x;
+    x = laneSelect(condition, y, x);
+    y = laneSelect(condition, z, y);
+}
+
+// Swaps and negates one side, which keeps the determinant of a matrix whose columns are swapped.
+template<typename L>
+void condNegSwap(const auto &condition, L &x, L &y)
+{
+    L z = -x;
+    x = laneSelect(condition, y, x);
+    y = laneSelect(condition, z, y);
+}
+
+/**
+ * The quaternion (ch, sh) of a Givens rotation that approximately zeroes a12 in the symmetric 2x2 block [a11 a12; a12
+ * a22]. Falls back to a rotation by pi/8 when the exact angle would be too large, which still converges.
+ */
+template<typename T, typename L>
+void approximateGivens(const L &a11, const L &a12, const L &a22, L &ch, L &sh)
+{
+    // 3 + 2 sqrt(2), cos(pi/8) and sin(pi/8)
+    const L gamma(T(5.828427124746190));
+    const L cosine(T(0.9238795325112867));
+    const L sine(T(0.3826834323650898));
+    ch = L(T(2)) * (a11 - a22);
+    sh = a12;
+    auto exact = laneLess(gamma * sh * sh, ch * ch);
+    L scale = L(T(1)) / laneSqrt(ch * ch + sh * sh);
+    ch = laneSelect(exact, scale * ch, cosine);
+    sh = laneSelect(exact, scale * sh, sine);
+}
+
+/**
+ * Applies one Jacobi rotation S = Q^T S Q to the lower triangle of S, accumulates Q into the quaternion q, and then
+ * relabels S so the next call rotates the next pair of axes. Three calls in a row return S to its original labels.
+ * (x, y, z) is (0, 1, 2), (1, 2, 0) and (2, 0, 1) for the three calls.
+ */
+template<typename T, typename L>
+void jacobiConjugation(int x, int y, int z, L &s11, L &s21, L &s22, L &s31, L &s32, L &s33, std::array<L, 4> &q)
+{
+    L ch, sh;
+    approximateGivens<T>(s11, s21, s22, ch, sh);
+    L scale = ch * ch + sh * sh;
+    L a = (ch * ch - sh * sh) / scale;
+    L b = L(T(2)) * sh * ch / scale;
+
+    L t11 = s11, t21 = s21, t22 = s22, t31 = s31, t32 = s32, t33 = s33;
+    s11 = a * (a * t11 + b * t21) + b * (a * t21 + b * t22);
+    s21 = a * (-b * t11 + a * t21) + b * (-b * t21 + a * t22);
+    s22 = -b * (-b * t11 + a * t21) + a * (-b * t21 + a * t22);
+    s31 = a * t31 + b * t32;
+    s32 = -b * t31 + a * t32;
+    s33 = t33;
+
+    std::array<L, 3> scaled = {q[0] * sh, q[1] * sh, q[2] * sh};
+    sh = sh * q[3];
+    for (L &component: q) {
+        component = component * ch;
+    }
+    q[z] = q[z] + sh;
+    q[3] = q[3] - scaled[z];
+    q[x] = q[x] + scaled[y];
+    q[y] = q[y] - scaled[x];
+
+    t11 = s22;
+    t21 = s32;
+    t22 = s33;
+    t31 = s21;
+    t32 = s31;
+    t33 = s11;
+    s11 = t11;
+    s21 = t21;
+    s22 = t22;
+    s31 = t31;
+    s32 = t32;
+    s33 = t33;
+}
+
+/**
+ * Diagonalizes the symmetric matrix given by its lower triangle in place with cyclic Jacobi sweeps.
+ * @return The rotation whose columns are the eigenvectors, in the order of the resulting diagonal.
+ */
+template<typename T, typename L>
+Lanes3x3<L> jacobiEigen(L &s11, L &s21, L &s22, L &s31, L &s32, L &s33)
+{
+    const L zero(T(0));
+    const L one(T(1));
+    const L two(T(2));
+    std::array<L, 4> q = {zero, zero, zero, one};
+    for (int sweep = 0; sweep < jacobiSweeps<T>; ++sweep) {
+        jacobiConjugation<T>(0, 1, 2, s11, s21, s22, s31, s32, s33, q);
+        jacobiConjugation<T>(1, 2, 0, s11, s21, s22, s31, s32, s33, q);
+        jacobiConjugation<T>(2, 0, 1, s11, s21, s22, s31, s32, s33, q);
+    }
+    // The rotations are unit quaternions, so this only removes rounding drift.
+    L norm = one / laneSqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    L x = q[0] * norm, y = q[1] * norm, z = q[2] * norm, w = q[3] * norm;
+    return {{
+            {one - two * (y * y + z * z), two * (x * y - w * z), two * (x * z + w * y)},
+            {two * (x * y + w * z), one - two * (x * x + z * z), two * (y * z - w * x)},
+            {two * (x * z - w * y), two * (y * z + w * x), one - two * (x * x + y * y)}
+    }};
+}
+
+template<typename T, typename L>
+void symmetricEigenKernel(const Lanes3x3<L> &a, std::array<L, 3> &values, Lanes3x3<L> &vectors)
+{
+    L s11 = a[0][0], s21 = a[1][0], s22 = a[1][1], s31 = a[2][0], s32 = a[2][1], s33 = a[2][2];
+    vectors = jacobiEigen<T>(s11, s21, s22, s31, s32, s33);
+    values = {s11, s22, s33};
+    // Sort ascending, swapping eigenvector columns along.
+    auto sortPair = [&](size_t i, size_t j) {
+        auto swap = laneLess(values[j], values[i]);
+        condSwap(swap, values[i], values[j]);
+        for (size_t r = 0; r < 3; ++r) {
+            condNegSwap(swap, vectors[r][i], vectors[r][j]);
+        }
+    };
+    sortPair(0, 1);
+    sortPair(0, 2);
+    sortPair(1, 2);
+}
+
+/**
+ * The quaternion (ch, sh) of a Givens rotation that zeroes a2 below the pivot a1, choosing the angle that keeps the
+ * pivot positive.
+ */
+template<typename T, typename L>
+void qrGivens(const L &a1, const L &a2, L &ch, L &sh)
+{
+    const L epsilon(std::numeric_limits<T>::epsilon() * T(8));
+    L rho = laneSqrt(a1 * a1 + a2 * a2);
+    sh = laneSelect(laneLess(epsilon, rho), a2, L(T(0)));
+    ch = laneAbs(a1) + laneMax(rho, epsilon);
+    condSwap(laneLess(a1, L(T(0))), sh, ch);
+    L scale = L(T(1)) / laneSqrt(ch * ch + sh * sh);
+    ch = ch * scale;
+    sh = sh * scale;
+}
+
+/**
+ * McAdams et al.'s branch free 3x3 SVD. V comes from a Jacobi eigen decomposition of A^T A, the columns of A V are
+ * sorted by decreasing norm, and U and sigma come from a Givens QR of A V.
+ */
+template<typename T, typename L>
+void svdKernel(const Lanes3x3<L> &a, Lanes3x3<L> &u, std::array<L, 3> &sigma, Lanes3x3<L> &v)
+{
+    const L one(T(1));
+    const L two(T(2));
+    Lanes3x3<L> ata;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            ata[i][j] = a[0][i] * a[0][j] + a[1][i] * a[1][j] + a[2][i] * a[2][j];
+        }
+    }
+    v = jacobiEigen<T>(ata[0][0], ata[1][0], ata[1][1], ata[2][0], ata[2][1], ata[2][2]);
+
+    Lanes3x3<L> b;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            b[i][j] = a[i][0] * v[0][j] + a[i][1] * v[1][j] + a[i][2] * v[2][j];
+        }
+    }
+
+    std::array<L, 3> rho;
+    for (size_t j = 0; j < 3; ++j) {
+        rho[j] = b[0][j] * b[0][j] + b[1][j] * b[1][j] + b[2][j] * b[2][j];
+    }
+    auto sortPair = [&](size_t i, size_t j) {
+        auto swap = laneLess(rho[i], rho[j]);
+        for (size_t r = 0; r < 3; ++r) {
+            condNegSwap(swap, b[r][i], b[r][j]);
+            condNegSwap(swap, v[r][i], v[r][j]);
+        }
+        condSwap(swap, rho[i], rho[j]);
+    };
+    sortPair(0, 1);
+    sortPair(0, 2);
+    sortPair(1, 2);
+
+    // Three Givens rotations zero b21, b31 and then b32. Each rotates two rows by the angle of quaternion (ch, sh).
+    auto rotateRows = [&](size_t p, size_t r, L &ch, L &sh) {
+        qrGivens<T>(b[p][p], b[r][p], ch, sh);
+        L c = one - two * sh * sh;
+        L s = two * ch * sh;
+        for (size_t j = 0; j < 3; ++j) {
+            L top = c * b[p][j] + s * b[r][j];
+            b[r][j] = -s * b[p][j] + c * b[r][j];
+            b[p][j] = top;
+        }
+    };
+    L ch1, sh1, ch2, sh2, ch3, sh3;
+    rotateRows(0, 1, ch1, sh1);
+    rotateRows(0, 2, ch2, sh2);
+    rotateRows(1, 2, ch3, sh3);
+
+    // U = Q1 Q2 Q3, multiplied out.
+    L sh12 = sh1 * sh1, sh22 = sh2 * sh2, sh32 = sh3 * sh3;
+    L m1 = two * sh12 - one, m2 = two * sh22 - one, m3 = two * sh32 - one;
+    const L four(T(4));
+    const L eight(T(8));
+    u[0][0] = m1 * m2;
+    u[0][1] = four * ch2 * ch3 * m1 * sh2 * sh3 + two * ch1 * sh1 * m3;
+    u[0][2] = four * ch1 * ch3 * sh1 * sh3 - two * ch2 * m1 * sh2 * m3;
+    u[1][0] = -two * ch1 * sh1 * m2;
+    u[1][1] = -eight * ch1 * ch2 * ch3 * sh1 * sh2 * sh3 + m1 * m3;
+    u[1][2] = -two * ch3 * sh3 + four * sh1 * (ch3 * sh1 * sh3 + ch1 * ch2 * sh2 * m3);
+    u[2][0] = two * ch2 * sh2;
+    u[2][1] = -two * ch3 * m2 * sh3;
+    u[2][2] = m2 * m3;
+
+    sigma = {b[0][0], b[1][1], b[2][2]};
+}
+
+template<typename T>
+Lanes3x3<T> toLanes(const Matrix<T, 3, 3> &m)
+{
+    return {{{m(0, 0), m(0, 1), m(0, 2)}, {m(1, 0), m(1, 1), m(1, 2)}, {m(2, 0), m(2, 1), m(2, 2)}}};
+}
+
+/**
+ * Runs kernel on every matrix of in, one SIMD register's worth of matrices at a time in structure of arrays form. Short
+ * groups repeat their last matrix in the unused lanes.
+ */
+template<typename T, typename Kernel, typename Store>
+void forEachLaneGroup(std::span<const Matrix<T, 3, 3>> in, Kernel &&kernel, Store &&store)
+{
+    constexpr size_t Lanes = simdLanes<T>;
+    using L = Vector<T, Lanes>;
+    Lanes3x3<L> a;
+    for (size_t group = 0; group < in.size(); group += Lanes) {
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            const Matrix<T, 3, 3> &m = in[std::min(group + lane, in.size() - 1)];
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    a[i][j][lane] = m(i, j);
+                }
+            }
+        }
+        kernel(a);
+        for (size_t lane = 0; lane < Lanes && group + lane < in.size(); ++lane) {
+            store(group + lane, lane);
+        }
+    }
+}
+
+template<typename T, size_t W>
+Matrix<T, 3, 3> extractLane(const Lanes3x3<Vector<T, W>> &m, size_t lane)
+{
+    Matrix<T, 3, 3> result;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            result(i, j) = m[i][j][lane];
+        }
+    }
+    return result;
+}
+}
+
+/**
+ * Eigen decomposition of a symmetric 3x3 matrix by branch free Jacobi rotations. Only the lower triangle is read.
+ * @param a The symmetric matrix.
+ * @return The eigenvalues in ascending order and the matching eigenvectors.
+ */
+template<typename T>
+SymmetricEigen3<T> symmetricEigen(const Matrix<T, 3, 3> &a)
+{
+    static_assert(std::is_floating_point_v<T>, "Eigen decompositions need a floating point type.");
+    std::array<T, 3> values;
+    detail::Lanes3x3<T> vectors;
+    detail::symmetricEigenKernel<T>(detail::toLanes(a), values, vectors);
+    SymmetricEigen3<T> result;
+    result.values = Vector<T, 3>(values);
+    result.vectors = Matrix<T, 3, 3>(vectors);
+    return result;
+}
+
+/**
+ * Branch free singular value decomposition of a 3x3 matrix. See Svd3.
+ * @param a The matrix to decompose.
+ * @return U, sigma and V with A = U diag(sigma) V^T.
+ */
+template<typename T>
+Svd3<T> svd(const Matrix<T, 3, 3> &a)
+{
+    static_assert(std::is_floating_point_v<T>, "Singular value decompositions need a floating point type.");
+    detail::Lanes3x3<T> u, v;
+    std::array<T, 3> sigma;
+    detail::svdKernel<T>(detail::toLanes(a), u, sigma, v);
+    Svd3<T> result;
+    result.u = Matrix<T, 3, 3>(u);
+    result.sigma = Vector<T, 3>(sigma);
+    result.v = Matrix<T, 3, 3>(v);
+    return result;
+}
+
+// Batch kernels
+/**
+ * Eigen decomposes every symmetric matrix of a span, with each lane of a SIMD register working on its own matrix.
+ * @param in The symmetric matrices. Only their lower triangles are read.
+ * @param out The destination, which must be the same size as in.
+ */
+template<typename T>
+void symmetricEigen(std::type_identity_t<std::span<const Matrix<T, 3, 3>>> in, std::span<SymmetricEigen3<T>> out)
+{
+    static_assert(std::is_floating_point_v<T>, "Eigen decompositions need a floating point type.");
+    assert(in.size() == out.size() && "Span size mismatch.");
+    using L = Vector<T, detail::simdLanes<T>>;
+    std::array<L, 3> values;
+    detail::Lanes3x3<L> vectors;
+    detail::forEachLaneGroup<T>(in, [&](const detail::Lanes3x3<L> &a) {
+        detail::symmetricEigenKernel<T>(a, values, vectors);
+    }, [&](size_t index, size_t lane) {
+        out[index].values = Vector<T, 3>(values[0][lane], values[1][lane], values[2][lane]);
+        out[index].vectors = detail::extractLane(vectors, lane);
+    });
+}
+
+/**
+ * Singular value decomposes every matrix of a span, with each lane of a SIMD register working on its own matrix.
+ * @param in The matrices to decompose.
+ * @param out The destination, which must be the same size as in.
+ */
+template<typename T>
+void svd(std::type_identity_t<std::span<const Matrix<T, 3, 3>>> in, std::span<Svd3<T>> out)
+{
+    static_assert(std::is_floating_point_v<T>, "Singular value decompositions need a floating point type.");
+    assert(in.size() == out.size() && "Span size mismatch.");
+    using L = Vector<T, detail::simdLanes<T>>;
+    detail::Lanes3x3<L> u, v;
+    std::array<L, 3> sigma;
+    detail::forEachLaneGroup<T>(in, [&](const detail::Lanes3x3<L> &a) {
+        detail::svdKernel<T>(a, u, sigma, v);
+    }, [&](size_t index, size_t lane) {
+        out[index].u = detail::extractLane(u, lane);
+        out[index].sigma = Vector<T, 3>(sigma[0][lane], sigma[1][lane], sigma[2][lane]);
+        out[index].v = detail::extractLane(v, lane);
+    });
+}
+
+}
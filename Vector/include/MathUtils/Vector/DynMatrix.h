@@ -0,0 +1,328 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <memory_resource>
+#include <span>
+#include "DynVector.h"
+#include "Matrix.h"
+
+namespace MathUtils
+{
+
+/**
+ * A matrix whose dimensions are chosen at runtime. The elements are stored row-major and contiguous, inline for small
+ * matrices and otherwise in SIMD aligned memory from a std::pmr::memory_resource, see DynVector.
+ * @tparam T The element type.
+ */
+template<typename T>
+class DynMatrix
+{
+    static_assert(std::is_arithmetic_v<T>, "DynMatrix's template parameter T must be a numerical type.");
+
+    size_t rowCount;
+    size_t colCount;
+    detail::DynStorage<T> storage;
+
+public:
+    // The type matrix products over T are accumulated in and returned as.
+    using AccumulatorType = typename ElementTraits<T>::Accumulator;
+
+    // Constructors
+    // The empty matrix.
+    explicit DynMatrix(std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : rowCount(0), colCount(0), storage(0, memory)
+    {}
+
+    // A rows x cols matrix of zeros.
+    DynMatrix(size_t rows, size_t cols, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : rowCount(rows), colCount(cols), storage(rows * cols, memory)
+    {
+        std::fill_n(data(), rows * cols, T(0));
+    }
+
+    // A matrix from its rows, which must all have the same length.
+    DynMatrix(std::initializer_list<std::initializer_list<T>> values,
+              std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : rowCount(values.size()), colCount(values.size() > 0 ? values.begin()->size() : 0),
+              storage(rowCount * colCount, memory)
+    {
+        T *out = data();
+        for (const std::initializer_list<T> &row: values) {
+            assert(row.size() == colCount && "DynMatrix rows must have the same length.");
+            out = std::copy(row.begin(), row.end(), out);
+        }
+    }
+
+    template<size_t N, size_t M>
+    explicit DynMatrix(const Matrix<T, N, M> &matrix,
+                       std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : rowCount(N), colCount(M), storage(N * M, memory)
+    {
+        for (size_t i = 0; i < N; ++i) {
+            std::copy_n(matrix[i].data.begin(), M, data() + i * M);
+        }
+    }
+
+    // Like the std::pmr containers, a copy uses the default memory resource unless it is given one.
+    DynMatrix(const DynMatrix &other)
+            : rowCount(other.rowCount), colCount(other.colCount),
+              storage(other.storage, std::pmr::get_default_resource())
+    {}
+
+    DynMatrix(const DynMatrix &other, std::pmr::memory_resource *memory)
+            : rowCount(other.rowCount), colCount(other.colCount), storage(other.storage, memory)
+    {}
+
+    DynMatrix(DynMatrix &&other) noexcept
+            : rowCount(std::exchange(other.rowCount, 0)), colCount(std::exchange(other.colCount, 0)),
+              storage(std::move(other.storage))
+    {}
+
+    DynMatrix &operator=(const DynMatrix &other) = default;
+
+    DynMatrix &operator=(DynMatrix &&other) noexcept
+    {
+        rowCount = std::exchange(other.rowCount, 0);
+        colCount = std::exchange(other.colCount, 0);
+        storage = std::move(other.storage);
+        return *this;
+    }
+
+    static DynMatrix identity(size_t n, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+    {
+        DynMatrix result(n, n, memory);
+        for (size_t i = 0; i < n; ++i) {
+            result(i, i) = T(1);
+        }
+        return result;
+    }
+
+    // The fixed size matrix with the same elements. N and M must equal rows() and cols().
+    template<size_t N, size_t M>
+    Matrix<T, N, M> toMatrix() const
+    {
+        assert(N == rows() && M == cols() && "Matrix size mismatch.");
+        Matrix<T, N, M> result;
+        for (size_t i = 0; i < N; ++i) {
+            std::copy_n(data() + i * M, M, result[i].data.begin());
+        }
+        return result;
+    }
+
+    // accessor methods
+    [[nodiscard]] size_t rows() const
+    { return rowCount; }
+
+    [[nodiscard]] size_t cols() const
+    { return colCount; }
+
+    // The row-major elements.
+    T *data()
+    { return storage.data(); }
+
+    const T *data() const
+    { return storage.data(); }
+
+    // The resource the elements, and the results of arithmetic on this matrix, are allocated from.
+    [[nodiscard]] std::pmr::memory_resource *memoryResource() const
+    { return storage.resource(); }
+
+    T &operator()(size_t row, size_t col)
+    {
+        assert(row < rowCount && col < colCount && "DynMatrix index out of bounds.");
+        return data()[row * colCount + col];
+    }
+
+    const T &operator()(size_t row, size_t col) const
+    {
+        assert(row < rowCount && col < colCount && "DynMatrix index out of bounds.");
+        return data()[row * colCount + col];
+    }
+
+    std::span<T> operator[](size_t row)
+    {
+        assert(row < rowCount && "DynMatrix row index out of bounds.");
+        return {data() + row * colCount, colCount};
+    }
+
+    std::span<const T> operator[](size_t row) const
+    {
+        assert(row < rowCount && "DynMatrix row index out of bounds.");
+        return {data() + row * colCount, colCount};
+    }
+
+    // Matrix addition
+    DynMatrix operator+(const DynMatrix &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a + b); });
+    }
+
+    // Matrix subtraction
+    DynMatrix operator-(const DynMatrix &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a - b); });
+    }
+
+    // Matrix element multiplication
+    DynMatrix operator*(const DynMatrix &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a * b); });
+    }
+
+    DynMatrix &operator+=(const DynMatrix &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a += b; });
+    }
+
+    DynMatrix &operator-=(const DynMatrix &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a -= b; });
+    }
+
+    DynMatrix &operator*=(const DynMatrix &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a *= b; });
+    }
+
+    DynMatrix operator*(const T &scalar) const
+    {
+        DynMatrix result = uninitialized(rowCount, colCount, memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) { result.data()[i] = static_cast<T>(data()[i] * scalar); });
+        return result;
+    }
+
+    DynMatrix operator/(const T &scalar) const
+    {
+        DynMatrix result = uninitialized(rowCount, colCount, memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) { result.data()[i] = static_cast<T>(data()[i] / scalar); });
+        return result;
+    }
+
+    DynMatrix &operator*=(const T &scalar)
+    {
+        detail::forEachIndex<T>(size(), [&](size_t i) { data()[i] *= scalar; });
+        return *this;
+    }
+
+    DynMatrix &operator/=(const T &scalar)
+    {
+        detail::forEachIndex<T>(size(), [&](size_t i) { data()[i] /= scalar; });
+        return *this;
+    }
+
+    /**
+     * Matrix multiplication. Each row of the result is accumulated as a sum of scaled rows of other, so the inner loop
+     * runs over contiguous memory. Rows are split across threads above MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+     * @param other The cols() x P right hand side.
+     * @return The rows() x P product, allocated like the results of the other operations.
+     */
+    DynMatrix<AccumulatorType> matMult(const DynMatrix &other) const
+    {
+        assert(colCount == other.rowCount && "DynMatrix size mismatch.");
+        using Acc = AccumulatorType;
+        size_t p = other.colCount;
+        std::pmr::memory_resource *memory = detail::resultResource(rowCount * p * sizeof(Acc), memoryResource());
+        DynMatrix<Acc> result(rowCount, p, memory);
+        detail::parallelRanges(0, rowCount, rowCount * colCount * p, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                Acc *out = result.data() + i * p;
+                for (size_t k = 0; k < colCount; ++k) {
+                    Acc a = static_cast<Acc>((*this)(i, k));
+                    const T *row = other.data() + k * p;
+                    detail::forEachIndex<Acc>(p, [&](size_t j) { out[j] += a * static_cast<Acc>(row[j]); });
+                }
+            }
+        });
+        return result;
+    }
+
+    DynVector<AccumulatorType> matMult(const DynVector<T> &other) const
+    {
+        assert(colCount == other.size() && "DynMatrix size mismatch.");
+        using Acc = AccumulatorType;
+        std::pmr::memory_resource *memory = detail::resultResource(rowCount * sizeof(Acc), memoryResource());
+        DynVector<Acc> result(rowCount, memory);
+        for (size_t i = 0; i < rowCount; ++i) {
+            const T *row = data() + i * colCount;
+            result[i] = detail::dynAccumulate<Acc, Summation::Fast>(colCount, [&](size_t k) {
+                return static_cast<Acc>(static_cast<Acc>(row[k]) * static_cast<Acc>(other[k]));
+            });
+        }
+        return result;
+    }
+
+    DynMatrix transpose() const
+    {
+        DynMatrix result = uninitialized(colCount, rowCount, memoryResource());
+        for (size_t i = 0; i < rowCount; ++i) {
+            for (size_t j = 0; j < colCount; ++j) {
+                result(j, i) = (*this)(i, j);
+            }
+        }
+        return result;
+    }
+
+    // Matrices of different dimensions are never equal.
+    bool operator==(const DynMatrix &other) const
+    {
+        return rowCount == other.rowCount && colCount == other.colCount &&
+               std::equal(data(), data() + size(), other.data());
+    }
+
+    bool operator!=(const DynMatrix &other) const
+    {
+        return !(*this == other);
+    }
+
+    // formating
+    friend std::ostream &operator<<(std::ostream &os, const DynMatrix &matrix)
+    {
+        for (size_t i = 0; i < matrix.rows(); ++i) {
+            os << "[";
+            for (size_t j = 0; j < matrix.cols(); ++j) {
+                os << matrix(i, j);
+                if (j + 1 < matrix.cols()) {
+                    os << ", ";
+                }
+            }
+            os << "]\n";
+        }
+        return os;
+    }
+
+private:
+    [[nodiscard]] size_t size() const
+    { return rowCount * colCount; }
+
+    // A result of the given size computed from an operand allocated from memory, see detail::resultResource.
+    static DynMatrix uninitialized(size_t rows, size_t cols, std::pmr::memory_resource *memory)
+    {
+        DynMatrix result(detail::resultResource(rows * cols * sizeof(T), memory));
+        result.storage.resize(rows * cols);
+        result.rowCount = rows;
+        result.colCount = cols;
+        return result;
+    }
+
+    template<typename F>
+    DynMatrix zip(const DynMatrix &other, F &&f) const
+    {
+        assert(rowCount == other.rowCount && colCount == other.colCount && "DynMatrix size mismatch.");
+        DynMatrix result = uninitialized(rowCount, colCount, memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) { result.data()[i] = f(data()[i], other.data()[i]); });
+        return result;
+    }
+
+    template<typename F>
+    DynMatrix &zipAssign(const DynMatrix &other, F &&f)
+    {
+        assert(rowCount == other.rowCount && colCount == other.colCount && "DynMatrix size mismatch.");
+        detail::forEachIndex<T>(size(), [&](size_t i) { f(data()[i], other.data()[i]); });
+        return *this;
+    }
+};
+
+}
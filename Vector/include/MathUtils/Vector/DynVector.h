@@ -0,0 +1,569 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include "Arena.h"
+#include "Vector.h"
+
+// Bytes of elements a DynVector or DynMatrix stores inside itself before it allocates.
+#ifndef MATHUTILS_DYN_INLINE_BYTES
+    #define MATHUTILS_DYN_INLINE_BYTES 64
+#endif
+
+namespace MathUtils
+{
+
+namespace detail
+{
+// Dynamic element storage is aligned to a SIMD register.
+template<typename T>
+inline constexpr size_t dynAlignment = std::max<size_t>(alignof(T), MATHUTILS_VECTOR_SIMD_BYTES);
+
+/**
+ * The elements of DynVector and DynMatrix. Up to inlineCount elements live inside the object, more are allocated from
+ * a std::pmr::memory_resource. Like the std::pmr containers, moves keep the allocation when both sides use equal
+ * resources and copy the elements otherwise, and the resource itself never changes after construction.
+ *
+ * An object allocated from an Arena remembers how many of the arena's scopes were open when it was created. It only
+ * takes over allocations made at that depth or outside of it, and copies results of nested scopes, which are rewound
+ * while it is still alive. Move constructing from an arena with open scopes copies to its upstream resource, see
+ * detail::movedResource.
+ * @tparam T The element type.
+ */
+template<typename T>
+class DynStorage
+{
+public:
+    static constexpr size_t inlineCount = std::max<size_t>(MATHUTILS_DYN_INLINE_BYTES / sizeof(T), 1);
+
+private:
+    alignas(dynAlignment<T>) T buffer[inlineCount];
+    T *elements;
+    size_t count;
+    std::pmr::memory_resource *memory;
+    // The resource elements was allocated from, memory unless that is an arena in a deeper scope than level.
+    std::pmr::memory_resource *source;
+    // The scope depth of memory when this object was created, see Arena::Scope::depth.
+    size_t level;
+
+public:
+    DynStorage(size_t count, std::pmr::memory_resource *memory)
+            : elements(buffer), count(0), memory(memory), source(memory), level(Arena::Scope::depth(memory))
+    {
+        assert(memory != nullptr && "Memory resource must not be null.");
+        resize(count);
+    }
+
+    DynStorage(const DynStorage &other, std::pmr::memory_resource *memory) : DynStorage(other.count, memory)
+    {
+        std::copy_n(other.elements, count, elements);
+    }
+
+    DynStorage(DynStorage &&other) noexcept
+            : elements(buffer), count(0), memory(detail::movedResource(other.memory)), source(memory),
+              level(Arena::Scope::depth(memory))
+    {
+        take(other);
+    }
+
+    ~DynStorage()
+    {
+        release();
+    }
+
+    DynStorage &operator=(const DynStorage &other)
+    {
+        if (this != &other) {
+            resize(other.count);
+            std::copy_n(other.elements, count, elements);
+        }
+        return *this;
+    }
+
+    DynStorage &operator=(DynStorage &&other) noexcept
+    {
+        if (this != &other) {
+            take(other);
+        }
+        return *this;
+    }
+
+    // Changes the size, leaving the elements uninitialized if the allocation changes.
+    void resize(size_t size)
+    {
+        if (size == count) {
+            return;
+        }
+        release();
+        if (size > inlineCount) {
+            source = detail::allocationResource(memory, level);
+            elements = static_cast<T *>(source->allocate(size * sizeof(T), dynAlignment<T>));
+        }
+        count = size;
+    }
+
+    [[nodiscard]] size_t size() const
+    { return count; }
+
+    T *data()
+    { return elements; }
+
+    const T *data() const
+    { return elements; }
+
+    [[nodiscard]] std::pmr::memory_resource *resource() const
+    { return memory; }
+
+private:
+    void release()
+    {
+        if (elements != buffer) {
+            source->deallocate(elements, count * sizeof(T), dynAlignment<T>);
+            elements = buffer;
+        }
+        count = 0;
+    }
+
+    void take(DynStorage &other)
+    {
+        // An allocation made in a deeper scope than this object's is rewound before this object is destroyed.
+        if (other.elements == other.buffer || !memory->is_equal(*other.memory) || other.level > level) {
+            resize(other.count);
+            std::copy_n(other.elements, count, elements);
+            return;
+        }
+        release();
+        elements = other.elements;
+        count = other.count;
+        source = other.source;
+        other.elements = other.buffer;
+        other.count = 0;
+    }
+};
+
+// Picks the same reduction lane count a fixed size Vector of n elements uses, so both give bit-identical results.
+template<typename T, Summation S, typename F>
+T dynAccumulate(size_t n, F &&f)
+{
+    if (n > MATHUTILS_VECTOR_CHUNK_THRESHOLD) {
+        return accumulate<T, S, fastReductionLanes<T>>(n, f);
+    }
+    return accumulate<T, S, 1>(n, f);
+}
+
+template<typename T, typename F, typename Op>
+T dynReduce(size_t n, const T &init, F &&f, Op &&op)
+{
+    if (n > MATHUTILS_VECTOR_CHUNK_THRESHOLD) {
+        return chunkedReduce<T, simdLanes<T>>(n, init, f, op);
+    }
+    return chunkedReduce<T, 1>(n, init, f, op);
+}
+}
+
+/**
+ * A vector whose size is chosen at runtime, with the operators and reductions of Vector. It shares Vector's kernels
+ * and gives the same results as a Vector of the same size. Small vectors are stored inline, larger ones in SIMD aligned
+ * memory from a std::pmr::memory_resource. Results of operations are allocated from the resource of the left operand,
+ * or from the active Arena if they are at least its threshold in size.
+ * @tparam T The element type.
+ */
+template<typename T>
+class DynVector
+{
+    static_assert(std::is_arithmetic_v<T>, "DynVector's template parameter T must be a numerical type.");
+
+    detail::DynStorage<T> storage;
+
+public:
+    // The type dot products, sums and products of this vector are accumulated in.
+    using AccumulatorType = typename ElementTraits<T>::Accumulator;
+
+    // Constructors
+    // The empty vector.
+    explicit DynVector(std::pmr::memory_resource *memory = std::pmr::get_default_resource()) : storage(0, memory)
+    {}
+
+    // A vector of size zeros.
+    explicit DynVector(size_t size, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : DynVector(size, T(0), memory)
+    {}
+
+    DynVector(size_t size, const T &value, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : storage(size, memory)
+    {
+        std::fill_n(data(), size, value);
+    }
+
+    DynVector(std::initializer_list<T> values, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : storage(values.size(), memory)
+    {
+        std::copy(values.begin(), values.end(), data());
+    }
+
+    explicit DynVector(std::span<const T> values, std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : storage(values.size(), memory)
+    {
+        std::copy(values.begin(), values.end(), data());
+    }
+
+    template<size_t N>
+    explicit DynVector(const Vector<T, N> &vector,
+                       std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+            : storage(N, memory)
+    {
+        std::copy_n(vector.data.begin(), N, data());
+    }
+
+    // Like the std::pmr containers, a copy uses the default memory resource unless it is given one.
+    DynVector(const DynVector &other) : storage(other.storage, std::pmr::get_default_resource())
+    {}
+
+    DynVector(const DynVector &other, std::pmr::memory_resource *memory) : storage(other.storage, memory)
+    {}
+
+    DynVector(DynVector &&other) noexcept = default;
+
+    DynVector &operator=(const DynVector &other) = default;
+
+    DynVector &operator=(DynVector &&other) noexcept = default;
+
+    // The fixed size vector with the same elements. N must equal size().
+    template<size_t N>
+    Vector<T, N> toVector() const
+    {
+        assert(N == size() && "Vector size mismatch.");
+        Vector<T, N> result;
+        std::copy_n(data(), N, result.data.begin());
+        return result;
+    }
+
+    // accessor methods
+    [[nodiscard]] size_t size() const
+    { return storage.size(); }
+
+    T *data()
+    { return storage.data(); }
+
+    const T *data() const
+    { return storage.data(); }
+
+    T *begin()
+    { return data(); }
+
+    const T *begin() const
+    { return data(); }
+
+    T *end()
+    { return data() + size(); }
+
+    const T *end() const
+    { return data() + size(); }
+
+    // The resource the elements, and the results of arithmetic on this vector, are allocated from.
+    [[nodiscard]] std::pmr::memory_resource *memoryResource() const
+    { return storage.resource(); }
+
+    T &operator[](size_t index)
+    {
+        assert(index < size() && "DynVector index out of bounds.");
+        return data()[index];
+    }
+
+    const T &operator[](size_t index) const
+    {
+        assert(index < size() && "DynVector index out of bounds.");
+        return data()[index];
+    }
+
+    // Arithmetic
+    DynVector operator-() const
+    {
+        return map([](const T &a) { return static_cast<T>(-a); });
+    }
+
+    DynVector operator+() const
+    {
+        return *this;
+    }
+
+    DynVector operator+(const DynVector &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a + b); });
+    }
+
+    DynVector operator-(const DynVector &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a - b); });
+    }
+
+    DynVector operator*(const DynVector &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a * b); });
+    }
+
+    DynVector operator/(const DynVector &other) const
+    {
+        return zip(other, [](const T &a, const T &b) { return static_cast<T>(a / b); });
+    }
+
+    DynVector &operator+=(const DynVector &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a += b; });
+    }
+
+    DynVector &operator-=(const DynVector &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a -= b; });
+    }
+
+    DynVector &operator*=(const DynVector &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a *= b; });
+    }
+
+    DynVector &operator/=(const DynVector &other)
+    {
+        return zipAssign(other, [](T &a, const T &b) { a /= b; });
+    }
+
+    DynVector operator+(const T &scalar) const
+    {
+        return map([&](const T &a) { return static_cast<T>(a + scalar); });
+    }
+
+    DynVector operator-(const T &scalar) const
+    {
+        return map([&](const T &a) { return static_cast<T>(a - scalar); });
+    }
+
+    DynVector operator*(const T &scalar) const
+    {
+        return map([&](const T &a) { return static_cast<T>(a * scalar); });
+    }
+
+    DynVector operator/(const T &scalar) const
+    {
+        return map([&](const T &a) { return static_cast<T>(a / scalar); });
+    }
+
+    DynVector &operator+=(const T &scalar)
+    {
+        return mapAssign([&](T &a) { a += scalar; });
+    }
+
+    DynVector &operator-=(const T &scalar)
+    {
+        return mapAssign([&](T &a) { a -= scalar; });
+    }
+
+    DynVector &operator*=(const T &scalar)
+    {
+        return mapAssign([&](T &a) { a *= scalar; });
+    }
+
+    DynVector &operator/=(const T &scalar)
+    {
+        return mapAssign([&](T &a) { a /= scalar; });
+    }
+
+    // Computes this * other + addend element-wise, with hardware FMA when the target has it.
+    DynVector madd(const DynVector &other, const DynVector &addend) const
+    {
+        assert(size() == other.size() && size() == addend.size() && "DynVector size mismatch.");
+        DynVector result = uninitialized(size(), memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) {
+            result.data()[i] = detail::multiplyAdd(data()[i], other.data()[i], addend.data()[i]);
+        });
+        return result;
+    }
+
+    // Computes this * scalar + addend element-wise.
+    DynVector madd(const T &scalar, const DynVector &addend) const
+    {
+        assert(size() == addend.size() && "DynVector size mismatch.");
+        DynVector result = uninitialized(size(), memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) {
+            result.data()[i] = detail::multiplyAdd(data()[i], scalar, addend.data()[i]);
+        });
+        return result;
+    }
+
+    // Reductions, see the Vector functions of the same names.
+    template<Summation S = Summation::Fast>
+    AccumulatorType dot(const DynVector &other) const
+    {
+        assert(size() == other.size() && "DynVector size mismatch.");
+        using Acc = detail::SummationType<T, S>;
+        return static_cast<AccumulatorType>(detail::dynAccumulate<Acc, S>(size(), [&](size_t i) {
+            return static_cast<Acc>(static_cast<Acc>(data()[i]) * static_cast<Acc>(other.data()[i]));
+        }));
+    }
+
+    template<Summation S = Summation::Fast>
+    AccumulatorType sum() const
+    {
+        using Acc = detail::SummationType<T, S>;
+        return static_cast<AccumulatorType>(detail::dynAccumulate<Acc, S>(size(), [&](size_t i) {
+            return static_cast<Acc>(data()[i]);
+        }));
+    }
+
+    AccumulatorType product() const
+    {
+        using Acc = AccumulatorType;
+        auto term = [&](size_t i) { return static_cast<Acc>(data()[i]); };
+        auto mul = [](const Acc &a, const Acc &b) { return static_cast<Acc>(a * b); };
+        if (size() > MATHUTILS_VECTOR_CHUNK_THRESHOLD) {
+            return detail::chunkedReduce<Acc, detail::fastReductionLanes<Acc>>(size(), Acc(1), term, mul);
+        }
+        return detail::chunkedReduce<Acc, 1>(size(), Acc(1), term, mul);
+    }
+
+    T minElement() const
+    {
+        assert(size() > 0 && "Empty DynVector has no elements.");
+        return detail::dynReduce<T>(size(), data()[0], [&](size_t i) { return data()[i]; },
+                                    [](const T &a, const T &b) { return b < a ? b : a; });
+    }
+
+    T maxElement() const
+    {
+        assert(size() > 0 && "Empty DynVector has no elements.");
+        return detail::dynReduce<T>(size(), data()[0], [&](size_t i) { return data()[i]; },
+                                    [](const T &a, const T &b) { return a < b ? b : a; });
+    }
+
+    size_t argmin() const
+    {
+        return argBest([](const T &a, const T &b) { return a < b; });
+    }
+
+    size_t argmax() const
+    {
+        return argBest([](const T &a, const T &b) { return b < a; });
+    }
+
+    template<Summation S = Summation::Fast>
+    AccumulatorType squaredLength() const
+    {
+        return dot<S>(*this);
+    }
+
+    template<size_t P, Summation S = Summation::Fast>
+    auto norm() const
+    {
+        static_assert(P > 0, "The order of a norm must be greater than 0.");
+        using Real = std::conditional_t<std::is_floating_point_v<AccumulatorType>, AccumulatorType, double>;
+        auto absolute = [](const T &v) {
+            Real r = static_cast<Real>(v);
+            return r < Real() ? -r : r;
+        };
+        if constexpr (P == InfinityNorm) {
+            return detail::dynReduce<Real>(size(), Real(), [&](size_t i) { return absolute(data()[i]); },
+                                           [](const Real &a, const Real &b) { return a < b ? b : a; });
+        } else if constexpr (P == 1) {
+            using Acc = detail::SummationType<Real, S>;
+            return static_cast<Real>(detail::dynAccumulate<Acc, S>(size(), [&](size_t i) {
+                return static_cast<Acc>(absolute(data()[i]));
+            }));
+        } else if constexpr (P == 2) {
+            return static_cast<Real>(std::sqrt(static_cast<Real>(squaredLength<S>())));
+        } else {
+            using Acc = detail::SummationType<Real, S>;
+            auto power = [&](size_t i) {
+                return static_cast<Acc>(std::pow(static_cast<Acc>(absolute(data()[i])), Acc(P)));
+            };
+            return static_cast<Real>(std::pow(detail::dynAccumulate<Acc, S>(size(), power), Acc(1) / Acc(P)));
+        }
+    }
+
+    auto length() const
+    {
+        return norm<2>();
+    }
+
+    // Vectors of different sizes are never equal.
+    bool operator==(const DynVector &other) const
+    {
+        return size() == other.size() && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const DynVector &other) const
+    {
+        return !(*this == other);
+    }
+
+    // formating
+    friend std::ostream &operator<<(std::ostream &os, const DynVector &vec)
+    {
+        os << "(";
+        for (size_t i = 0; i < vec.size(); ++i) {
+            os << vec[i];
+            if (i + 1 < vec.size()) {
+                os << ", ";
+            }
+        }
+        os << ")";
+        return os;
+    }
+
+private:
+    // A result of the given size computed from an operand allocated from memory, see detail::resultResource.
+    static DynVector uninitialized(size_t size, std::pmr::memory_resource *memory)
+    {
+        DynVector result(detail::resultResource(size * sizeof(T), memory));
+        result.storage.resize(size);
+        return result;
+    }
+
+    template<typename F>
+    DynVector map(F &&f) const
+    {
+        DynVector result = uninitialized(size(), memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) { result.data()[i] = f(data()[i]); });
+        return result;
+    }
+
+    template<typename F>
+    DynVector zip(const DynVector &other, F &&f) const
+    {
+        assert(size() == other.size() && "DynVector size mismatch.");
+        DynVector result = uninitialized(size(), memoryResource());
+        detail::forEachIndex<T>(size(), [&](size_t i) { result.data()[i] = f(data()[i], other.data()[i]); });
+        return result;
+    }
+
+    template<typename F>
+    DynVector &mapAssign(F &&f)
+    {
+        detail::forEachIndex<T>(size(), [&](size_t i) { f(data()[i]); });
+        return *this;
+    }
+
+    template<typename F>
+    DynVector &zipAssign(const DynVector &other, F &&f)
+    {
+        assert(size() == other.size() && "DynVector size mismatch.");
+        detail::forEachIndex<T>(size(), [&](size_t i) { f(data()[i], other.data()[i]); });
+        return *this;
+    }
+
+    template<typename Better>
+    size_t argBest(Better &&better) const
+    {
+        assert(size() > 0 && "Empty DynVector has no elements.");
+        if (size() > MATHUTILS_VECTOR_CHUNK_THRESHOLD) {
+            return detail::chunkedArgBest<detail::simdLanes<T>>(data(), size(), better);
+        }
+        return detail::chunkedArgBest<1>(data(), size(), better);
+    }
+};
+
+}
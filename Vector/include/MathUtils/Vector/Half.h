@@ -0,0 +1,336 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include "Vector.h"
+
+// F16C provides single instruction conversions between half and single precision. MSVC does not define __F16C__,
+// but every AVX2 target supports it.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+    #define MATHUTILS_VECTOR_HAS_F16C
+#endif
+
+#if defined(MATHUTILS_VECTOR_HAS_F16C) || defined(__AVX512BF16__)
+    #include <immintrin.h>
+#endif
+
+namespace MathUtils
+{
+
+namespace detail
+{
+/**
+ * Converts a float to the bits of the nearest IEEE 754 binary16 value, rounding ties to even.
+ */
+constexpr uint16_t floatToHalfBits(float value)
+{
+    uint32_t f = std::bit_cast<uint32_t>(value);
+    uint32_t sign = (f >> 16) & 0x8000u;
+    uint32_t exponent = (f >> 23) & 0xFFu;
+    uint32_t mantissa = f & 0x7FFFFFu;
+
+    if (exponent == 0xFFu) { // Infinity or NaN, keeping NaNs quiet.
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u | (mantissa >> 13) : 0u));
+    }
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 0x1F) { // Overflow.
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (halfExponent <= 0) { // Subnormal or underflow to zero.
+        if (halfExponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        half += (remainder > halfway || (remainder == halfway && (half & 1u))) ? 1u : 0u;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity.
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+    half += (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) ? 1u : 0u;
+    return static_cast<uint16_t>(sign | half);
+}
+
+/**
+ * Converts the bits of an IEEE 754 binary16 value to a float. The conversion is exact.
+ */
+constexpr float halfBitsToFloat(uint16_t bits)
+{
+    uint32_t sign = static_cast<uint32_t>(bits & 0x8000u) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1Fu;
+    uint32_t mantissa = bits & 0x3FFu;
+
+    if (exponent == 0x1Fu) {
+        return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+    }
+    if (exponent == 0) { // Zero or subnormal, which is mantissa * 2^-24.
+        float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+/**
+ * Converts a float to the bits of the nearest bfloat16 value, rounding ties to even.
+ */
+constexpr uint16_t floatToBFloat16Bits(float value)
+{
+    uint32_t f = std::bit_cast<uint32_t>(value);
+    if ((f & 0x7FFFFFFFu) > 0x7F800000u) { // NaN, keeping it quiet.
+        return static_cast<uint16_t>((f >> 16) | 0x40u);
+    }
+    f += 0x7FFFu + ((f >> 16) & 1u);
+    return static_cast<uint16_t>(f >> 16);
+}
+
+/**
+ * Converts the bits of a bfloat16 value to a float. The conversion is exact.
+ */
+constexpr float bfloat16BitsToFloat(uint16_t bits)
+{
+    return std::bit_cast<float>(static_cast<uint32_t>(bits) << 16);
+}
+}
+
+/**
+ * IEEE 754 binary16 storage type. Values are stored in 16 bits and widened to float for every arithmetic operation.
+ */
+struct float16_t
+{
+    uint16_t bits;
+
+    float16_t() = default;
+
+    constexpr float16_t(float value) : bits(0)
+    {
+        if !consteval {
+#ifdef MATHUTILS_VECTOR_HAS_F16C
+            bits = static_cast<uint16_t>(_cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT));
+            return;
+#endif
+        }
+        bits = detail::floatToHalfBits(value);
+    }
+
+    // Reinterprets raw binary16 bits as a value.
+    static constexpr float16_t fromBits(uint16_t bits)
+    {
+        float16_t result;
+        result.bits = bits;
+        return result;
+    }
+
+    constexpr operator float() const
+    {
+        if !consteval {
+#ifdef MATHUTILS_VECTOR_HAS_F16C
+            return _cvtsh_ss(bits);
+#endif
+        }
+        return detail::halfBitsToFloat(bits);
+    }
+
+    constexpr float16_t &operator+=(float value)
+    { return *this = float16_t(float(*this) + value); }
+
+    constexpr float16_t &operator-=(float value)
+    { return *this = float16_t(float(*this) - value); }
+
+    constexpr float16_t &operator*=(float value)
+    { return *this = float16_t(float(*this) * value); }
+
+    constexpr float16_t &operator/=(float value)
+    { return *this = float16_t(float(*this) / value); }
+
+    friend std::ostream &operator<<(std::ostream &os, const float16_t &value)
+    {
+        return os << float(value);
+    }
+};
+
+/**
+ * bfloat16 storage type: the upper half of a float. Keeps float's range with 8 bits of precision and is widened to
+ * float for every arithmetic operation.
+ */
+struct bfloat16_t
+{
+    uint16_t bits;
+
+    bfloat16_t() = default;
+
+    constexpr bfloat16_t(float value) : bits(detail::floatToBFloat16Bits(value))
+    {}
+
+    // Reinterprets raw bfloat16 bits as a value.
+    static constexpr bfloat16_t fromBits(uint16_t bits)
+    {
+        bfloat16_t result;
+        result.bits = bits;
+        return result;
+    }
+
+    constexpr operator float() const
+    {
+        return detail::bfloat16BitsToFloat(bits);
+    }
+
+    constexpr bfloat16_t &operator+=(float value)
+    { return *this = bfloat16_t(float(*this) + value); }
+
+    constexpr bfloat16_t &operator-=(float value)
+    { return *this = bfloat16_t(float(*this) - value); }
+
+    constexpr bfloat16_t &operator*=(float value)
+    { return *this = bfloat16_t(float(*this) * value); }
+
+    constexpr bfloat16_t &operator/=(float value)
+    { return *this = bfloat16_t(float(*this) / value); }
+
+    friend std::ostream &operator<<(std::ostream &os, const bfloat16_t &value)
+    {
+        return os << float(value);
+    }
+};
+
+// Batch conversion kernels
+/**
+ * Widens an array of half precision values to floats, 8 at a time with F16C when available.
+ * @param in The values to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void convertToFloat(std::span<const float16_t> in, std::span<float> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t i = 0;
+#ifdef MATHUTILS_VECTOR_HAS_F16C
+    for (; i + 8 <= in.size(); i += 8) {
+        __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data() + i));
+        _mm256_storeu_ps(out.data() + i, _mm256_cvtph_ps(half));
+    }
+#endif
+    for (; i < in.size(); ++i) {
+        out[i] = static_cast<float>(in[i]);
+    }
+}
+
+/**
+ * Narrows an array of floats to half precision, rounding to nearest even, 8 at a time with F16C when available.
+ * @param in The values to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void convertFromFloat(std::span<const float> in, std::span<float16_t> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t i = 0;
+#ifdef MATHUTILS_VECTOR_HAS_F16C
+    for (; i + 8 <= in.size(); i += 8) {
+        __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(in.data() + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data() + i), half);
+    }
+#endif
+    for (; i < in.size(); ++i) {
+        out[i] = float16_t(in[i]);
+    }
+}
+
+/**
+ * Widens an array of bfloat16 values to floats. This is a plain shift, which the compiler vectorizes.
+ * @param in The values to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void convertToFloat(std::span<const bfloat16_t> in, std::span<float> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = detail::bfloat16BitsToFloat(in[i].bits);
+    }
+}
+
+/**
+ * Narrows an array of floats to bfloat16, rounding to nearest even, 16 at a time with AVX-512 BF16 when available.
+ * @param in The values to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void convertFromFloat(std::span<const float> in, std::span<bfloat16_t> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t i = 0;
+#ifdef __AVX512BF16__
+    for (; i + 16 <= in.size(); i += 16) {
+        __m256bh narrow = _mm512_cvtneps_pbh(_mm512_loadu_ps(in.data() + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out.data() + i), reinterpret_cast<__m256i &>(narrow));
+    }
+#endif
+    for (; i < in.size(); ++i) {
+        out[i].bits = detail::floatToBFloat16Bits(in[i]);
+    }
+}
+
+// Reductions widen blocks of elements with the batch conversions above, see detail::BlockWidened.
+template<>
+struct ElementTraits<float16_t>
+{
+    static constexpr bool isElement = true;
+    using Accumulator = float;
+
+    static void widen(const float16_t *in, size_t count, float *out)
+    {
+        convertToFloat(std::span(in, count), std::span(out, count));
+    }
+};
+
+template<>
+struct ElementTraits<bfloat16_t>
+{
+    static constexpr bool isElement = true;
+    using Accumulator = float;
+
+    static void widen(const bfloat16_t *in, size_t count, float *out)
+    {
+        convertToFloat(std::span(in, count), std::span(out, count));
+    }
+};
+
+/**
+ * Widens a half precision vector to a float vector.
+ */
+template<size_t N>
+Vector<float, N> toFloat(const Vector<float16_t, N> &v)
+{
+    Vector<float, N> result;
+    convertToFloat(v.data, result.data);
+    return result;
+}
+
+/**
+ * Widens a bfloat16 vector to a float vector.
+ */
+template<size_t N>
+Vector<float, N> toFloat(const Vector<bfloat16_t, N> &v)
+{
+    Vector<float, N> result;
+    convertToFloat(v.data, result.data);
+    return result;
+}
+
+#ifdef USING_ALL_VECTOR_TYPES
+    #define USING_HALF_VECTOR_TYPES
+    #define USING_BFLOAT16_VECTOR_TYPES
+#endif
+
+#ifdef USING_HALF_VECTOR_TYPES
+VECTOR_ALL(H, float16_t)
+#endif
+
+#ifdef USING_BFLOAT16_VECTOR_TYPES
+VECTOR_ALL(BF16, bfloat16_t)
+#endif
+
+}
@@ -0,0 +1,673 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+#include "SparseMatrix.h"
+#include "Vector.h"
+
+namespace MathUtils
+{
+
+// Stopping criteria of the iterative solvers.
+template<typename T>
+struct SolverOptions
+{
+    // The most matrix-vector products with A to spend.
+    size_t maxIterations = 1000;
+    // Stop once |b - A x| <= tolerance * |b|.
+    T tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+};
+
+template<typename T>
+struct SolverResult
+{
+    // The number of iterations run.
+    size_t iterations = 0;
+    // |b - A x| / |b| as tracked by the solver's recurrences.
+    T residual = T(0);
+    bool converged = false;
+};
+
+namespace detail
+{
+// The operators the solvers accept: sparse and dense matrices, or any f(x, y) that sets y = A x.
+template<typename T, SparseStorage S>
+void applyOperator(const SparseMatrix<T, S> &a, std::span<const T> x, std::span<T> y)
+{
+    a.multiply(x, y);
+}
+
+template<typename T>
+void applyOperator(const SlicedEllpackMatrix<T> &a, std::span<const T> x, std::span<T> y)
+{
+    a.multiply(x, y);
+}
+
+template<typename T, size_t N>
+void applyOperator(const Matrix<T, N, N> &a, std::span<const T> x, std::span<T> y)
+{
+    assert(x.size() == N && y.size() == N && "Span size mismatch.");
+    Vector<T, N> v;
+    std::copy(x.begin(), x.end(), v.data.begin());
+    for (size_t i = 0; i < N; ++i) {
+        y[i] = a[i].dot(v);
+    }
+}
+
+template<typename T, typename F>
+requires std::invocable<const F &, std::span<const T>, std::span<T>>
+void applyOperator(const F &f, std::span<const T> x, std::span<T> y)
+{
+    f(x, y);
+}
+
+// Like Vector, the solvers only touch each array as often as the algorithm needs. These kernels fuse the vector updates
+// with the dot products that follow them, so each iteration makes as few passes over memory as possible. The sums are
+// split over fastReductionLanes<T> independent partial sums, as in the large Vector reductions, so they are not bound
+// by the latency of a single add chain.
+template<typename T, typename F>
+T reduce(size_t n, F &&f)
+{
+    return chunkedReduce<T, fastReductionLanes<T>>(n, T(0), f, [](T a, T b) { return a + b; });
+}
+
+// Two sums over [0, n) in one pass. f(i) returns the pair of terms of index i.
+template<typename T, typename F>
+std::pair<T, T> reducePair(size_t n, F &&f)
+{
+    constexpr size_t Lanes = fastReductionLanes<T>;
+    std::array<T, Lanes> first;
+    std::array<T, Lanes> second;
+    first.fill(T(0));
+    second.fill(T(0));
+    auto add = [&](size_t j, size_t i) {
+        auto [a, b] = f(i);
+        first[j] += a;
+        second[j] += b;
+    };
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j) {
+            add(j, i + j);
+        }
+    }
+    for (size_t j = 0; i + j < n; ++j) {
+        add(j, i + j);
+    }
+    auto plus = [](T a, T b) { return a + b; };
+    return {combineLanes(first, plus), combineLanes(second, plus)};
+}
+
+template<typename T>
+T dot(const T *a, const T *b, size_t n)
+{
+    return reduce<T>(n, [&](size_t i) { return a[i] * b[i]; });
+}
+
+// y += alpha * x, returning the new y . z. z may be y.
+template<typename T>
+T axpyDot(T alpha, const T *x, T *y, const T *z, size_t n)
+{
+    return reduce<T>(n, [&](size_t i) {
+        y[i] += alpha * x[i];
+        return y[i] * z[i];
+    });
+}
+
+// x += alpha * p and r -= alpha * q, returning the new r . r.
+template<typename T>
+T updateSolution(T alpha, const T *p, const T *q, T *x, T *r, size_t n)
+{
+    return reduce<T>(n, [&](size_t i) {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * q[i];
+        return r[i] * r[i];
+    });
+}
+
+// r = b - r, returning the new r . r.
+template<typename T>
+T residual(const T *b, T *r, size_t n)
+{
+    return reduce<T>(n, [&](size_t i) {
+        r[i] = b[i] - r[i];
+        return r[i] * r[i];
+    });
+}
+}
+
+// z = r. The default preconditioner, which the solvers skip entirely.
+template<typename T>
+class IdentityPreconditioner
+{
+public:
+    void apply(std::span<const T> r, std::span<T> z) const
+    {
+        std::copy(r.begin(), r.end(), z.begin());
+    }
+};
+
+/**
+ * Divides by the diagonal of A. Costs one pass and n values of storage. Needs a nonzero diagonal.
+ * @tparam T The element type.
+ */
+template<typename T>
+class JacobiPreconditioner
+{
+    std::vector<T> inverseDiagonal;
+
+public:
+    template<SparseStorage S>
+    explicit JacobiPreconditioner(const SparseMatrix<T, S> &a) : inverseDiagonal(a.rows(), T(0))
+    {
+        assert(a.rows() == a.cols() && "Preconditioner needs a square matrix.");
+        a.forEachNonZero([&](size_t row, size_t col, const T &value) {
+            if (row == col) {
+                inverseDiagonal[row] += value;
+            }
+        });
+        invert();
+    }
+
+    template<size_t N>
+    explicit JacobiPreconditioner(const Matrix<T, N, N> &a) : inverseDiagonal(N)
+    {
+        for (size_t i = 0; i < N; ++i) {
+            inverseDiagonal[i] = a(i, i);
+        }
+        invert();
+    }
+
+    void apply(std::span<const T> r, std::span<T> z) const
+    {
+        assert(r.size() == inverseDiagonal.size() && z.size() == r.size() && "Span size mismatch.");
+        for (size_t i = 0; i < r.size(); ++i) {
+            z[i] = r[i] * inverseDiagonal[i];
+        }
+    }
+
+private:
+    void invert()
+    {
+        for (T &d: inverseDiagonal) {
+            assert(d != T(0) && "Jacobi preconditioner needs a nonzero diagonal.");
+            d = T(1) / d;
+        }
+    }
+};
+
+/**
+ * Solves with the B x B blocks on the diagonal of A, each factored once by LU. The last block is padded with the
+ * identity when B does not divide the size of A. Needs nonsingular diagonal blocks.
+ * @tparam T The element type.
+ * @tparam B The block size.
+ */
+template<typename T, size_t B>
+class BlockJacobiPreconditioner
+{
+    size_t size;
+    std::vector<LU<T, B>> factors;
+
+public:
+    template<SparseStorage S>
+    explicit BlockJacobiPreconditioner(const SparseMatrix<T, S> &a) : size(a.rows())
+    {
+        assert(a.rows() == a.cols() && "Preconditioner needs a square matrix.");
+        std::vector<Matrix<T, B, B>> blocks((size + B - 1) / B, Matrix<T, B, B>());
+        a.forEachNonZero([&](size_t row, size_t col, const T &value) {
+            if (row / B == col / B) {
+                blocks[row / B](row % B, col % B) = value;
+            }
+        });
+        factor(blocks);
+    }
+
+    template<size_t N>
+    explicit BlockJacobiPreconditioner(const Matrix<T, N, N> &a) : size(N)
+    {
+        std::vector<Matrix<T, B, B>> blocks((N + B - 1) / B, Matrix<T, B, B>());
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = i / B * B; j < std::min(i / B * B + B, N); ++j) {
+                blocks[i / B](i % B, j % B) = a(i, j);
+            }
+        }
+        factor(blocks);
+    }
+
+    void apply(std::span<const T> r, std::span<T> z) const
+    {
+        assert(r.size() == size && z.size() == size && "Span size mismatch.");
+        for (size_t block = 0; block < factors.size(); ++block) {
+            size_t begin = block * B;
+            size_t count = std::min(B, size - begin);
+            Vector<T, B> rhs(T(0));
+            std::copy_n(r.begin() + static_cast<ptrdiff_t>(begin), count, rhs.data.begin());
+            Vector<T, B> solution = factors[block].solve(rhs);
+            std::copy_n(solution.data.begin(), count, z.begin() + static_cast<ptrdiff_t>(begin));
+        }
+    }
+
+private:
+    void factor(std::vector<Matrix<T, B, B>> &blocks)
+    {
+        factors.reserve(blocks.size());
+        for (size_t block = 0; block < blocks.size(); ++block) {
+            for (size_t i = size - block * B; i < B; ++i) {
+                blocks[block](i, i) = T(1);
+            }
+            factors.emplace_back(blocks[block]);
+            assert(!factors.back().singular() && "Block Jacobi preconditioner needs nonsingular diagonal blocks.");
+        }
+    }
+};
+
+/**
+ * Zero fill-in incomplete Cholesky, IC(0). Computes L with the sparsity of the lower triangle of a symmetric A so that
+ * L L^T approximates A, and applies (L L^T)^-1 by two triangular solves. Only the lower triangle of A is read.
+ * @tparam T The element type.
+ */
+template<typename T>
+class IncompleteCholeskyPreconditioner
+{
+    // L in compressed rows, each row ending with its diagonal.
+    SparseMatrix<T> lower;
+    bool isPositiveDefinite = true;
+
+public:
+    template<SparseStorage S>
+    explicit IncompleteCholeskyPreconditioner(const SparseMatrix<T, S> &a)
+    {
+        assert(a.rows() == a.cols() && "Preconditioner needs a square matrix.");
+        size_t n = a.rows();
+        std::vector<Triplet<T>> triplets;
+        a.forEachNonZero([&](size_t row, size_t col, const T &value) {
+            if (col <= row) {
+                triplets.push_back({row, col, value});
+            }
+        });
+        // Make every diagonal element exist, so each row of L ends with it.
+        for (size_t i = 0; i < n; ++i) {
+            triplets.push_back({i, i, T(0)});
+        }
+        lower = SparseMatrix<T>::fromTriplets(n, n, triplets);
+
+        std::span<const size_t> starts = lower.outerStarts();
+        std::span<const uint32_t> cols = lower.indices();
+        std::span<T> values = lower.values();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = starts[i]; k < starts[i + 1]; ++k) {
+                size_t j = cols[k];
+                // L(i, j) -= sum of L(i, m) L(j, m) over the m < j where both are stored.
+                T sum = values[k];
+                size_t p = starts[i];
+                size_t q = starts[j];
+                while (p < k && q + 1 < starts[j + 1]) {
+                    if (cols[p] == cols[q]) {
+                        sum -= values[p++] * values[q++];
+                    } else if (cols[p] < cols[q]) {
+                        ++p;
+                    } else {
+                        ++q;
+                    }
+                }
+                if (j < i) {
+                    values[k] = sum / values[starts[j + 1] - 1];
+                } else if (sum > T(0)) {
+                    values[k] = std::sqrt(sum);
+                } else {
+                    // Breakdown. Fall back to the original diagonal so the preconditioner stays usable.
+                    isPositiveDefinite = false;
+                    T diagonal = std::abs(a(i, i));
+                    values[k] = diagonal > T(0) ? std::sqrt(diagonal) : T(1);
+                }
+            }
+        }
+    }
+
+    // False if a pivot was not positive and had to be replaced.
+    [[nodiscard]] bool positiveDefinite() const
+    { return isPositiveDefinite; }
+
+    const SparseMatrix<T> &matrixL() const
+    { return lower; }
+
+    void apply(std::span<const T> r, std::span<T> z) const
+    {
+        size_t n = lower.rows();
+        assert(r.size() == n && z.size() == n && "Span size mismatch.");
+        std::span<const size_t> starts = lower.outerStarts();
+        std::span<const uint32_t> cols = lower.indices();
+        std::span<const T> values = lower.values();
+        // L y = r
+        for (size_t i = 0; i < n; ++i) {
+            T sum = r[i];
+            size_t diagonal = starts[i + 1] - 1;
+            for (size_t k = starts[i]; k < diagonal; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum / values[diagonal];
+        }
+        // L^T z = y, scattering each row of L as a column of L^T.
+        for (size_t i = n; i-- > 0;) {
+            size_t diagonal = starts[i + 1] - 1;
+            z[i] /= values[diagonal];
+            for (size_t k = starts[i]; k < diagonal; ++k) {
+                z[cols[k]] -= values[k] * z[i];
+            }
+        }
+    }
+};
+
+/**
+ * Preconditioned conjugate gradient for symmetric positive definite A. Each iteration costs one product with A, one
+ * preconditioner application and three passes over the vectors.
+ * @param a The operator: a SparseMatrix, a square Matrix, or f(x, y) setting y = A x.
+ * @param b The right hand side.
+ * @param x The initial guess, replaced by the solution.
+ * @param options The stopping criteria.
+ * @param preconditioner Applies an approximation of A^-1 that is itself symmetric positive definite.
+ * @return The iterations run and the final relative residual.
+ */
+template<typename T, typename A, typename P = IdentityPreconditioner<T>>
+SolverResult<T> conjugateGradient(const A &a, std::type_identity_t<std::span<const T>> b, std::span<T> x,
+                                  const SolverOptions<T> &options = {}, const P &preconditioner = P())
+{
+    constexpr bool preconditioned = !std::is_same_v<P, IdentityPreconditioner<T>>;
+    size_t n = b.size();
+    assert(x.size() == n && "Span size mismatch.");
+    SolverResult<T> result;
+    T bNorm = std::sqrt(detail::dot(b.data(), b.data(), n));
+    if (bNorm == T(0)) {
+        std::fill(x.begin(), x.end(), T(0));
+        result.converged = true;
+        return result;
+    }
+    T target = options.tolerance * bNorm;
+
+    std::vector<T> r(n);
+    std::vector<T> p(n);
+    std::vector<T> q(n);
+    std::vector<T> z(preconditioned ? n : 0);
+    detail::applyOperator(a, std::span<const T>(x), std::span<T>(r));
+    T rr = detail::residual(b.data(), r.data(), n);
+    // Without a preconditioner z is r.
+    const T *zData = preconditioned ? z.data() : r.data();
+    if constexpr (preconditioned) {
+        preconditioner.apply(r, z);
+    }
+    std::copy_n(zData, n, p.begin());
+    T rz = preconditioned ? detail::dot(r.data(), zData, n) : rr;
+
+    while (std::sqrt(rr) > target && result.iterations < options.maxIterations) {
+        detail::applyOperator(a, std::span<const T>(p), std::span<T>(q));
+        T pq = detail::dot(p.data(), q.data(), n);
+        if (!(pq > T(0))) {
+            // A is not positive definite along p.
+            break;
+        }
+        rr = detail::updateSolution(rz / pq, p.data(), q.data(), x.data(), r.data(), n);
+        ++result.iterations;
+        if (std::sqrt(rr) <= target) {
+            break;
+        }
+        if constexpr (preconditioned) {
+            preconditioner.apply(r, z);
+        }
+        T rzNext = preconditioned ? detail::dot(r.data(), zData, n) : rr;
+        T beta = rzNext / rz;
+        rz = rzNext;
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = zData[i] + beta * p[i];
+        }
+    }
+    result.residual = std::sqrt(rr) / bNorm;
+    result.converged = std::sqrt(rr) <= target;
+    return result;
+}
+
+/**
+ * Right preconditioned BiCGSTAB for general nonsingular A. Each iteration costs two products with A, two
+ * preconditioner applications and six passes over the vectors.
+ * @param a The operator: a SparseMatrix, a square Matrix, or f(x, y) setting y = A x.
+ * @param b The right hand side.
+ * @param x The initial guess, replaced by the solution.
+ * @param options The stopping criteria. Each iteration counts as one.
+ * @param preconditioner Applies an approximation of A^-1.
+ * @return The iterations run and the final relative residual.
+ */
+template<typename T, typename A, typename P = IdentityPreconditioner<T>>
+SolverResult<T> biCgStab(const A &a, std::type_identity_t<std::span<const T>> b, std::span<T> x,
+                         const SolverOptions<T> &options = {}, const P &preconditioner = P())
+{
+    constexpr bool preconditioned = !std::is_same_v<P, IdentityPreconditioner<T>>;
+    size_t n = b.size();
+    assert(x.size() == n && "Span size mismatch.");
+    SolverResult<T> result;
+    T bNorm = std::sqrt(detail::dot(b.data(), b.data(), n));
+    if (bNorm == T(0)) {
+        std::fill(x.begin(), x.end(), T(0));
+        result.converged = true;
+        return result;
+    }
+    T target = options.tolerance * bNorm;
+
+    std::vector<T> r(n);
+    std::vector<T> shadow(n);
+    std::vector<T> p(n, T(0));
+    std::vector<T> v(n, T(0));
+    std::vector<T> t(n);
+    // Without a preconditioner the preconditioned p and s are p and r, which holds s.
+    std::vector<T> pHat(preconditioned ? n : 0);
+    std::vector<T> sHat(preconditioned ? n : 0);
+    const T *pHatData = preconditioned ? pHat.data() : p.data();
+    const T *sHatData = preconditioned ? sHat.data() : r.data();
+
+    detail::applyOperator(a, std::span<const T>(x), std::span<T>(r));
+    T rr = detail::residual(b.data(), r.data(), n);
+    std::copy(r.begin(), r.end(), shadow.begin());
+    // rho = shadow . r, which starts out as r . r.
+    T rho = rr;
+    T rhoPrevious = T(1);
+    T alpha = T(1);
+    T omega = T(1);
+
+    while (std::sqrt(rr) > target && result.iterations < options.maxIterations) {
+        if (rho == T(0)) {
+            // The shadow residual became orthogonal to r.
+            break;
+        }
+        T beta = (rho / rhoPrevious) * (alpha / omega);
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        }
+        if constexpr (preconditioned) {
+            preconditioner.apply(p, pHat);
+        }
+        detail::applyOperator(a, std::span<const T>(pHatData, n), std::span<T>(v));
+        T shadowV = detail::dot(shadow.data(), v.data(), n);
+        if (shadowV == T(0)) {
+            break;
+        }
+        alpha = rho / shadowV;
+        // s = r - alpha v, kept in r.
+        T ss = detail::axpyDot(-alpha, v.data(), r.data(), r.data(), n);
+        ++result.iterations;
+        if (std::sqrt(ss) <= target) {
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += alpha * pHatData[i];
+            }
+            rr = ss;
+            break;
+        }
+        if constexpr (preconditioned) {
+            preconditioner.apply(r, sHat);
+        }
+        detail::applyOperator(a, std::span<const T>(sHatData, n), std::span<T>(t));
+        auto [ts, tt] = detail::reducePair<T>(n, [&](size_t i) {
+            return std::pair(t[i] * r[i], t[i] * t[i]);
+        });
+        if (!(tt > T(0))) {
+            // t = 0 means A s = 0, so s = 0 for nonsingular A. Take the half step.
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += alpha * pHatData[i];
+            }
+            rr = ss;
+            break;
+        }
+        omega = ts / tt;
+        // x += alpha p + omega s and r = s - omega t, with the next r . r and shadow . r in the same pass.
+        T rhoNext;
+        std::tie(rr, rhoNext) = detail::reducePair<T>(n, [&](size_t i) {
+            x[i] += alpha * pHatData[i] + omega * sHatData[i];
+            r[i] -= omega * t[i];
+            return std::pair(r[i] * r[i], shadow[i] * r[i]);
+        });
+        if (omega == T(0)) {
+            break;
+        }
+        rhoPrevious = rho;
+        rho = rhoNext;
+    }
+    result.residual = std::sqrt(rr) / bNorm;
+    result.converged = std::sqrt(rr) <= target;
+    return result;
+}
+
+
+/**
+ * Right preconditioned GMRES(m) for general nonsingular A. Builds an orthonormal Krylov basis of up to restart vectors
+ * by modified Gram-Schmidt, then restarts from the minimal residual solution in that basis. Each Gram-Schmidt step
+ * subtracts one basis vector and takes the dot product with the next in the same pass.
+ * @param a The operator: a SparseMatrix, a square Matrix, or f(x, y) setting y = A x.
+ * @param b The right hand side.
+ * @param x The initial guess, replaced by the solution.
+ * @param options The stopping criteria. Each basis vector counts as one iteration.
+ * @param preconditioner Applies an approximation of A^-1.
+ * @param restart The basis size m. Memory is (m + 1) n values.
+ * @return The iterations run and the final relative residual.
+ */
+template<typename T, typename A, typename P = IdentityPreconditioner<T>>
+SolverResult<T> gmres(const A &a, std::type_identity_t<std::span<const T>> b, std::span<T> x,
+                      const SolverOptions<T> &options = {}, const P &preconditioner = P(), size_t restart = 30)
+{
+    constexpr bool preconditioned = !std::is_same_v<P, IdentityPreconditioner<T>>;
+    size_t n = b.size();
+    size_t m = std::max<size_t>(restart, 1);
+    assert(x.size() == n && "Span size mismatch.");
+    SolverResult<T> result;
+    T bNorm = std::sqrt(detail::dot(b.data(), b.data(), n));
+    if (bNorm == T(0)) {
+        std::fill(x.begin(), x.end(), T(0));
+        result.converged = true;
+        return result;
+    }
+    T target = options.tolerance * bNorm;
+
+    // Basis vector j is basis[j * n, (j + 1) * n).
+    std::vector<T> basis((m + 1) * n);
+    std::vector<T> w(n);
+    std::vector<T> z(preconditioned ? n : 0);
+    // The Hessenberg matrix column by column, reduced to upper triangular by Givens rotations as it is built.
+    std::vector<T> h((m + 1) * m);
+    std::vector<T> cosines(m);
+    std::vector<T> sines(m);
+    std::vector<T> g(m + 1);
+    auto vector = [&](size_t j) { return basis.data() + j * n; };
+
+    T residualNorm = T(0);
+    while (true) {
+        T *v0 = vector(0);
+        detail::applyOperator(a, std::span<const T>(x), std::span<T>(v0, n));
+        residualNorm = std::sqrt(detail::residual(b.data(), v0, n));
+        if (residualNorm <= target || result.iterations >= options.maxIterations) {
+            break;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            v0[i] /= residualNorm;
+        }
+        std::fill(g.begin(), g.end(), T(0));
+        g[0] = residualNorm;
+
+        size_t j = 0;
+        while (j < m && result.iterations < options.maxIterations && residualNorm > target) {
+            T *column = h.data() + j * (m + 1);
+            if constexpr (preconditioned) {
+                preconditioner.apply(std::span<const T>(vector(j), n), z);
+                detail::applyOperator(a, std::span<const T>(z), std::span<T>(w));
+            } else {
+                detail::applyOperator(a, std::span<const T>(vector(j), n), std::span<T>(w));
+            }
+            column[0] = detail::dot(w.data(), vector(0), n);
+            for (size_t i = 0; i <= j; ++i) {
+                // After the last basis vector the pass computes |w|^2 instead.
+                const T *next = i < j ? vector(i + 1) : w.data();
+                T product = detail::axpyDot(-column[i], vector(i), w.data(), next, n);
+                column[i + 1] = i < j ? product : std::sqrt(product);
+            }
+            T norm = column[j + 1];
+            if (norm > T(0)) {
+                T *vNext = vector(j + 1);
+                for (size_t i = 0; i < n; ++i) {
+                    vNext[i] = w[i] / norm;
+                }
+            }
+
+            for (size_t i = 0; i < j; ++i) {
+                T upper = cosines[i] * column[i] + sines[i] * column[i + 1];
+                column[i + 1] = -sines[i] * column[i] + cosines[i] * column[i + 1];
+                column[i] = upper;
+            }
+            T radius = std::hypot(column[j], norm);
+            cosines[j] = radius > T(0) ? column[j] / radius : T(1);
+            sines[j] = radius > T(0) ? norm / radius : T(0);
+            column[j] = radius;
+            column[j + 1] = T(0);
+            g[j + 1] = -sines[j] * g[j];
+            g[j] *= cosines[j];
+            residualNorm = std::abs(g[j + 1]);
+            ++j;
+            ++result.iterations;
+            if (norm == T(0)) {
+                // Lucky breakdown: the solution lies in the current basis.
+                break;
+            }
+        }
+
+        // Solve the triangular system for the basis coefficients, then x += M^-1 (V y).
+        for (size_t i = j; i-- > 0;) {
+            T sum = g[i];
+            for (size_t k = i + 1; k < j; ++k) {
+                sum -= h[k * (m + 1) + i] * g[k];
+            }
+            g[i] = sum / h[i * (m + 1) + i];
+        }
+        std::fill(w.begin(), w.end(), T(0));
+        for (size_t k = 0; k < j; ++k) {
+            const T *vk = vector(k);
+            for (size_t i = 0; i < n; ++i) {
+                w[i] += g[k] * vk[i];
+            }
+        }
+        if constexpr (preconditioned) {
+            preconditioner.apply(w, z);
+        }
+        const T *update = preconditioned ? z.data() : w.data();
+        for (size_t i = 0; i < n; ++i) {
+            x[i] += update[i];
+        }
+    }
+    result.residual = residualNorm / bNorm;
+    result.converged = residualNorm <= target;
+    return result;
+}
+
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cassert>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Half.h"
+#include "Matrix.h"
+#include "Quantized.h"
+
+namespace MathUtils
+{
+
+// Epilogues
+/**
+ * gemmInt8 epilogue that turns the int32 sums of symmetrically quantized factors back into floats. Element (i, j) is
+ * scaled by rowScales[i] * colScales[j], the quantization steps of row i of A and of column j of the product, and
+ * bias[j] is added. Empty spans stand for scales of 1 and no bias.
+ */
+struct DequantizeEpilogue
+{
+    std::span<const float> rowScales;
+    std::span<const float> colScales;
+    std::span<const float> bias;
+
+    float operator()(int32_t sum, size_t row, size_t col) const
+    {
+        float value = static_cast<float>(sum);
+        value *= rowScales.empty() ? 1.0f : rowScales[row];
+        value *= colScales.empty() ? 1.0f : colScales[col];
+        return bias.empty() ? value : value + bias[col];
+    }
+};
+
+/**
+ * gemmInt8 epilogue that requantizes the dequantized result, see DequantizeEpilogue, to int8 with the given output
+ * scale and zero point, clamped to [-QuantizedMax, QuantizedMax].
+ */
+struct RequantizeEpilogue
+{
+    DequantizeEpilogue dequantize;
+    float scale = 1.0f;
+    int32_t zeroPoint = 0;
+
+    int8_t operator()(int32_t sum, size_t row, size_t col) const
+    {
+        return detail::quantizeValue(dequantize(sum, row, col), 1.0f / scale, static_cast<float>(zeroPoint));
+    }
+};
+
+namespace detail
+{
+// Columns of C that gemmInt8 computes per pass over a row of A.
+inline constexpr size_t int8TileColumns = 4;
+
+template<typename H, typename U, typename Epilogue>
+void widenedGemm(size_t n, size_t k, size_t m, float alpha, std::span<const H> a, std::span<const H> b, float beta,
+                 std::span<U> c, Epilogue &epilogue)
+{
+    assert(a.size() == n * k && b.size() == k * m && c.size() == n * m && "Span size mismatch.");
+    // Widening once costs O(n k + k m), against O(n k m) for the product.
+    std::vector<float> wideA(a.size());
+    std::vector<float> wideB(b.size());
+    convertToFloat(a, wideA);
+    convertToFloat(b, wideB);
+    auto element = [&c, m](size_t i, size_t j) -> U & { return c[i * m + j]; };
+    gemmTiles<gemmTileRows, gemmTileCols<float>, float>(
+            n, k, m, [&wideA, k](size_t i) { return wideA.data() + i * k; },
+            [&wideB, m](size_t row) { return wideB.data() + row * m; },
+            gemmStore(alpha, beta, nullptr, element, epilogue));
+}
+}
+
+/**
+ * Quantized matrix multiply, C = epilogue(A * B^T), with exact int32 accumulation. Each row of A is multiplied with
+ * several rows of B^T per pass using the VNNI or AVX2 kernels of dotInt8, which are exact for the full int8 range. B
+ * is taken transposed, one row per output column, which is how the weights of a dense layer are usually stored. Rows
+ * are split across threads above MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+ * @param a The n x k row-major left factor.
+ * @param bTransposed The m x k row-major transpose of the right factor.
+ * @param c The n x m row-major result.
+ * @param epilogue Called as epilogue(sum) or epilogue(sum, row, col) on every int32 sum before it is stored, e.g. a
+ * DequantizeEpilogue or RequantizeEpilogue. It is called concurrently when rows are split across threads, like the
+ * epilogue of the Matrix gemm.
+ */
+template<typename U, typename Epilogue = IdentityEpilogue>
+void gemmInt8(size_t n, size_t k, size_t m, std::type_identity_t<std::span<const int8_t>> a,
+              std::type_identity_t<std::span<const int8_t>> bTransposed, std::span<U> c, Epilogue epilogue = {})
+{
+    assert(a.size() == n * k && bTransposed.size() == m * k && c.size() == n * m && "Span size mismatch.");
+    constexpr size_t Columns = detail::int8TileColumns;
+    detail::parallelRanges(0, n, n * k * m, [&](size_t first, size_t last) {
+        std::array<int32_t, Columns> sums;
+        std::array<const int8_t *, Columns> columns;
+        for (size_t i = first; i < last; ++i) {
+            const int8_t *row = a.data() + i * k;
+            size_t j = 0;
+            for (; j + Columns <= m; j += Columns) {
+                for (size_t col = 0; col < Columns; ++col) {
+                    columns[col] = bTransposed.data() + (j + col) * k;
+                }
+                detail::dotInt8Tile<Columns>(row, columns, k, sums.data());
+                for (size_t col = 0; col < Columns; ++col) {
+                    c[i * m + j + col] = static_cast<U>(detail::applyEpilogue(epilogue, sums[col], i, j + col));
+                }
+            }
+            for (; j < m; ++j) {
+                int32_t sum = detail::dotInt8(row, bTransposed.data() + j * k, k);
+                c[i * m + j] = static_cast<U>(detail::applyEpilogue(epilogue, sum, i, j));
+            }
+        }
+    });
+}
+
+/**
+ * Half precision matrix multiply, C = epilogue(alpha * A * B + beta * C), accumulated in float. The factors are
+ * widened with F16C when available and multiplied by the register tiles of the Matrix gemm.
+ * @param a The n x k row-major left factor.
+ * @param b The k x m row-major right factor.
+ * @param c The n x m row-major result, e.g. float or float16_t. It is not read when beta is 0.
+ * @param epilogue Called as epilogue(value) or epilogue(value, row, col) on every element before it is stored, from
+ * several threads at once for large products, see the Matrix gemm.
+ */
+template<typename U, typename Epilogue = IdentityEpilogue>
+void gemm(size_t n, size_t k, size_t m, float alpha, std::span<const float16_t> a, std::span<const float16_t> b,
+          float beta, std::span<U> c, Epilogue epilogue = {})
+{
+    detail::widenedGemm(n, k, m, alpha, a, b, beta, c, epilogue);
+}
+
+/**
+ * bfloat16 matrix multiply, C = epilogue(alpha * A * B + beta * C), accumulated in float. See the float16_t overload.
+ */
+template<typename U, typename Epilogue = IdentityEpilogue>
+void gemm(size_t n, size_t k, size_t m, float alpha, std::span<const bfloat16_t> a, std::span<const bfloat16_t> b,
+          float beta, std::span<U> c, Epilogue epilogue = {})
+{
+    detail::widenedGemm(n, k, m, alpha, a, b, beta, c, epilogue);
+}
+
+}
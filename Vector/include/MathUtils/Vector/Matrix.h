@@ -6,10 +6,476 @@
 
 #include <cassert>
 #include <array>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "Vector.h"
 
+// Column count of the panels the LU decomposition factors before updating the rest of the matrix.
+#ifndef MATHUTILS_MATRIX_BLOCK_SIZE
+    #define MATHUTILS_MATRIX_BLOCK_SIZE 64
+#endif
+
+// Number of multiply-adds above which a blocked update is split across threads. Define it as 0 to never spawn threads.
+#ifndef MATHUTILS_MATRIX_PARALLEL_THRESHOLD
+    #define MATHUTILS_MATRIX_PARALLEL_THRESHOLD (1 << 22)
+#endif
+
+// Bytes of factors LU, Cholesky and LDLT store inside themselves before they allocate.
+#ifndef MATHUTILS_MATRIX_INLINE_BYTES
+    #define MATHUTILS_MATRIX_INLINE_BYTES (1 << 16)
+#endif
+
 namespace MathUtils
 {
+template<typename T, size_t N, size_t M>
+class Matrix;
+
+template<typename T, size_t N>
+class LU;
+
+template<typename T, size_t N>
+class Cholesky;
+
+template<typename T, size_t N>
+class LDLT;
+
+template<typename T, size_t N, size_t M>
+class QR;
+
+namespace detail
+{
+/**
+ * The factors of a decomposition. Matrices of up to MATHUTILS_MATRIX_INLINE_BYTES are stored inline, larger ones on the
+ * heap, so that decompositions of large matrices can be returned by value without overflowing the stack. Elements are
+ * accessed like a Matrix, and the whole matrix with operator*.
+ * @tparam M The matrix type.
+ */
+template<typename M, bool Heap = (sizeof(M) > MATHUTILS_MATRIX_INLINE_BYTES)>
+class FactorStorage
+{
+private:
+    M matrix;
+
+public:
+    constexpr explicit FactorStorage(const M &matrix) : matrix(matrix)
+    {}
+
+    constexpr M &operator*()
+    { return matrix; }
+
+    constexpr const M &operator*() const
+    { return matrix; }
+
+    constexpr decltype(auto) operator()(size_t row, size_t col)
+    { return matrix(row, col); }
+
+    constexpr decltype(auto) operator()(size_t row, size_t col) const
+    { return matrix(row, col); }
+
+    constexpr decltype(auto) operator[](size_t row)
+    { return matrix[row]; }
+
+    constexpr decltype(auto) operator[](size_t row) const
+    { return matrix[row]; }
+};
+
+template<typename M>
+class FactorStorage<M, true>
+{
+private:
+    std::unique_ptr<M> matrix;
+
+public:
+    explicit FactorStorage(const M &matrix) : matrix(std::make_unique<M>(matrix))
+    {}
+
+    FactorStorage(const FactorStorage &other) : matrix(std::make_unique<M>(*other.matrix))
+    {}
+
+    FactorStorage(FactorStorage &&other) noexcept = default;
+
+    FactorStorage &operator=(const FactorStorage &other)
+    {
+        if (this != &other) {
+            matrix = std::make_unique<M>(*other.matrix);
+        }
+        return *this;
+    }
+
+    FactorStorage &operator=(FactorStorage &&other) noexcept = default;
+
+    M &operator*()
+    { return *matrix; }
+
+    const M &operator*() const
+    { return *matrix; }
+
+    decltype(auto) operator()(size_t row, size_t col)
+    { return (*matrix)(row, col); }
+
+    decltype(auto) operator()(size_t row, size_t col) const
+    { return (*matrix)(row, col); }
+
+    decltype(auto) operator[](size_t row)
+    { return (*matrix)[row]; }
+
+    decltype(auto) operator[](size_t row) const
+    { return (*matrix)[row]; }
+};
+
+// The number of threads a job costing work multiply-adds is split across, 1 below MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+inline size_t parallelThreads(size_t work)
+{
+    if (MATHUTILS_MATRIX_PARALLEL_THRESHOLD == 0 || work < MATHUTILS_MATRIX_PARALLEL_THRESHOLD) {
+        return 1;
+    }
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+/**
+ * Calls f(begin, end) on disjoint subranges covering [begin, end), one per hardware thread when work is at least
+ * MATHUTILS_MATRIX_PARALLEL_THRESHOLD, otherwise once on the calling thread.
+ * @param work The number of multiply-adds the whole range costs.
+ */
+template<typename F>
+void parallelRanges(size_t begin, size_t end, size_t work, F &&f)
+{
+    size_t threads = parallelThreads(work);
+    if (threads < 2 || end - begin < 2) {
+        f(begin, end);
+        return;
+    }
+    threads = std::min(threads, end - begin);
+    size_t step = (end - begin + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t first = begin + step; first < end; first += step) {
+        workers.emplace_back([&f, first, last = std::min(first + step, end)]() { f(first, last); });
+    }
+    f(begin, std::min(begin + step, end));
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+}
+
+/**
+ * c[i] -= a[i][k] * b[k] for the rows i in [rowBegin, rowEnd), the columns j in [colBegin, colEnd) and k in
+ * [kBegin, kEnd), where a, b and c are rows of the same matrix. The columns are tiled so that the rows of b being read
+ * stay in cache while every row of c streams past them.
+ */
+template<typename T, size_t N>
+constexpr void subtractProduct(Matrix<T, N, N> &m, size_t rowBegin, size_t rowEnd, size_t kBegin, size_t kEnd,
+                               size_t colBegin, size_t colEnd)
+{
+    constexpr size_t tile = 256;
+    for (size_t tileBegin = colBegin; tileBegin < colEnd; tileBegin += tile) {
+        size_t tileEnd = std::min(tileBegin + tile, colEnd);
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            T *c = m[i].data.data();
+            for (size_t k = kBegin; k < kEnd; ++k) {
+                T factor = c[k];
+                if (factor == T(0)) {
+                    continue;
+                }
+                const T *b = m[k].data.data();
+                for (size_t j = tileBegin; j < tileEnd; ++j) {
+                    c[j] -= factor * b[j];
+                }
+            }
+        }
+    }
+}
+
+// Calls f(std::integral_constant<size_t, I>()) for I in [0, N), so f can use I at compile time.
+template<size_t N, typename F>
+constexpr void unrolledFor(F &&f)
+{
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>()), ...);
+    }(std::make_index_sequence<N>());
+}
+
+// Symmetric factorizations up to this size are fully unrolled at compile time.
+inline constexpr size_t unrolledFactorLimit = 8;
+
+/**
+ * Factors column j of a symmetric matrix whose columns before j, and their contributions to the rest of column j from
+ * columns [0, begin), are done. With Ldlt, D is written to the diagonal and L has a unit diagonal, otherwise L gets
+ * square roots on its diagonal. Row sums only run over [begin, j), which is what the blocked factorization needs.
+ * @return False if the pivot is not positive (Cholesky) or zero (LDLT).
+ */
+template<bool Ldlt, typename T, size_t N>
+constexpr bool factorSymmetricColumn(Matrix<T, N, N> &a, size_t begin, size_t j, size_t rowEnd)
+{
+    T *rowJ = a[j].data.data();
+    T d = rowJ[j];
+    for (size_t k = begin; k < j; ++k) {
+        d -= Ldlt ? rowJ[k] * rowJ[k] * a(k, k) : rowJ[k] * rowJ[k];
+    }
+    if (Ldlt ? d == T(0) : !(d > T(0))) {
+        return false;
+    }
+    T pivot = Ldlt ? d : std::sqrt(d);
+    rowJ[j] = pivot;
+    T inv = T(1) / pivot;
+    for (size_t i = j + 1; i < rowEnd; ++i) {
+        T *rowI = a[i].data.data();
+        T sum = rowI[j];
+        for (size_t k = begin; k < j; ++k) {
+            sum -= Ldlt ? rowI[k] * rowJ[k] * a(k, k) : rowI[k] * rowJ[k];
+        }
+        rowI[j] = sum * inv;
+    }
+    return true;
+}
+
+// factorSymmetricColumn over a whole small matrix with every loop unrolled.
+template<bool Ldlt, typename T, size_t N>
+constexpr bool factorSymmetricUnrolled(Matrix<T, N, N> &a)
+{
+    bool success = true;
+    unrolledFor<N>([&](auto j) {
+        T d = a(j, j);
+        unrolledFor<j>([&](auto k) {
+            d -= Ldlt ? a(j, k) * a(j, k) * a(k, k) : a(j, k) * a(j, k);
+        });
+        success = success && (Ldlt ? d != T(0) : d > T(0));
+        T pivot = Ldlt ? d : std::sqrt(d);
+        a(j, j) = pivot;
+        T inv = T(1) / pivot;
+        unrolledFor<N - j - 1>([&](auto offset) {
+            constexpr size_t i = j + 1 + offset;
+            T sum = a(i, j);
+            unrolledFor<j>([&](auto k) {
+                sum -= Ldlt ? a(i, k) * a(j, k) * a(k, k) : a(i, k) * a(j, k);
+            });
+            a(i, j) = sum * inv;
+        });
+    });
+    return success;
+}
+
+/**
+ * Right-looking blocked factorization of the lower triangle. After each panel of columns, the trailing lower triangle
+ * is updated with A22 -= L21 W^T, where W is L21 scaled by D for LDLT. W^T is copied out first so that the update runs
+ * over contiguous rows.
+ */
+template<bool Ldlt, typename T, size_t N>
+constexpr bool factorSymmetricBlocked(Matrix<T, N, N> &a)
+{
+    constexpr size_t block = MATHUTILS_MATRIX_BLOCK_SIZE;
+    std::vector<T> panelTransposed;
+    for (size_t panel = 0; panel < N; panel += block) {
+        size_t panelEnd = std::min(panel + block, N);
+        for (size_t j = panel; j < panelEnd; ++j) {
+            if (!factorSymmetricColumn<Ldlt>(a, panel, j, N)) {
+                return false;
+            }
+        }
+        if (panelEnd == N) {
+            break;
+        }
+        size_t width = panelEnd - panel;
+        panelTransposed.assign(width * N, T(0));
+        for (size_t k = 0; k < width; ++k) {
+            T scale = Ldlt ? a(panel + k, panel + k) : T(1);
+            for (size_t j = panelEnd; j < N; ++j) {
+                panelTransposed[k * N + j] = a(j, panel + k) * scale;
+            }
+        }
+        auto update = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                T *c = a[i].data.data();
+                for (size_t k = 0; k < width; ++k) {
+                    T factor = c[panel + k];
+                    const T *w = panelTransposed.data() + k * N;
+                    for (size_t j = panelEnd; j <= i; ++j) {
+                        c[j] -= factor * w[j];
+                    }
+                }
+            }
+        };
+        if consteval {
+            update(panelEnd, N);
+        } else {
+            detail::parallelRanges(panelEnd, N, (N - panelEnd) * (N - panelEnd) * width / 2, update);
+        }
+    }
+    return true;
+}
+
+// Factors the lower triangle of a in place and clears the strict upper triangle.
+template<bool Ldlt, typename T, size_t N>
+constexpr bool factorSymmetric(Matrix<T, N, N> &a)
+{
+    bool success;
+    if constexpr (N <= unrolledFactorLimit) {
+        success = factorSymmetricUnrolled<Ldlt>(a);
+    } else {
+        success = factorSymmetricBlocked<Ldlt>(a);
+    }
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            a(i, j) = T(0);
+        }
+    }
+    return success;
+}
+
+/**
+ * The adjugate and determinant of a matrix of up to 4x4, written once for a lane type L: T for a single matrix, or
+ * Vector<T, Lanes> for interleaved matrices with one per lane. The inverse is the adjugate divided by the determinant.
+ * @param m Reads element (i, j) as m(i, j).
+ * @param adj Writes element (i, j) of the adjugate through adj(i, j).
+ * @return The determinant.
+ */
+template<size_t N, typename L, typename In, typename Out>
+constexpr L adjugate(const In &m, Out &&adj)
+{
+    static_assert(N <= 4, "The adjugate kernel only handles sizes up to 4.");
+    if constexpr (N == 1) {
+        adj(0, 0) = L(1);
+        return m(0, 0);
+    } else if constexpr (N == 2) {
+        adj(0, 0) = m(1, 1);
+        adj(0, 1) = -m(0, 1);
+        adj(1, 0) = -m(1, 0);
+        adj(1, 1) = m(0, 0);
+        return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+    } else if constexpr (N == 3) {
+        L c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+        L c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+        L c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+        adj(0, 0) = c00;
+        adj(0, 1) = m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2);
+        adj(0, 2) = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+        adj(1, 0) = c01;
+        adj(1, 1) = m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0);
+        adj(1, 2) = m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2);
+        adj(2, 0) = c02;
+        adj(2, 1) = m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1);
+        adj(2, 2) = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+        return m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+    } else {
+        // 2x2 minors of the top two rows (s) and the bottom two rows (c).
+        L s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        L s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        L s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        L s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        L s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        L s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        L c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+        L c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        L c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        L c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        L c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        L c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        adj(0, 0) = m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3;
+        adj(0, 1) = -m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3;
+        adj(0, 2) = m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3;
+        adj(0, 3) = -m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3;
+        adj(1, 0) = -m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1;
+        adj(1, 1) = m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1;
+        adj(1, 2) = -m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1;
+        adj(1, 3) = m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1;
+        adj(2, 0) = m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0;
+        adj(2, 1) = -m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0;
+        adj(2, 2) = m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0;
+        adj(2, 3) = -m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0;
+        adj(3, 0) = -m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0;
+        adj(3, 1) = m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0;
+        adj(3, 2) = -m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0;
+        adj(3, 3) = m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0;
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+/**
+ * Inverts a row major 4x4 float matrix by splitting it into 2x2 blocks, keeping each block in one register.
+ * @return False, leaving out untouched, if the matrix is singular.
+ */
+inline bool inverse4x4Sse(const float *in, float *out)
+{
+    const __m128 r0 = _mm_loadu_ps(in);
+    const __m128 r1 = _mm_loadu_ps(in + 4);
+    const __m128 r2 = _mm_loadu_ps(in + 8);
+    const __m128 r3 = _mm_loadu_ps(in + 12);
+
+    // 2x2 products on blocks stored row major as (m00, m01, m10, m11): a * b, adj(a) * b and a * adj(b).
+    auto mul = [](__m128 a, __m128 b) {
+        return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    };
+    auto adjMul = [](__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    };
+    auto mulAdj = [](__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    };
+
+    // M = | A B |
+    //     | C D |
+    __m128 a = _mm_movelh_ps(r0, r1);
+    __m128 b = _mm_movehl_ps(r1, r0);
+    __m128 c = _mm_movelh_ps(r2, r3);
+    __m128 d = _mm_movehl_ps(r3, r2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+    __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128 dc = adjMul(d, c);
+    __m128 ab = adjMul(a, b);
+    // The adjugates of the blocks of the inverse, before the division by |M|.
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mulAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mulAdj(a, dc));
+
+    // |M| = |A| |D| + |B| |C| - tr(adj(A) B adj(D) C)
+    __m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+    trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+    trace = _mm_add_ss(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128 detM = _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace);
+    if (_mm_cvtss_f32(detM) == 0.0f) {
+        return false;
+    }
+    detM = _mm_shuffle_ps(detM, detM, _MM_SHUFFLE(0, 0, 0, 0));
+
+    __m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+    w = _mm_mul_ps(w, scale);
+
+    // Taking the adjugate of each block and interleaving the blocks into rows are one shuffle.
+    _mm_storeu_ps(out, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+    return true;
+}
+#endif
+}
+
 template<typename T, size_t N, size_t M = N>
 class Matrix
 {
@@ -21,12 +487,8 @@ private:
 public:
 
     // Default constructor initializes all elements to zero.
-    consteval Matrix()
-    {
-        for (size_t i = 0; i < N; ++i) {
-            data[i] = Vector<T, M>();
-        }
-    }
+    consteval Matrix() : data{}
+    {}
 
     using Array = std::array<std::array<T, M>, N>;
 
@@ -76,6 +538,15 @@ public:
         return data[row];
     }
 
+    static constexpr Matrix identity() requires (N == M)
+    {
+        Matrix result;
+        for (size_t i = 0; i < N; ++i) {
+            result(i, i) = T(1);
+        }
+        return result;
+    }
+
     // Get number of rows
     [[nodiscard]] consteval size_t rows() const
     { return N; }
@@ -101,6 +572,7 @@ public:
         for (size_t i = 0; i < N; ++i) {
             result[i] = (*this)[i] - other[i];
         }
+        return result;
     }
 
     // Matrix element multiplication
@@ -110,36 +582,144 @@ public:
         for (size_t i = 0; i < N; ++i) {
             result[i] = (*this)[i] * other[i];
         }
+        return result;
     }
 
+    // The type matrix products over T are accumulated in and returned as, e.g. int32_t for int8_t matrices.
+    using AccumulatorType = typename ElementTraits<T>::Accumulator;
+
     // Matrix multiplication
     template<size_t P>
-    constexpr Matrix<T, N, P> matMult(const Matrix<T, M, P> &other) const
+    constexpr Matrix<AccumulatorType, N, P> matMult(const Matrix<T, M, P> &other) const
     {
-        Matrix<T, N, P> result;
+        using Acc = AccumulatorType;
+        Matrix<Acc, N, P> result;
         for (size_t i = 0; i < N; ++i) {
             for (size_t j = 0; j < P; ++j) {
-                result(i, j) = T();
+                Acc sum = Acc();
                 for (size_t k = 0; k < M; ++k) {
-                    result(i, j) += (*this)[i][k] * other[k][j];
+                    sum += static_cast<Acc>((*this)[i][k]) * static_cast<Acc>(other[k][j]);
                 }
+                result(i, j) = sum;
             }
         }
         return result;
     }
 
-    constexpr Matrix<T, N, 1> matMult(const MathUtils::Vector<T, M> &other) const
+    constexpr Matrix<AccumulatorType, N, 1> matMult(const MathUtils::Vector<T, M> &other) const
+    {
+        Matrix<AccumulatorType, N, 1> result;
+        for (size_t i = 0; i < N; ++i) {
+            result(i, 0) = (*this)[i].dot(other);
+        }
+        return result;
+    }
+
+    constexpr Matrix<T, M, N> transpose() const
     {
-        Matrix<T, N, 1> result;
+        Matrix<T, M, N> result;
         for (size_t i = 0; i < N; ++i) {
-            result(i, 0) = T();
             for (size_t j = 0; j < M; ++j) {
-                result(i, 0) += (*this)[i][j] * other[j];
+                result(j, i) = (*this)(i, j);
             }
         }
         return result;
     }
 
+    /**
+     * Determinant function. Sizes up to 4 use the cofactor expansion, larger ones the LU decomposition.
+     * @return The determinant.
+     */
+    constexpr T determinant() const requires (N == M)
+    {
+        static_assert(N <= 4 || std::is_floating_point_v<T>,
+                      "Determinants of matrices larger than 4x4 need a floating point type.");
+        const Matrix &m = *this;
+        if constexpr (N == 1) {
+            return m(0, 0);
+        } else if constexpr (N == 2) {
+            return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+        } else if constexpr (N == 3) {
+            return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+                   + m(0, 1) * (m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2))
+                   + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+        } else if constexpr (N == 4) {
+            // 2x2 minors of the top two rows (s) and the bottom two rows (c).
+            T s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+            T s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+            T s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+            T s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+            T s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+            T s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+            T c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+            T c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+            T c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+            T c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+            T c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+            T c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        } else {
+            return lu().determinant();
+        }
+    }
+
+    /**
+     * Inverse function. Sizes up to 4 use the adjugate divided by the determinant, with an SSE path for 4x4 floats, and
+     * larger sizes the LU decomposition.
+     * @return The inverse, or nothing if the matrix is singular.
+     */
+    constexpr std::optional<Matrix> inverse() const requires (N == M)
+    {
+        static_assert(std::is_floating_point_v<T>, "Only matrices of a floating point type can be inverted.");
+        if constexpr (N <= 4) {
+            Matrix result;
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+            if constexpr (N == 4 && std::is_same_v<T, float>) {
+                static_assert(sizeof(Matrix) == 16 * sizeof(float), "4x4 float matrices are processed as packed floats.");
+                if !consteval {
+                    if (!detail::inverse4x4Sse(data[0].data.data(), result.data[0].data.data())) {
+                        return std::nullopt;
+                    }
+                    return result;
+                }
+            }
+#endif
+            T det = detail::adjugate<N, T>(*this, result);
+            if (det == T(0)) {
+                return std::nullopt;
+            }
+            result *= T(1) / det;
+            return result;
+        } else {
+            // LU keeps large factors on the heap, and its inverse is built in place in the returned value.
+            return lu().inverse();
+        }
+    }
+
+    // Factors the matrix as P A = L U. See LU.
+    constexpr LU<T, N> lu() const requires (N == M)
+    {
+        return LU<T, N>(*this);
+    }
+
+    // Factors a symmetric positive definite matrix as A = L L^T, reading only its lower triangle. See Cholesky.
+    constexpr Cholesky<T, N> cholesky() const requires (N == M)
+    {
+        return Cholesky<T, N>(*this);
+    }
+
+    // Factors a symmetric matrix as A = L D L^T, reading only its lower triangle. See LDLT.
+    constexpr LDLT<T, N> ldlt() const requires (N == M)
+    {
+        return LDLT<T, N>(*this);
+    }
+
+    // Factors a matrix with at least as many rows as columns as A = Q R. See QR.
+    constexpr QR<T, N, M> qr() const requires (N >= M)
+    {
+        return QR<T, N, M>(*this);
+    }
+
     // Scalar addition
     constexpr Matrix<T, N, M> operator+(const T &scalar) const
     {
@@ -248,6 +828,1368 @@ public:
     }
 };
 
+// Triangular solves
+namespace detail
+{
+// The triangular solves below, overwriting b with x. The decompositions use these to avoid copying large right hand sides.
+template<bool UnitDiagonal, typename T, size_t N, typename B>
+constexpr void substituteLower(const Matrix<T, N, N> &l, B &b)
+{
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t k = 0; k < i; ++k) {
+            b[i] -= b[k] * l(i, k);
+        }
+        if constexpr (!UnitDiagonal) {
+            b[i] /= l(i, i);
+        }
+    }
+}
+
+template<bool UnitDiagonal, typename T, size_t N, typename B>
+constexpr void substituteUpper(const Matrix<T, N, N> &u, B &b)
+{
+    for (size_t i = N; i-- > 0;) {
+        for (size_t k = i + 1; k < N; ++k) {
+            b[i] -= b[k] * u(i, k);
+        }
+        if constexpr (!UnitDiagonal) {
+            b[i] /= u(i, i);
+        }
+    }
+}
+
+template<bool UnitDiagonal, typename T, size_t N, typename B>
+constexpr void substituteLowerTransposed(const Matrix<T, N, N> &l, B &b)
+{
+    for (size_t i = N; i-- > 0;) {
+        if constexpr (!UnitDiagonal) {
+            b[i] /= l(i, i);
+        }
+        for (size_t k = 0; k < i; ++k) {
+            b[k] -= b[i] * l(i, k);
+        }
+    }
+}
+}
+
+// The right hand side b of these is a Vector<T, N>, or a Matrix<T, N, P> to solve for all P columns at once. Only the
+// triangle named is read, so packed factorizations can be passed directly.
+/**
+ * Forward substitution.
+ * @tparam UnitDiagonal Whether to take the diagonal of l as ones instead of reading it.
+ * @param l A lower triangular matrix.
+ * @param b The right hand side.
+ * @return x such that l x = b.
+ */
+template<bool UnitDiagonal = false, typename T, size_t N, typename B>
+constexpr B solveLower(const Matrix<T, N, N> &l, B b)
+{
+    detail::substituteLower<UnitDiagonal>(l, b);
+    return b;
+}
+
+/**
+ * Back substitution.
+ * @tparam UnitDiagonal Whether to take the diagonal of u as ones instead of reading it.
+ * @param u An upper triangular matrix.
+ * @param b The right hand side.
+ * @return x such that u x = b.
+ */
+template<bool UnitDiagonal = false, typename T, size_t N, typename B>
+constexpr B solveUpper(const Matrix<T, N, N> &u, B b)
+{
+    detail::substituteUpper<UnitDiagonal>(u, b);
+    return b;
+}
+
+/**
+ * Back substitution with the transpose of a lower triangular matrix, without forming the transpose.
+ * @tparam UnitDiagonal Whether to take the diagonal of l as ones instead of reading it.
+ * @param l A lower triangular matrix.
+ * @param b The right hand side.
+ * @return x such that l^T x = b.
+ */
+template<bool UnitDiagonal = false, typename T, size_t N, typename B>
+constexpr B solveLowerTransposed(const Matrix<T, N, N> &l, B b)
+{
+    detail::substituteLowerTransposed<UnitDiagonal>(l, b);
+    return b;
+}
+
+/**
+ * An LU decomposition with partial pivoting, P A = L U. L is unit lower triangular and U upper triangular, and both are
+ * packed into a single matrix. Columns are factored in panels of MATHUTILS_MATRIX_BLOCK_SIZE, each followed by a tiled
+ * update of the trailing matrix that is split across threads when it is large. Factors larger than
+ * MATHUTILS_MATRIX_INLINE_BYTES are kept on the heap.
+ * @tparam T The floating point element type.
+ * @tparam N The number of rows and columns.
+ */
+template<typename T, size_t N>
+class LU
+{
+    static_assert(std::is_floating_point_v<T>, "LU's template parameter T must be a floating point type.");
+
+private:
+    detail::FactorStorage<Matrix<T, N, N>> factors;
+    // Row i of P A is row permutation[i] of A.
+    std::array<size_t, N> permutation;
+    bool oddPermutation = false;
+    bool isSingular = false;
+
+public:
+    constexpr explicit LU(const Matrix<T, N, N> &matrix) : factors(matrix), permutation()
+    {
+        for (size_t i = 0; i < N; ++i) {
+            permutation[i] = i;
+        }
+        constexpr size_t block = MATHUTILS_MATRIX_BLOCK_SIZE;
+        for (size_t panel = 0; panel < N; panel += block) {
+            size_t panelEnd = std::min(panel + block, N);
+            factorPanel(panel, panelEnd);
+            if (panelEnd == N) {
+                break;
+            }
+            // U12 = L11^-1 A12, in row order since each row depends on the ones above it.
+            for (size_t i = panel + 1; i < panelEnd; ++i) {
+                detail::subtractProduct(*factors, i, i + 1, panel, i, panelEnd, N);
+            }
+            // A22 -= L21 U12
+            auto update = [&](size_t begin, size_t end) {
+                detail::subtractProduct(*factors, begin, end, panel, panelEnd, panelEnd, N);
+            };
+            if consteval {
+                update(panelEnd, N);
+            } else {
+                detail::parallelRanges(panelEnd, N, (N - panelEnd) * (N - panelEnd) * (panelEnd - panel), update);
+            }
+        }
+    }
+
+    // accessor methods
+    // True if a pivot was zero. solve and inverse need a nonsingular matrix.
+    [[nodiscard]] constexpr bool singular() const
+    { return isSingular; }
+
+    // L below the diagonal, without its unit diagonal, and U on and above it.
+    constexpr const Matrix<T, N, N> &packed() const
+    { return *factors; }
+
+    // Row i of P A is row rowPermutation()[i] of A.
+    constexpr const std::array<size_t, N> &rowPermutation() const
+    { return permutation; }
+
+    constexpr T determinant() const
+    {
+        T det = oddPermutation ? T(-1) : T(1);
+        for (size_t i = 0; i < N; ++i) {
+            det *= factors(i, i);
+        }
+        return det;
+    }
+
+    /**
+     * Solves A x = b by forward and back substitution.
+     * @param b The right hand side.
+     * @return x.
+     */
+    constexpr Vector<T, N> solve(const Vector<T, N> &b) const
+    {
+        assert(!isSingular && "Cannot solve a singular system.");
+        Vector<T, N> x;
+        for (size_t i = 0; i < N; ++i) {
+            x[i] = b[permutation[i]];
+        }
+        detail::substituteLower<true>(*factors, x);
+        detail::substituteUpper<false>(*factors, x);
+        return x;
+    }
+
+    /**
+     * Solves A X = B for every column of B at once.
+     * @param b The right hand sides.
+     * @return X.
+     */
+    template<size_t P>
+    constexpr Matrix<T, N, P> solve(const Matrix<T, N, P> &b) const
+    {
+        assert(!isSingular && "Cannot solve a singular system.");
+        Matrix<T, N, P> x;
+        for (size_t i = 0; i < N; ++i) {
+            x[i] = b[permutation[i]];
+        }
+        detail::substituteLower<true>(*factors, x);
+        detail::substituteUpper<false>(*factors, x);
+        return x;
+    }
+
+    // The inverse of A, or nothing if A is singular.
+    constexpr std::optional<Matrix<T, N, N>> inverse() const
+    {
+        // Solved in place in the result, which is the only N x N temporary.
+        std::optional<Matrix<T, N, N>> result;
+        if (isSingular) {
+            return result;
+        }
+        Matrix<T, N, N> &x = result.emplace();
+        for (size_t i = 0; i < N; ++i) {
+            x(i, permutation[i]) = T(1);
+        }
+        detail::substituteLower<true>(*factors, x);
+        detail::substituteUpper<false>(*factors, x);
+        return result;
+    }
+
+private:
+    // Unblocked factorization of the columns [begin, end), swapping whole rows.
+    constexpr void factorPanel(size_t begin, size_t end)
+    {
+        for (size_t k = begin; k < end; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < N; ++i) {
+                if (std::abs(factors(i, k)) > std::abs(factors(pivot, k))) {
+                    pivot = i;
+                }
+            }
+            if (factors(pivot, k) == T(0)) {
+                // The column below the diagonal is already zero.
+                isSingular = true;
+                continue;
+            }
+            if (pivot != k) {
+                std::swap(factors[pivot], factors[k]);
+                std::swap(permutation[pivot], permutation[k]);
+                oddPermutation = !oddPermutation;
+            }
+            T inv = T(1) / factors(k, k);
+            for (size_t i = k + 1; i < N; ++i) {
+                factors(i, k) *= inv;
+            }
+            detail::subtractProduct(*factors, k + 1, N, k, k + 1, k + 1, end);
+        }
+    }
+};
+
+/**
+ * A Cholesky decomposition A = L L^T of a symmetric positive definite matrix. Only the lower triangle of A is read.
+ * Sizes up to 8 are factored by a fully unrolled kernel, larger ones by a blocked right-looking kernel like LU.
+ * @tparam T The floating point element type.
+ * @tparam N The number of rows and columns.
+ */
+template<typename T, size_t N>
+class Cholesky
+{
+    static_assert(std::is_floating_point_v<T>, "Cholesky's template parameter T must be a floating point type.");
+
+private:
+    detail::FactorStorage<Matrix<T, N, N>> lower;
+    bool isPositiveDefinite;
+
+public:
+    constexpr explicit Cholesky(const Matrix<T, N, N> &matrix) : lower(matrix)
+    {
+        isPositiveDefinite = detail::factorSymmetric<false>(*lower);
+    }
+
+    // accessor methods
+    // False if a pivot was not positive, in which case the factor is incomplete.
+    [[nodiscard]] constexpr bool positiveDefinite() const
+    { return isPositiveDefinite; }
+
+    // L, with zeros above the diagonal.
+    constexpr const Matrix<T, N, N> &matrixL() const
+    { return *lower; }
+
+    constexpr T determinant() const
+    {
+        T det = T(1);
+        for (size_t i = 0; i < N; ++i) {
+            det *= lower(i, i);
+        }
+        return det * det;
+    }
+
+    /**
+     * Solves A x = b with one forward and one back substitution.
+     * @param b The right hand side, a Vector<T, N> or a Matrix<T, N, P>.
+     * @return x.
+     */
+    template<typename B>
+    constexpr B solve(const B &b) const
+    {
+        assert(isPositiveDefinite && "Cannot solve with a failed Cholesky decomposition.");
+        B x = b;
+        substitute(x);
+        return x;
+    }
+
+    constexpr Matrix<T, N, N> inverse() const
+    {
+        assert(isPositiveDefinite && "Cannot invert a failed Cholesky decomposition.");
+        Matrix<T, N, N> x = Matrix<T, N, N>::identity();
+        substitute(x);
+        return x;
+    }
+
+    /**
+     * Rank-1 update. Refactors A + v v^T in O(N^2) with Givens-like rotations instead of O(N^3).
+     * @param v The update vector.
+     */
+    constexpr void update(const Vector<T, N> &v)
+    {
+        rankOne<false>(v);
+    }
+
+    /**
+     * Rank-1 downdate. Refactors A - v v^T in O(N^2).
+     * @param v The downdate vector.
+     * @return False if A - v v^T is not positive definite, which also clears positiveDefinite().
+     */
+    constexpr bool downdate(const Vector<T, N> &v)
+    {
+        return rankOne<true>(v);
+    }
+
+private:
+    // Overwrites b with the solution of A x = b.
+    template<typename B>
+    constexpr void substitute(B &b) const
+    {
+        detail::substituteLower<false>(*lower, b);
+        detail::substituteLowerTransposed<false>(*lower, b);
+    }
+
+    template<bool Downdate>
+    constexpr bool rankOne(Vector<T, N> x)
+    {
+        assert(isPositiveDefinite && "Cannot update a failed Cholesky decomposition.");
+        for (size_t k = 0; k < N; ++k) {
+            T diagonal = lower(k, k);
+            T squared = Downdate ? diagonal * diagonal - x[k] * x[k] : diagonal * diagonal + x[k] * x[k];
+            if (!(squared > T(0))) {
+                isPositiveDefinite = false;
+                return false;
+            }
+            T r = std::sqrt(squared);
+            T c = r / diagonal;
+            T s = x[k] / diagonal;
+            lower(k, k) = r;
+            for (size_t i = k + 1; i < N; ++i) {
+                lower(i, k) = Downdate ? (lower(i, k) - s * x[i]) / c : (lower(i, k) + s * x[i]) / c;
+                x[i] = c * x[i] - s * lower(i, k);
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * An LDL^T decomposition A = L D L^T of a symmetric matrix, without pivoting and without square roots. It also accepts
+ * indefinite matrices, as long as no pivot is zero, but is only stable for definite ones. Only the lower triangle of A is
+ * read. Uses the same kernels as Cholesky.
+ * @tparam T The floating point element type.
+ * @tparam N The number of rows and columns.
+ */
+template<typename T, size_t N>
+class LDLT
+{
+    static_assert(std::is_floating_point_v<T>, "LDLT's template parameter T must be a floating point type.");
+
+private:
+    detail::FactorStorage<Matrix<T, N, N>> factors;
+    bool isSingular;
+
+public:
+    constexpr explicit LDLT(const Matrix<T, N, N> &matrix) : factors(matrix)
+    {
+        isSingular = !detail::factorSymmetric<true>(*factors);
+    }
+
+    // accessor methods
+    // True if a pivot was zero, in which case the factors are incomplete.
+    [[nodiscard]] constexpr bool singular() const
+    { return isSingular; }
+
+    // L below the diagonal, without its unit diagonal, and D on it.
+    constexpr const Matrix<T, N, N> &packed() const
+    { return *factors; }
+
+    constexpr Vector<T, N> vectorD() const
+    {
+        Vector<T, N> d;
+        for (size_t i = 0; i < N; ++i) {
+            d[i] = factors(i, i);
+        }
+        return d;
+    }
+
+    constexpr T determinant() const
+    {
+        T det = T(1);
+        for (size_t i = 0; i < N; ++i) {
+            det *= factors(i, i);
+        }
+        return det;
+    }
+
+    /**
+     * Solves A x = b with a forward substitution, a diagonal scaling and a back substitution.
+     * @param b The right hand side, a Vector<T, N> or a Matrix<T, N, P>.
+     * @return x.
+     */
+    template<typename B>
+    constexpr B solve(const B &b) const
+    {
+        assert(!isSingular && "Cannot solve with a failed LDLT decomposition.");
+        B x = b;
+        substitute(x);
+        return x;
+    }
+
+    constexpr Matrix<T, N, N> inverse() const
+    {
+        assert(!isSingular && "Cannot invert a failed LDLT decomposition.");
+        Matrix<T, N, N> x = Matrix<T, N, N>::identity();
+        substitute(x);
+        return x;
+    }
+
+    /**
+     * Rank-1 update or downdate. Refactors A + sigma v v^T in O(N^2).
+     * @param v The update vector.
+     * @param sigma The sign and scale of the update, negative for a downdate.
+     * @return False if a pivot became zero, which also sets singular().
+     */
+    constexpr bool rankUpdate(const Vector<T, N> &v, const T &sigma = T(1))
+    {
+        assert(!isSingular && "Cannot update a failed LDLT decomposition.");
+        Vector<T, N> w = v;
+        T alpha = T(1);
+        for (size_t j = 0; j < N; ++j) {
+            T d = factors(j, j);
+            T wj = w[j];
+            T scaled = sigma * wj * wj;
+            T gamma = d * alpha + scaled;
+            factors(j, j) = d + scaled / alpha;
+            if (factors(j, j) == T(0)) {
+                isSingular = true;
+                return false;
+            }
+            alpha += scaled / d;
+            for (size_t i = j + 1; i < N; ++i) {
+                w[i] -= wj * factors(i, j);
+                if (gamma != T(0)) {
+                    factors(i, j) += sigma * wj / gamma * w[i];
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    // Overwrites b with the solution of A x = b.
+    template<typename B>
+    constexpr void substitute(B &b) const
+    {
+        detail::substituteLower<true>(*factors, b);
+        for (size_t i = 0; i < N; ++i) {
+            b[i] /= factors(i, i);
+        }
+        detail::substituteLowerTransposed<true>(*factors, b);
+    }
+};
+
+/**
+ * A Householder QR decomposition A = Q R of an N x M matrix with N >= M, for least squares problems. The Householder
+ * vectors, with their unit first element implied, are packed below the diagonal and R on and above it, with Q the
+ * product of the reflectors I - tau v v^T. Up to MATHUTILS_MATRIX_BLOCK_SIZE columns the reflectors are applied one at
+ * a time over contiguous rows. Wider matrices are factored in panels whose reflectors are accumulated in compact WY
+ * form, I - V T V^T, and applied to the trailing columns together.
+ * @tparam T The floating point element type.
+ * @tparam N The number of rows.
+ * @tparam M The number of columns.
+ */
+template<typename T, size_t N, size_t M>
+class QR
+{
+    static_assert(std::is_floating_point_v<T>, "QR's template parameter T must be a floating point type.");
+    static_assert(N >= M, "QR needs at least as many rows as columns.");
+
+private:
+    Matrix<T, N, M> factors;
+    Vector<T, M> tau;
+
+public:
+    constexpr explicit QR(const Matrix<T, N, M> &matrix) : factors(matrix), tau(T(0))
+    {
+        constexpr size_t block = MATHUTILS_MATRIX_BLOCK_SIZE;
+        if constexpr (M <= block) {
+            for (size_t k = 0; k < M; ++k) {
+                makeReflector(k);
+                applyReflector(k, k + 1, M);
+            }
+        } else {
+            for (size_t panel = 0; panel < M; panel += block) {
+                size_t panelEnd = std::min(panel + block, M);
+                for (size_t k = panel; k < panelEnd; ++k) {
+                    makeReflector(k);
+                    applyReflector(k, k + 1, panelEnd);
+                }
+                if (panelEnd < M) {
+                    applyBlockReflector(panel, panelEnd);
+                }
+            }
+        }
+    }
+
+    // accessor methods
+    // False if a diagonal element of R is within rounding error of zero relative to the largest one, in which case the
+    // least squares solution is not unique.
+    [[nodiscard]] constexpr bool fullRank() const
+    {
+        T largest = T(0);
+        for (size_t i = 0; i < M; ++i) {
+            largest = std::max(largest, std::abs(factors(i, i)));
+        }
+        T threshold = largest * T(N) * std::numeric_limits<T>::epsilon();
+        for (size_t i = 0; i < M; ++i) {
+            if (std::abs(factors(i, i)) <= threshold) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The Householder vectors below the diagonal and R on and above it.
+    constexpr const Matrix<T, N, M> &packed() const
+    { return factors; }
+
+    // The scale tau of each reflector I - tau v v^T.
+    constexpr const Vector<T, M> &householderCoefficients() const
+    { return tau; }
+
+    constexpr Matrix<T, M, M> matrixR() const
+    {
+        Matrix<T, M, M> r;
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = i; j < M; ++j) {
+                r(i, j) = factors(i, j);
+            }
+        }
+        return r;
+    }
+
+    // The first M columns of Q, whose columns are orthonormal and span the columns of A.
+    constexpr Matrix<T, N, M> thinQ() const
+    {
+        Matrix<T, N, M> q;
+        for (size_t i = 0; i < M; ++i) {
+            q(i, i) = T(1);
+        }
+        // Q = H_0 H_1 ... H_(M-1), so the reflectors are applied in reverse.
+        for (size_t k = M; k-- > 0;) {
+            reflect(k, q);
+        }
+        return q;
+    }
+
+    /**
+     * Applies Q^T to b.
+     * @param b A Vector<T, N>, or a Matrix<T, N, P> to transform every column.
+     * @return Q^T b.
+     */
+    template<typename B>
+    constexpr B applyQTranspose(B b) const
+    {
+        for (size_t k = 0; k < M; ++k) {
+            reflect(k, b);
+        }
+        return b;
+    }
+
+    /**
+     * Finds the x minimizing |A x - b|. Needs a full rank A.
+     * @param b The right hand side.
+     * @return x.
+     */
+    constexpr Vector<T, M> leastSquares(const Vector<T, N> &b) const
+    {
+        return backSubstitute(applyQTranspose(b), Vector<T, M>());
+    }
+
+    /**
+     * Finds the X minimizing the Frobenius norm of A X - B. Needs a full rank A.
+     * @param b The right hand sides.
+     * @return X.
+     */
+    template<size_t P>
+    constexpr Matrix<T, M, P> leastSquares(const Matrix<T, N, P> &b) const
+    {
+        return backSubstitute(applyQTranspose(b), Matrix<T, M, P>());
+    }
+
+    /**
+     * Solves the square system A x = b.
+     * @param b The right hand side, a Vector<T, N> or a Matrix<T, N, P>.
+     * @return x.
+     */
+    template<typename B>
+    constexpr B solve(const B &b) const requires (N == M)
+    {
+        return leastSquares(b);
+    }
+
+private:
+    // Turns column k below the diagonal into a Householder vector that zeroes it, and writes its R element.
+    constexpr void makeReflector(size_t k)
+    {
+        T x0 = factors(k, k);
+        T tailSquared = T(0);
+        for (size_t i = k + 1; i < N; ++i) {
+            tailSquared += factors(i, k) * factors(i, k);
+        }
+        if (tailSquared == T(0)) {
+            tau[k] = T(0);
+            return;
+        }
+        T norm = std::sqrt(x0 * x0 + tailSquared);
+        // The sign of beta is chosen opposite to x0 so x0 - beta does not cancel.
+        T beta = x0 >= T(0) ? -norm : norm;
+        T scale = T(1) / (x0 - beta);
+        for (size_t i = k + 1; i < N; ++i) {
+            factors(i, k) *= scale;
+        }
+        tau[k] = (beta - x0) / beta;
+        factors(k, k) = beta;
+    }
+
+    // Applies reflector k to the columns [begin, end), reading and updating whole rows at a time.
+    constexpr void applyReflector(size_t k, size_t begin, size_t end)
+    {
+        if (tau[k] == T(0) || begin == end) {
+            return;
+        }
+        std::array<T, M> w{};
+        for (size_t j = begin; j < end; ++j) {
+            w[j] = factors(k, j);
+        }
+        for (size_t i = k + 1; i < N; ++i) {
+            T v = factors(i, k);
+            const T *row = factors[i].data.data();
+            for (size_t j = begin; j < end; ++j) {
+                w[j] += v * row[j];
+            }
+        }
+        for (size_t j = begin; j < end; ++j) {
+            w[j] *= tau[k];
+            factors(k, j) -= w[j];
+        }
+        for (size_t i = k + 1; i < N; ++i) {
+            T v = factors(i, k);
+            T *row = factors[i].data.data();
+            for (size_t j = begin; j < end; ++j) {
+                row[j] -= v * w[j];
+            }
+        }
+    }
+
+    /**
+     * Applies the reflectors of the columns [panel, panelEnd) to every later column at once as I - V T^T V^T, where
+     * T is the upper triangular matrix of the compact WY form.
+     */
+    constexpr void applyBlockReflector(size_t panel, size_t panelEnd)
+    {
+        size_t width = panelEnd - panel;
+        size_t columns = M - panelEnd;
+        auto v = [&](size_t row, size_t k) {
+            return row == panel + k ? T(1) : (row > panel + k ? factors(row, panel + k) : T(0));
+        };
+
+        // Column i of T is -tau_i T V^T v_i above the diagonal and tau_i on it.
+        std::vector<T> t(width * width, T(0));
+        std::vector<T> z(width);
+        for (size_t i = 0; i < width; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                z[j] = T(0);
+                for (size_t row = panel + i; row < N; ++row) {
+                    z[j] += v(row, j) * v(row, i);
+                }
+            }
+            for (size_t j = 0; j < i; ++j) {
+                T sum = T(0);
+                for (size_t l = j; l < i; ++l) {
+                    sum += t[j * width + l] * z[l];
+                }
+                t[j * width + i] = -tau[panel + i] * sum;
+            }
+            t[i * width + i] = tau[panel + i];
+        }
+
+        // W = V^T A2, accumulated over rows so each row of A2 is read contiguously.
+        std::vector<T> w(width * columns, T(0));
+        for (size_t row = panel; row < N; ++row) {
+            const T *a = factors[row].data.data() + panelEnd;
+            for (size_t k = 0; k < width && panel + k <= row; ++k) {
+                T vk = v(row, k);
+                T *wk = w.data() + k * columns;
+                for (size_t j = 0; j < columns; ++j) {
+                    wk[j] += vk * a[j];
+                }
+            }
+        }
+        // W = T^T W, from the last row up so every row still reads unmodified rows above it.
+        for (size_t k = width; k-- > 0;) {
+            T *wk = w.data() + k * columns;
+            for (size_t j = 0; j < columns; ++j) {
+                wk[j] *= t[k * width + k];
+            }
+            for (size_t l = 0; l < k; ++l) {
+                T coefficient = t[l * width + k];
+                const T *wl = w.data() + l * columns;
+                for (size_t j = 0; j < columns; ++j) {
+                    wk[j] += coefficient * wl[j];
+                }
+            }
+        }
+        // A2 -= V W
+        for (size_t row = panel; row < N; ++row) {
+            T *a = factors[row].data.data() + panelEnd;
+            for (size_t k = 0; k < width && panel + k <= row; ++k) {
+                T vk = v(row, k);
+                const T *wk = w.data() + k * columns;
+                for (size_t j = 0; j < columns; ++j) {
+                    a[j] -= vk * wk[j];
+                }
+            }
+        }
+    }
+
+    // Applies reflector k to b, whose rows are scalars for a Vector and row vectors for a Matrix.
+    template<typename B>
+    constexpr void reflect(size_t k, B &b) const
+    {
+        if (tau[k] == T(0)) {
+            return;
+        }
+        auto w = b[k];
+        for (size_t i = k + 1; i < N; ++i) {
+            w += b[i] * factors(i, k);
+        }
+        w *= tau[k];
+        b[k] -= w;
+        for (size_t i = k + 1; i < N; ++i) {
+            b[i] -= w * factors(i, k);
+        }
+    }
+
+    // Solves R x = the first M rows of y.
+    template<typename Y, typename X>
+    constexpr X backSubstitute(const Y &y, X x) const
+    {
+        for (size_t i = M; i-- > 0;) {
+            x[i] = y[i];
+            for (size_t k = i + 1; k < M; ++k) {
+                x[i] -= x[k] * factors(i, k);
+            }
+            x[i] /= factors(i, i);
+        }
+        return x;
+    }
+};
+
+// Matrix chains
+/**
+ * The order matMultChain evaluates a product of K matrices in, found by the matrix chain dynamic program.
+ * @tparam K The number of factors.
+ */
+template<size_t K>
+struct MatrixChainOrder
+{
+    // split[i][j] is the last factor of the left operand of the final product of factors i to j.
+    std::array<std::array<size_t, K>, K> split{};
+    // Floating point operations, two per multiply-add, of the chosen order and of evaluating left to right.
+    size_t flops = 0;
+    size_t leftToRightFlops = 0;
+    std::array<char, K * 24> text{};
+    size_t textLength = 0;
+
+    // The chosen parenthesization with the factors named A0 to A(K-1), e.g. "(A0 (A1 A2))".
+    [[nodiscard]] constexpr std::string_view parenthesization() const
+    { return {text.data(), textLength}; }
+};
+
+namespace detail
+{
+template<typename M>
+struct MatrixShape;
+
+template<typename T, size_t N, size_t M>
+struct MatrixShape<Matrix<T, N, M>>
+{
+    using Element = T;
+    static constexpr size_t rows = N;
+    static constexpr size_t cols = M;
+};
+
+template<size_t K>
+consteval void appendChain(MatrixChainOrder<K> &order, size_t i, size_t j)
+{
+    auto put = [&](char c) { order.text[order.textLength++] = c; };
+    if (i == j) {
+        put('A');
+        char digits[20];
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + i % 10);
+            i /= 10;
+        } while (i > 0);
+        while (count > 0) {
+            put(digits[--count]);
+        }
+        return;
+    }
+    put('(');
+    appendChain(order, i, order.split[i][j]);
+    put(' ');
+    appendChain(order, order.split[i][j] + 1, j);
+    put(')');
+}
+
+/**
+ * Solves the matrix chain problem for factors with dimensions dims[0] x dims[1], dims[1] x dims[2], and so on. Ties
+ * keep the left to right order.
+ */
+template<size_t K>
+consteval MatrixChainOrder<K> chainOrder(const std::array<size_t, K + 1> &dims)
+{
+    MatrixChainOrder<K> order;
+    std::array<std::array<size_t, K>, K> cost{};
+    for (size_t length = 2; length <= K; ++length) {
+        for (size_t i = 0; i + length <= K; ++i) {
+            size_t j = i + length - 1;
+            cost[i][j] = static_cast<size_t>(-1);
+            for (size_t k = i; k < j; ++k) {
+                size_t c = cost[i][k] + cost[k + 1][j] + dims[i] * dims[k + 1] * dims[j + 1];
+                if (c <= cost[i][j]) {
+                    cost[i][j] = c;
+                    order.split[i][j] = k;
+                }
+            }
+        }
+    }
+    order.flops = 2 * cost[0][K - 1];
+    for (size_t k = 1; k < K; ++k) {
+        order.leftToRightFlops += 2 * dims[0] * dims[k] * dims[k + 1];
+    }
+    appendChain(order, 0, K - 1);
+    return order;
+}
+
+template<typename... Ms>
+consteval bool chainConforms()
+{
+    std::array<size_t, sizeof...(Ms)> rows{MatrixShape<Ms>::rows...};
+    std::array<size_t, sizeof...(Ms)> cols{MatrixShape<Ms>::cols...};
+    for (size_t i = 0; i + 1 < sizeof...(Ms); ++i) {
+        if (cols[i] != rows[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The product of factors I to J of the tuple, split as Order says. Single factors are returned by reference.
+template<size_t I, size_t J, auto Order, typename Tuple>
+constexpr decltype(auto) evaluateChain(const Tuple &factors)
+{
+    if constexpr (I == J) {
+        return std::get<I>(factors);
+    } else {
+        constexpr size_t k = Order.split[I][J];
+        return evaluateChain<I, k, Order>(factors).matMult(evaluateChain<k + 1, J, Order>(factors));
+    }
+}
+}
+
+/**
+ * Finds the cheapest order to multiply a chain of matrices in, entirely at compile time.
+ * @tparam Ms The matrix types of the factors, in order.
+ * @return The split points, the flop counts and a printable parenthesization of the chosen order.
+ */
+template<typename... Ms>
+consteval MatrixChainOrder<sizeof...(Ms)> matMultChainOrder()
+{
+    static_assert(sizeof...(Ms) > 0, "A matrix chain needs at least one factor.");
+    static_assert(detail::chainConforms<std::remove_cvref_t<Ms>...>(),
+                  "Each factor of a matrix chain must have as many rows as the previous one has columns.");
+    constexpr size_t K = sizeof...(Ms);
+    std::array<size_t, K> rows{detail::MatrixShape<std::remove_cvref_t<Ms>>::rows...};
+    std::array<size_t, K> cols{detail::MatrixShape<std::remove_cvref_t<Ms>>::cols...};
+    std::array<size_t, K + 1> dims{};
+    std::copy(rows.begin(), rows.end(), dims.begin());
+    dims[K] = cols[K - 1];
+    return detail::chainOrder<K>(dims);
+}
+
+/**
+ * Multiplies a chain of matrices in the order of matMultChainOrder, which can need far fewer flops than multiplying
+ * left to right when the dimensions differ a lot. The order is fixed at compile time, so the call compiles to the
+ * nested matMult calls of that order.
+ * @param matrices The factors, all with the same element type, which matMult must not widen.
+ * @return The product of all factors.
+ */
+template<typename... Ms>
+constexpr auto matMultChain(const Ms &... matrices)
+{
+    using T = typename detail::MatrixShape<std::tuple_element_t<0, std::tuple<Ms...>>>::Element;
+    static_assert((std::is_same_v<typename detail::MatrixShape<Ms>::Element, T> && ...),
+                  "All factors of a matrix chain must have the same element type.");
+    static_assert(std::is_same_v<typename ElementTraits<T>::Accumulator, T>,
+                  "matMultChain needs an element type that matMult does not widen.");
+    constexpr MatrixChainOrder<sizeof...(Ms)> order = matMultChainOrder<Ms...>();
+    return detail::evaluateChain<0, sizeof...(Ms) - 1, order>(std::forward_as_tuple(matrices...));
+}
+
+// GEMM
+// The epilogue gemm applies when none is given.
+struct IdentityEpilogue
+{
+    template<typename T>
+    constexpr T operator()(const T &value) const
+    { return value; }
+};
+
+namespace detail
+{
+// Rows and columns of the block of C that gemm accumulates in registers.
+inline constexpr size_t gemmTileRows = 4;
+
+template<typename T>
+inline constexpr size_t gemmTileCols = 2 * simdLanes<T>;
+
+/**
+ * Accumulates the rows x cols block of A * B at (i0, j0) in an MR x NR register tile, then passes each of its elements
+ * to store(i, j, sum). Full tiles run with constant trip counts so the column loop vectorizes.
+ * @param aRow Returns a pointer to the depth elements of row i of A.
+ * @param bRow Returns a pointer to row k of B.
+ */
+template<size_t MR, size_t NR, typename Acc, typename ARow, typename BRow, typename Store>
+constexpr void gemmTile(ARow &aRow, BRow &bRow, size_t depth, size_t i0, size_t j0, size_t rows, size_t cols,
+                        Store &store)
+{
+    std::array<std::array<Acc, NR>, MR> acc{};
+    std::array<decltype(aRow(i0)), MR> aRows{};
+    for (size_t r = 0; r < rows; ++r) {
+        aRows[r] = aRow(i0 + r);
+    }
+    if (rows == MR && cols == NR) {
+        for (size_t k = 0; k < depth; ++k) {
+            auto bValues = bRow(k) + j0;
+            for (size_t r = 0; r < MR; ++r) {
+                Acc value = static_cast<Acc>(aRows[r][k]);
+                for (size_t c = 0; c < NR; ++c) {
+                    acc[r][c] += value * static_cast<Acc>(bValues[c]);
+                }
+            }
+        }
+    } else {
+        for (size_t k = 0; k < depth; ++k) {
+            auto bValues = bRow(k) + j0;
+            for (size_t r = 0; r < rows; ++r) {
+                Acc value = static_cast<Acc>(aRows[r][k]);
+                for (size_t c = 0; c < cols; ++c) {
+                    acc[r][c] += value * static_cast<Acc>(bValues[c]);
+                }
+            }
+        }
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            store(i0 + r, j0 + c, acc[r][c]);
+        }
+    }
+}
+
+/**
+ * Covers an n x m product of depth long rows and columns with gemmTile calls, splitting the row tiles across threads
+ * above MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+ */
+template<size_t MR, size_t NR, typename Acc, typename ARow, typename BRow, typename Store>
+void gemmTiles(size_t n, size_t depth, size_t m, ARow &&aRow, BRow &&bRow, Store &&store)
+{
+    size_t tiles = (n + MR - 1) / MR;
+    parallelRanges(0, tiles, n * depth * m, [&](size_t first, size_t last) {
+        for (size_t tile = first; tile < last; ++tile) {
+            size_t i0 = tile * MR;
+            size_t rows = std::min(MR, n - i0);
+            for (size_t j0 = 0; j0 < m; j0 += NR) {
+                gemmTile<MR, NR, Acc>(aRow, bRow, depth, i0, j0, rows, std::min(NR, m - j0), store);
+            }
+        }
+    });
+}
+
+// Applies the epilogue to one element, passing its row and column if the epilogue takes them.
+template<typename Epilogue, typename Acc>
+constexpr decltype(auto) applyEpilogue(Epilogue &epilogue, const Acc &value, size_t row, size_t col)
+{
+    if constexpr (std::is_invocable_v<Epilogue &, const Acc &, size_t, size_t>) {
+        return epilogue(value, row, col);
+    } else {
+        return epilogue(value);
+    }
+}
+
+/**
+ * The store function of gemmTile for C = epilogue(alpha * sum + beta * C + bias).
+ * @param element Returns a reference to element (i, j) of C.
+ * @param bias The per-column bias, or null.
+ */
+template<typename Acc, typename Element, typename Epilogue>
+auto gemmStore(Acc alpha, Acc beta, std::type_identity_t<const Acc *> bias, Element &element, Epilogue &epilogue)
+{
+    // BLAS semantics: C is not read when beta is 0, so it may hold anything.
+    return [alpha, beta, bias, &element, &epilogue, readC = beta != Acc(0)](size_t i, size_t j, const Acc &sum) {
+        Acc value = static_cast<Acc>(alpha * sum);
+        auto &target = element(i, j);
+        if (readC) {
+            value += static_cast<Acc>(beta * static_cast<Acc>(target));
+        }
+        if (bias != nullptr) {
+            value += bias[j];
+        }
+        target = static_cast<std::remove_reference_t<decltype(target)>>(applyEpilogue(epilogue, value, i, j));
+    };
+}
+
+template<typename T, size_t N, size_t K, size_t M, typename U, typename Epilogue>
+void gemm(typename Matrix<T, N, K>::AccumulatorType alpha, const Matrix<T, N, K> &a, const Matrix<T, K, M> &b,
+          typename Matrix<T, N, K>::AccumulatorType beta, Matrix<U, N, M> &c,
+          std::type_identity_t<const typename Matrix<T, N, K>::AccumulatorType *> bias, Epilogue &epilogue)
+{
+    using Acc = typename Matrix<T, N, K>::AccumulatorType;
+    auto element = [&c](size_t i, size_t j) -> U & { return c(i, j); };
+    gemmTiles<std::min(gemmTileRows, N), std::min(gemmTileCols<Acc>, M), Acc>(
+            N, K, M, [&a](size_t i) { return a[i].data.data(); }, [&b](size_t k) { return b[k].data.data(); },
+            gemmStore(alpha, beta, bias, element, epilogue));
+}
+}
+
+/**
+ * General matrix multiply, C = epilogue(alpha * A * B + beta * C), in a single pass over C. Blocks of C are
+ * accumulated in registers and scaled, added to beta * C and passed through the epilogue before they are stored, so
+ * none of these steps rereads C from memory. Rows are split across threads above MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+ * @param alpha The scale of the product.
+ * @param a The N x K left factor.
+ * @param b The K x M right factor.
+ * @param beta The scale of the old C. C is not read when beta is 0.
+ * @param c The N x M result. Its elements are converted to and from the accumulator type of T.
+ * @param epilogue Called as epilogue(value) or epilogue(value, row, col) on every element before it is stored, e.g. an
+ * activation function. Each element is passed exactly once, in no particular order. When rows are split across
+ * threads, the threads share this one epilogue object and call it concurrently, so it must not modify state without
+ * synchronization.
+ */
+template<typename T, size_t N, size_t K, size_t M, typename U, typename Epilogue = IdentityEpilogue>
+void gemm(typename Matrix<T, N, K>::AccumulatorType alpha, const Matrix<T, N, K> &a, const Matrix<T, K, M> &b,
+          typename Matrix<T, N, K>::AccumulatorType beta, Matrix<U, N, M> &c, Epilogue epilogue = {})
+{
+    detail::gemm(alpha, a, b, beta, c, nullptr, epilogue);
+}
+
+/**
+ * General matrix multiply with a bias, C = epilogue(alpha * A * B + beta * C + bias), see gemm above.
+ * @param bias Added to every row, so bias[j] is added to column j, as for the outputs of a dense layer.
+ */
+template<typename T, size_t N, size_t K, size_t M, typename U, typename Epilogue = IdentityEpilogue>
+void gemm(typename Matrix<T, N, K>::AccumulatorType alpha, const Matrix<T, N, K> &a, const Matrix<T, K, M> &b,
+          typename Matrix<T, N, K>::AccumulatorType beta, Matrix<U, N, M> &c,
+          const Vector<typename Matrix<T, N, K>::AccumulatorType, M> &bias, Epilogue epilogue = {})
+{
+    detail::gemm(alpha, a, b, beta, c, bias.data.data(), epilogue);
+}
+
+namespace detail
+{
+// Interleaves in[group], in[group + 1], ... one matrix per lane, with element (i, j) of each at m[i * N + j]. Short
+// groups repeat their last matrix in the unused lanes.
+template<typename T, size_t N, size_t Lanes>
+void interleaveGroup(std::span<const Matrix<T, N, N>> in, size_t group, std::array<Vector<T, Lanes>, N * N> &m)
+{
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        const Matrix<T, N, N> &source = in[std::min(group + lane, in.size() - 1)];
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                m[i * N + j][lane] = source(i, j);
+            }
+        }
+    }
+}
+
+/**
+ * factorSymmetricUnrolled on interleaved matrices, with the same operations in the same order for every lane.
+ * @return The lanes whose pivot was not positive (Cholesky) or zero (LDLT).
+ */
+template<bool Ldlt, typename T, size_t N, size_t Lanes>
+Mask<Lanes> factorSymmetricLanes(std::array<Vector<T, Lanes>, N * N> &m)
+{
+    using Lane = Vector<T, Lanes>;
+    const Lane zero(T(0));
+    const Lane one(T(1));
+    Mask<Lanes> failed(false);
+    unrolledFor<N>([&](auto j) {
+        Lane d = m[j * N + j];
+        unrolledFor<j>([&](auto k) {
+            d -= Ldlt ? m[j * N + k] * m[j * N + k] * m[k * N + k] : m[j * N + k] * m[j * N + k];
+        });
+        failed = failed | (Ldlt ? equal(d, zero) : ~greaterThan(d, zero));
+        Lane pivot = d;
+        if constexpr (!Ldlt) {
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                pivot[lane] = std::sqrt(d[lane]);
+            }
+        }
+        m[j * N + j] = pivot;
+        Lane inv = one / pivot;
+        unrolledFor<N - j - 1>([&](auto offset) {
+            constexpr size_t i = j + 1 + offset;
+            Lane sum = m[i * N + j];
+            unrolledFor<j>([&](auto k) {
+                sum -= Ldlt ? m[i * N + k] * m[j * N + k] * m[k * N + k] : m[i * N + k] * m[j * N + k];
+            });
+            m[i * N + j] = sum * inv;
+        });
+    });
+    return failed;
+}
+
+/**
+ * Factors every matrix of in into out like factorSymmetric. Sizes the unrolled kernel handles are interleaved in groups
+ * of one SIMD register's worth, so that each of its steps runs on every matrix of the group at once in Vector<T, Lanes>
+ * arithmetic. Larger matrices are factored one after another by the blocked kernel.
+ * @return The number of matrices whose factorization failed.
+ */
+template<bool Ldlt, typename T, size_t N>
+size_t factorSymmetricBatch(std::span<const Matrix<T, N, N>> in, std::span<Matrix<T, N, N>> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t failed = 0;
+    if constexpr (N <= unrolledFactorLimit) {
+        constexpr size_t Lanes = simdLanes<T>;
+        std::array<Vector<T, Lanes>, N * N> m;
+        for (size_t group = 0; group < in.size(); group += Lanes) {
+            interleaveGroup(in, group, m);
+            Mask<Lanes> groupFailed = factorSymmetricLanes<Ldlt, T, N, Lanes>(m);
+            for (size_t lane = 0; lane < Lanes && group + lane < in.size(); ++lane) {
+                Matrix<T, N, N> &result = out[group + lane];
+                for (size_t i = 0; i < N; ++i) {
+                    for (size_t j = 0; j < N; ++j) {
+                        result(i, j) = j <= i ? m[i * N + j][lane] : T(0);
+                    }
+                }
+                failed += groupFailed[lane];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = in[i];
+            failed += !factorSymmetric<Ldlt>(out[i]);
+        }
+    }
+    return failed;
+}
+}
+
+// Batch kernels
+/**
+ * Inverts every matrix of a span. Sizes up to 4 are interleaved like in cholesky, so that the adjugate kernel inverts a
+ * SIMD register's worth of them at once. Larger ones are LU factored one after another and solved in place in out.
+ * @param in The matrices to invert.
+ * @param out The destination, which must be the same size as in. Singular matrices are written as all zeros.
+ * @return The number of singular matrices.
+ */
+template<typename T, size_t N>
+size_t inverse(std::type_identity_t<std::span<const Matrix<T, N, N>>> in, std::span<Matrix<T, N, N>> out)
+{
+    static_assert(std::is_floating_point_v<T>, "Only matrices of a floating point type can be inverted.");
+    assert(in.size() == out.size() && "Span size mismatch.");
+    size_t singular = 0;
+    if constexpr (N <= 4) {
+        constexpr size_t Lanes = detail::simdLanes<T>;
+        using Lane = Vector<T, Lanes>;
+        const Lane zero(T(0));
+        const Lane one(T(1));
+        std::array<Lane, N * N> m;
+        std::array<Lane, N * N> adj;
+        for (size_t group = 0; group < in.size(); group += Lanes) {
+            detail::interleaveGroup(in, group, m);
+            Lane det = detail::adjugate<N, Lane>([&](size_t i, size_t j) -> const Lane & { return m[i * N + j]; },
+                                                 [&](size_t i, size_t j) -> Lane & { return adj[i * N + j]; });
+            Mask<Lanes> zeroDet = equal(det, zero);
+            Lane inv = one / select(zeroDet, one, det);
+            for (Lane &element: adj) {
+                element *= inv;
+            }
+            for (size_t lane = 0; lane < Lanes && group + lane < in.size(); ++lane) {
+                Matrix<T, N, N> &result = out[group + lane];
+                for (size_t i = 0; i < N; ++i) {
+                    for (size_t j = 0; j < N; ++j) {
+                        result(i, j) = zeroDet[lane] ? T(0) : adj[i * N + j][lane];
+                    }
+                }
+                singular += zeroDet[lane];
+            }
+        }
+    } else {
+        for (size_t k = 0; k < in.size(); ++k) {
+            LU<T, N> lu(in[k]);
+            Matrix<T, N, N> &result = out[k];
+            for (size_t i = 0; i < N; ++i) {
+                result[i] = Vector<T, N>(T(0));
+            }
+            if (lu.singular()) {
+                ++singular;
+                continue;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                result(i, lu.rowPermutation()[i]) = T(1);
+            }
+            detail::substituteLower<true>(lu.packed(), result);
+            detail::substituteUpper<false>(lu.packed(), result);
+        }
+    }
+    return singular;
+}
+
+/**
+ * Cholesky factors every matrix of a span. Meant for many small matrices, which are interleaved so that the unrolled
+ * kernel factors a SIMD register's worth of them at once, see detail::factorSymmetricBatch.
+ * @param in The symmetric positive definite matrices to factor. Only their lower triangles are read.
+ * @param lower The destination for each L, which must be the same size as in.
+ * @return The number of matrices that were not positive definite.
+ */
+template<typename T, size_t N>
+size_t cholesky(std::type_identity_t<std::span<const Matrix<T, N, N>>> in, std::span<Matrix<T, N, N>> lower)
+{
+    return detail::factorSymmetricBatch<false, T, N>(in, lower);
+}
+
+/**
+ * LDL^T factors every matrix of a span. Meant for many small matrices, which are interleaved like in cholesky.
+ * @param in The symmetric matrices to factor. Only their lower triangles are read.
+ * @param packed The destination for each factorization in the layout of LDLT::packed(), which must be the same size as
+ * in.
+ * @return The number of matrices that had a zero pivot.
+ */
+template<typename T, size_t N>
+size_t ldlt(std::type_identity_t<std::span<const Matrix<T, N, N>>> in, std::span<Matrix<T, N, N>> packed)
+{
+    return detail::factorSymmetricBatch<true, T, N>(in, packed);
+}
+
+/**
+ * Solves many least squares problems of the same shape, min |A x - b| for each A, b pair. The matrices are interleaved
+ * in groups of one SIMD register's worth, so that each step of an unblocked Householder QR runs on every matrix of the
+ * group at once in Vector<T, Lanes> arithmetic.
+ * @param a The N x M matrices, with N >= M.
+ * @param b The right hand sides, which must be the same size as a.
+ * @param x The destination for the solutions, which must be the same size as a. Rank deficient problems get zeros.
+ * @return The number of rank deficient problems.
+ */
+template<typename T, size_t N, size_t M>
+size_t leastSquares(std::type_identity_t<std::span<const Matrix<T, N, M>>> a,
+                    std::type_identity_t<std::span<const Vector<T, N>>> b, std::span<Vector<T, M>> x)
+{
+    static_assert(std::is_floating_point_v<T>, "Least squares needs a floating point type.");
+    static_assert(N >= M, "Least squares needs at least as many rows as columns.");
+    assert(a.size() == b.size() && a.size() == x.size() && "Span size mismatch.");
+    constexpr size_t Lanes = detail::simdLanes<T>;
+    using Lane = Vector<T, Lanes>;
+    const Lane zero(T(0));
+    const Lane one(T(1));
+
+    // Element (i, j) of every matrix in the group, then element i of every right hand side.
+    std::vector<Lane> m(N * M, zero);
+    std::vector<Lane> rhs(N, zero);
+    size_t deficient = 0;
+    for (size_t group = 0; group < a.size(); group += Lanes) {
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            // Short groups repeat their last problem in the unused lanes.
+            size_t source = std::min(group + lane, a.size() - 1);
+            for (size_t i = 0; i < N; ++i) {
+                for (size_t j = 0; j < M; ++j) {
+                    m[i * M + j][lane] = a[source](i, j);
+                }
+                rhs[i][lane] = b[source][i];
+            }
+        }
+
+        for (size_t k = 0; k < M; ++k) {
+            Lane x0 = m[k * M + k];
+            Lane tailSquared = zero;
+            for (size_t i = k + 1; i < N; ++i) {
+                tailSquared += m[i * M + k] * m[i * M + k];
+            }
+            Lane norm;
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                norm[lane] = std::sqrt(x0[lane] * x0[lane] + tailSquared[lane]);
+            }
+            // Lanes whose column is already zero below the diagonal get tau = 0 and keep x0.
+            Mask<Lanes> skip = equal(tailSquared, zero);
+            Lane beta = select(skip, x0, select(greaterThanEqual(x0, zero), -norm, norm));
+            Lane scale = one / select(skip, one, x0 - beta);
+            Lane tau = select(skip, zero, (beta - x0) / select(skip, one, beta));
+            for (size_t i = k + 1; i < N; ++i) {
+                m[i * M + k] *= scale;
+            }
+            m[k * M + k] = beta;
+
+            for (size_t j = k + 1; j < M; ++j) {
+                Lane w = m[k * M + j];
+                for (size_t i = k + 1; i < N; ++i) {
+                    w += m[i * M + k] * m[i * M + j];
+                }
+                w *= tau;
+                m[k * M + j] -= w;
+                for (size_t i = k + 1; i < N; ++i) {
+                    m[i * M + j] -= m[i * M + k] * w;
+                }
+            }
+            Lane w = rhs[k];
+            for (size_t i = k + 1; i < N; ++i) {
+                w += m[i * M + k] * rhs[i];
+            }
+            w *= tau;
+            rhs[k] -= w;
+            for (size_t i = k + 1; i < N; ++i) {
+                rhs[i] -= m[i * M + k] * w;
+            }
+        }
+
+        // The same rank test as QR::fullRank.
+        Lane largest = zero;
+        for (size_t i = 0; i < M; ++i) {
+            largest = max(largest, abs(m[i * M + i]));
+        }
+        Lane threshold = largest * (T(N) * std::numeric_limits<T>::epsilon());
+        Mask<Lanes> singular(false);
+        for (size_t i = M; i-- > 0;) {
+            for (size_t k = i + 1; k < M; ++k) {
+                rhs[i] -= m[i * M + k] * rhs[k];
+            }
+            Mask<Lanes> tiny = lessThanEqual(abs(m[i * M + i]), threshold);
+            singular = singular | tiny;
+            rhs[i] /= select(tiny, one, m[i * M + i]);
+        }
+        for (size_t lane = 0; lane < Lanes && group + lane < a.size(); ++lane) {
+            Vector<T, M> &solution = x[group + lane];
+            for (size_t i = 0; i < M; ++i) {
+                solution[i] = singular[lane] ? T(0) : rhs[i][lane];
+            }
+            deficient += singular[lane];
+        }
+    }
+    return deficient;
+}
+
 #define USING_MATRIX(R, C, SUFFIX, TYPE) \
 using Mat##R##x##C##SUFFIX = Matrix<TYPE, R, C>; \
 USING_VECTOR(C, SUFFIX, TYPE)
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include "Vector.h"
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+namespace MathUtils
+{
+
+// An 8 bit per channel RGBA pixel, with the channels in x, y, z and w.
+using Pixel = Vector<uint8_t, 4>;
+
+static_assert(sizeof(Pixel) == 4, "Pixel spans are processed as packed bytes.");
+
+namespace detail
+{
+/**
+ * Computes x / 255 rounded to nearest for x in [0, 255 * 255], without a division.
+ */
+constexpr uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+// div255 on eight 16 bit lanes.
+inline __m128i div255Epu16(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Broadcasts the alpha lane of each of the two pixels held in eight 16 bit lanes.
+inline __m128i broadcastAlphaEpu16(__m128i x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+#endif
+
+#ifdef __AVX2__
+// div255 on sixteen 16 bit lanes.
+inline __m256i div255Epu16(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Broadcasts the alpha lane of each of the four pixels held in sixteen 16 bit lanes.
+inline __m256i broadcastAlphaEpu16(__m256i x)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+#endif
+}
+
+/**
+ * Premultiplies the color channels of every pixel by its alpha, rounding to nearest. Processes 8 pixels per AVX2 or 4
+ * per SSE2 register.
+ * @param pixels The pixels to premultiply in place.
+ */
+inline void premultiply(std::span<Pixel> pixels)
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000u));
+        for (; i + 8 <= pixels.size(); i += 8) {
+            __m256i *address = reinterpret_cast<__m256i *>(pixels.data() + i);
+            __m256i packed = _mm256_loadu_si256(address);
+            // The unpacks and the pack work within 128 bit lanes, so the pixels come back in order.
+            __m256i lo = _mm256_unpacklo_epi8(packed, zero);
+            __m256i hi = _mm256_unpackhi_epi8(packed, zero);
+            lo = detail::div255Epu16(_mm256_mullo_epi16(lo, detail::broadcastAlphaEpu16(lo)));
+            hi = detail::div255Epu16(_mm256_mullo_epi16(hi, detail::broadcastAlphaEpu16(hi)));
+            __m256i result = _mm256_packus_epi16(lo, hi);
+            result = _mm256_blendv_epi8(result, packed, alphaMask);
+            _mm256_storeu_si256(address, result);
+        }
+    }
+#endif
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+    for (; i + 4 <= pixels.size(); i += 4) {
+        __m128i *address = reinterpret_cast<__m128i *>(pixels.data() + i);
+        __m128i packed = _mm_loadu_si128(address);
+        __m128i lo = _mm_unpacklo_epi8(packed, zero);
+        __m128i hi = _mm_unpackhi_epi8(packed, zero);
+        lo = detail::div255Epu16(_mm_mullo_epi16(lo, detail::broadcastAlphaEpu16(lo)));
+        hi = detail::div255Epu16(_mm_mullo_epi16(hi, detail::broadcastAlphaEpu16(hi)));
+        __m128i result = _mm_packus_epi16(lo, hi);
+        // Alpha times alpha is not alpha; restore the original alpha bytes.
+        result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, packed));
+        _mm_storeu_si128(address, result);
+    }
+#endif
+    for (; i < pixels.size(); ++i) {
+        uint32_t alpha = pixels[i].data[3];
+        for (size_t c = 0; c < 3; ++c) {
+            pixels[i].data[c] = static_cast<uint8_t>(detail::div255(pixels[i].data[c] * alpha));
+        }
+    }
+}
+
+/**
+ * Composites premultiplied source pixels over premultiplied destination pixels (Porter-Duff over):
+ * dst = src + dst * (255 - src.alpha) / 255 on every channel. Processes 8 pixels per AVX2 or 4 per SSE2 register.
+ * @param src The source pixels.
+ * @param dst The destination pixels, blended in place. Must be the same size as src.
+ */
+inline void blendOver(std::span<const Pixel> src, std::span<Pixel> dst)
+{
+    assert(src.size() == dst.size() && "Span size mismatch.");
+    size_t i = 0;
+#ifdef __AVX2__
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i full = _mm256_set1_epi16(255);
+        for (; i + 8 <= dst.size(); i += 8) {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src.data() + i));
+            __m256i *address = reinterpret_cast<__m256i *>(dst.data() + i);
+            __m256i d = _mm256_loadu_si256(address);
+            __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+            __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+            __m256i dLo = _mm256_unpacklo_epi8(d, zero);
+            __m256i dHi = _mm256_unpackhi_epi8(d, zero);
+            __m256i invLo = _mm256_sub_epi16(full, detail::broadcastAlphaEpu16(sLo));
+            __m256i invHi = _mm256_sub_epi16(full, detail::broadcastAlphaEpu16(sHi));
+            dLo = _mm256_add_epi16(sLo, detail::div255Epu16(_mm256_mullo_epi16(dLo, invLo)));
+            dHi = _mm256_add_epi16(sHi, detail::div255Epu16(_mm256_mullo_epi16(dHi, invHi)));
+            _mm256_storeu_si256(address, _mm256_packus_epi16(dLo, dHi));
+        }
+    }
+#endif
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    for (; i + 4 <= dst.size(); i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data() + i));
+        __m128i *address = reinterpret_cast<__m128i *>(dst.data() + i);
+        __m128i d = _mm_loadu_si128(address);
+        __m128i sLo = _mm_unpacklo_epi8(s, zero);
+        __m128i sHi = _mm_unpackhi_epi8(s, zero);
+        __m128i dLo = _mm_unpacklo_epi8(d, zero);
+        __m128i dHi = _mm_unpackhi_epi8(d, zero);
+        __m128i invLo = _mm_sub_epi16(full, detail::broadcastAlphaEpu16(sLo));
+        __m128i invHi = _mm_sub_epi16(full, detail::broadcastAlphaEpu16(sHi));
+        dLo = _mm_add_epi16(sLo, detail::div255Epu16(_mm_mullo_epi16(dLo, invLo)));
+        dHi = _mm_add_epi16(sHi, detail::div255Epu16(_mm_mullo_epi16(dHi, invHi)));
+        _mm_storeu_si128(address, _mm_packus_epi16(dLo, dHi));
+    }
+#endif
+    for (; i < dst.size(); ++i) {
+        uint32_t inverse = 255u - src[i].data[3];
+        for (size_t c = 0; c < 4; ++c) {
+            uint32_t value = src[i].data[c] + detail::div255(dst[i].data[c] * inverse);
+            dst[i].data[c] = static_cast<uint8_t>(value > 255u ? 255u : value);
+        }
+    }
+}
+
+/**
+ * Reorders the channels of every pixel, e.g. swizzleChannels<2, 1, 0, 3> converts RGBA to BGRA. Uses a single byte
+ * shuffle per 4 (SSSE3) or 8 (AVX2) pixels.
+ * @tparam I0 The source channel of channel 0.
+ * @tparam I1 The source channel of channel 1.
+ * @tparam I2 The source channel of channel 2.
+ * @tparam I3 The source channel of channel 3.
+ * @param pixels The pixels to reorder in place.
+ */
+template<size_t I0, size_t I1, size_t I2, size_t I3>
+void swizzleChannels(std::span<Pixel> pixels)
+{
+    static_assert(I0 < 4 && I1 < 4 && I2 < 4 && I3 < 4, "Pixel channel index out of bounds.");
+    size_t i = 0;
+#if defined(__SSSE3__) || defined(__AVX2__)
+    const __m128i shuffle = _mm_setr_epi8(I0, I1, I2, I3, 4 + I0, 4 + I1, 4 + I2, 4 + I3,
+                                          8 + I0, 8 + I1, 8 + I2, 8 + I3, 12 + I0, 12 + I1, 12 + I2, 12 + I3);
+#ifdef __AVX2__
+    const __m256i shuffle256 = _mm256_broadcastsi128_si256(shuffle);
+    for (; i + 8 <= pixels.size(); i += 8) {
+        __m256i *address = reinterpret_cast<__m256i *>(pixels.data() + i);
+        _mm256_storeu_si256(address, _mm256_shuffle_epi8(_mm256_loadu_si256(address), shuffle256));
+    }
+#endif
+    for (; i + 4 <= pixels.size(); i += 4) {
+        __m128i *address = reinterpret_cast<__m128i *>(pixels.data() + i);
+        _mm_storeu_si128(address, _mm_shuffle_epi8(_mm_loadu_si128(address), shuffle));
+    }
+#endif
+    for (; i < pixels.size(); ++i) {
+        Pixel p = pixels[i];
+        pixels[i] = Pixel(p.data[I0], p.data[I1], p.data[I2], p.data[I3]);
+    }
+}
+
+/**
+ * Builds a lookup table that maps v to round(255 * (v / 255)^gamma).
+ * @param gamma The exponent to apply.
+ * @return The lookup table.
+ */
+inline std::array<uint8_t, 256> gammaLut(float gamma)
+{
+    std::array<uint8_t, 256> lut{};
+    for (size_t v = 0; v < 256; ++v) {
+        lut[v] = static_cast<uint8_t>(std::lround(255.0f * std::pow(static_cast<float>(v) / 255.0f, gamma)));
+    }
+    return lut;
+}
+
+/**
+ * Maps the color channels of every pixel through a lookup table, leaving alpha unchanged.
+ * @param pixels The pixels to map in place.
+ * @param lut The table to look each color channel up in, e.g. from gammaLut.
+ */
+inline void applyLut(std::span<Pixel> pixels, const std::array<uint8_t, 256> &lut)
+{
+    for (Pixel &p : pixels) {
+        p.data[0] = lut[p.data[0]];
+        p.data[1] = lut[p.data[1]];
+        p.data[2] = lut[p.data[2]];
+    }
+}
+
+/**
+ * Converts pixels to normalized float vectors in [0, 1].
+ * @param in The pixels to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void pixelsToFloat(std::span<const Pixel> in, std::span<Vector<float, 4>> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    constexpr float scale = 1.0f / 255.0f;
+    for (size_t i = 0; i < in.size(); ++i) {
+        for (size_t c = 0; c < 4; ++c) {
+            out[i].data[c] = static_cast<float>(in[i].data[c]) * scale;
+        }
+    }
+}
+
+/**
+ * Converts normalized float vectors to pixels, clamping to [0, 1] and rounding to nearest.
+ * @param in The float vectors to convert.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void pixelsFromFloat(std::span<const Vector<float, 4>> in, std::span<Pixel> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    for (size_t i = 0; i < in.size(); ++i) {
+        for (size_t c = 0; c < 4; ++c) {
+            float v = in[i].data[c] * 255.0f + 0.5f;
+            v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+            out[i].data[c] = static_cast<uint8_t>(v);
+        }
+    }
+}
+
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include "Vector.h"
+
+#if defined(__AVX2__) || (defined(__AVX512VNNI__) && defined(__AVX512BW__))
+    #include <immintrin.h>
+#endif
+
+namespace MathUtils
+{
+
+// Quantized values are kept in [-QuantizedMax, QuantizedMax], a range symmetric about the zero point.
+inline constexpr int32_t QuantizedMax = 127;
+
+namespace detail
+{
+#if defined(__AVX2__)
+// The sum of the eight int32 lanes of x.
+inline int32_t horizontalSumEpi32(__m256i x)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+/**
+ * Sums the elementwise products of a with each of Columns int8 arrays into int32s, loading a once for all of them. Uses
+ * VNNI (vpdpbusd) kernels, which multiply unsigned by signed bytes, on b + 128 and subtract the 128 * sum(a) this adds,
+ * which is shared by all columns. Without VNNI the AVX2 kernel widens both to int16 (pmaddwd). Both are exact for the
+ * full int8 range.
+ * @param out The destination for the Columns dot products.
+ */
+template<size_t Columns>
+inline void dotInt8Tile(const int8_t *a, const std::array<const int8_t *, Columns> &b, size_t n, int32_t *out)
+{
+    size_t i = 0;
+    std::array<int32_t, Columns> result{};
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+    __m512i acc512[Columns];
+    std::fill_n(acc512, Columns, _mm512_setzero_si512());
+    __m512i bias512 = _mm512_setzero_si512();
+    const __m512i flip512 = _mm512_set1_epi8(static_cast<char>(0x80));
+    for (; i + 64 <= n; i += 64) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        bias512 = _mm512_dpbusd_epi32(bias512, flip512, va);
+        for (size_t c = 0; c < Columns; ++c) {
+            __m512i vb = _mm512_loadu_si512(b[c] + i);
+            acc512[c] = _mm512_dpbusd_epi32(acc512[c], _mm512_xor_si512(vb, flip512), va);
+        }
+    }
+    for (size_t c = 0; c < Columns; ++c) {
+        // The masked extracts take an explicit source instead of the undefined one GCC warns about.
+        __m512i sum = _mm512_sub_epi32(acc512[c], bias512);
+        __m256i lo = _mm512_mask_extracti64x4_epi64(_mm256_setzero_si256(), 0xFF, sum, 0);
+        __m256i hi = _mm512_mask_extracti64x4_epi64(_mm256_setzero_si256(), 0xFF, sum, 1);
+        result[c] += horizontalSumEpi32(_mm256_add_epi32(lo, hi));
+    }
+#endif
+#if defined(__AVX2__)
+    __m256i acc256[Columns];
+    std::fill_n(acc256, Columns, _mm256_setzero_si256());
+#if defined(__AVXVNNI__)
+    __m256i bias256 = _mm256_setzero_si256();
+    const __m256i flip256 = _mm256_set1_epi8(static_cast<char>(0x80));
+#endif
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+#if defined(__AVXVNNI__)
+        bias256 = _mm256_dpbusd_avx_epi32(bias256, flip256, va);
+#else
+        __m256i aLo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        __m256i aHi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+#endif
+        for (size_t c = 0; c < Columns; ++c) {
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b[c] + i));
+#if defined(__AVXVNNI__)
+            acc256[c] = _mm256_dpbusd_avx_epi32(acc256[c], _mm256_xor_si256(vb, flip256), va);
+#else
+            // Each pair sum is at most 2 * 128 * 128, which fits in int32.
+            __m256i bLo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+            __m256i bHi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+            acc256[c] = _mm256_add_epi32(acc256[c], _mm256_madd_epi16(aLo, bLo));
+            acc256[c] = _mm256_add_epi32(acc256[c], _mm256_madd_epi16(aHi, bHi));
+#endif
+        }
+    }
+    for (size_t c = 0; c < Columns; ++c) {
+#if defined(__AVXVNNI__)
+        acc256[c] = _mm256_sub_epi32(acc256[c], bias256);
+#endif
+        result[c] += horizontalSumEpi32(acc256[c]);
+    }
+#endif
+    for (; i < n; ++i) {
+        for (size_t c = 0; c < Columns; ++c) {
+            result[c] += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[c][i]);
+        }
+    }
+    std::copy(result.begin(), result.end(), out);
+}
+
+/**
+ * Sums the elementwise products of two int8 arrays into an int32, see dotInt8Tile.
+ */
+inline int32_t dotInt8(const int8_t *a, const int8_t *b, size_t n)
+{
+    int32_t result;
+    dotInt8Tile<1>(a, {b}, n, &result);
+    return result;
+}
+
+// Rounds x * inverseScale to the nearest integer, adds the zero point and clamps the result to the quantized range.
+inline int8_t quantizeValue(float x, float inverseScale, float zeroPoint)
+{
+    const float bound = static_cast<float>(QuantizedMax);
+    float q = std::nearbyint(x * inverseScale) + zeroPoint;
+    q = q < -bound ? -bound : q;
+    q = q > bound ? bound : q;
+    return static_cast<int8_t>(q);
+}
+
+/**
+ * Sums an int8 array into an int32.
+ */
+inline int32_t sumInt8(const int8_t *a, size_t n)
+{
+    int32_t result = 0;
+    for (size_t i = 0; i < n; ++i) {
+        result += a[i];
+    }
+    return result;
+}
+}
+
+// Batch kernels
+/**
+ * Quantizes floats to int8 as round(x / scale) + zeroPoint, clamped to [-QuantizedMax, QuantizedMax].
+ * @param in The values to quantize.
+ * @param scale The size of one quantization step.
+ * @param zeroPoint The quantized value that represents 0.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void quantize(std::span<const float> in, float scale, int32_t zeroPoint, std::span<int8_t> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    assert(scale > 0.0f && "Quantization scale must be positive.");
+    const float inverse = 1.0f / scale;
+    const float offset = static_cast<float>(zeroPoint);
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = detail::quantizeValue(in[i], inverse, offset);
+    }
+}
+
+/**
+ * Dequantizes int8 values to floats as (q - zeroPoint) * scale.
+ * @param in The values to dequantize.
+ * @param scale The size of one quantization step.
+ * @param zeroPoint The quantized value that represents 0.
+ * @param out The destination, which must be the same size as in.
+ */
+inline void dequantize(std::span<const int8_t> in, float scale, int32_t zeroPoint, std::span<float> out)
+{
+    assert(in.size() == out.size() && "Span size mismatch.");
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = static_cast<float>(static_cast<int32_t>(in[i]) - zeroPoint) * scale;
+    }
+}
+
+/**
+ * Widening int8 dot product. Accumulates in int32, so it never overflows for spans shorter than 2^17 elements.
+ * @param a The first operand.
+ * @param b The second operand, which must be the same size as a.
+ * @return The exact integer dot product.
+ */
+inline int32_t dotInt8(std::span<const int8_t> a, std::span<const int8_t> b)
+{
+    assert(a.size() == b.size() && "Span size mismatch.");
+    return detail::dotInt8(a.data(), b.data(), a.size());
+}
+
+/**
+ * An int8 vector with affine quantization parameters. Element i represents (values[i] - zeroPoint) * scale.
+ * @tparam N The number of elements.
+ */
+template<size_t N>
+class QuantizedVector
+{
+public:
+    Vector<int8_t, N> values;
+    float scale;
+    int32_t zeroPoint;
+
+    constexpr QuantizedVector() : values(), scale(1.0f), zeroPoint(0)
+    {}
+
+    constexpr QuantizedVector(const Vector<int8_t, N> &values, float scale, int32_t zeroPoint = 0)
+            : values(values), scale(scale), zeroPoint(zeroPoint)
+    {}
+
+    /**
+     * Symmetric quantization. Picks the scale that maps the largest magnitude in v to QuantizedMax, with a zero point
+     * of 0.
+     * @param v The vector to quantize.
+     * @return The quantized vector.
+     */
+    static QuantizedVector quantize(const Vector<float, N> &v)
+    {
+        float largest = v.template norm<InfinityNorm>();
+        float scale = largest > 0.0f ? largest / static_cast<float>(QuantizedMax) : 1.0f;
+        return quantize(v, scale, 0);
+    }
+
+    /**
+     * Quantizes a vector with the given parameters.
+     * @param v The vector to quantize.
+     * @param scale The size of one quantization step.
+     * @param zeroPoint The quantized value that represents 0.
+     * @return The quantized vector.
+     */
+    static QuantizedVector quantize(const Vector<float, N> &v, float scale, int32_t zeroPoint)
+    {
+        QuantizedVector result;
+        result.scale = scale;
+        result.zeroPoint = zeroPoint;
+        MathUtils::quantize(v.data, scale, zeroPoint, result.values.data);
+        return result;
+    }
+
+    /**
+     * Dequantize function.
+     * @return The float vector this quantized vector represents.
+     */
+    Vector<float, N> dequantize() const
+    {
+        Vector<float, N> result;
+        MathUtils::dequantize(values.data, scale, zeroPoint, result.data);
+        return result;
+    }
+
+    /**
+     * Dot product function. The products are accumulated exactly in int32 and dequantized once at the end.
+     * @param other The quantized vector to compute the dot product with.
+     * @return The dot product of the represented float vectors.
+     */
+    float dot(const QuantizedVector &other) const
+    {
+        int64_t raw = detail::dotInt8(values.data.data(), other.values.data.data(), N);
+        if (zeroPoint != 0 || other.zeroPoint != 0) {
+            // sum((a - za) * (b - zb)) = sum(a * b) - zb * sum(a) - za * sum(b) + N * za * zb
+            int64_t sumA = detail::sumInt8(values.data.data(), N);
+            int64_t sumB = detail::sumInt8(other.values.data.data(), N);
+            raw += -static_cast<int64_t>(other.zeroPoint) * sumA - static_cast<int64_t>(zeroPoint) * sumB
+                   + static_cast<int64_t>(N) * zeroPoint * other.zeroPoint;
+        }
+        return static_cast<float>(raw) * scale * other.scale;
+    }
+};
+
+}
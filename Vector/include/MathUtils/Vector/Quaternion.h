@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace MathUtils
+{
+
+/**
+ * A quaternion x*i + y*j + z*k + w stored in a Vector<T, 4> as (x, y, z, w). Unit quaternions represent rotations.
+ * @tparam T The floating point element type.
+ */
+template<typename T>
+class Quaternion
+{
+    static_assert(std::is_floating_point_v<T>, "Quaternion's template parameter T must be a floating point type.");
+
+public:
+    Vector<T, 4> coeffs;
+
+    // Constructors
+    // The default quaternion is the identity rotation.
+    constexpr Quaternion() : coeffs(T(0), T(0), T(0), T(1))
+    {}
+
+    constexpr explicit Quaternion(const Vector<T, 4> &coeffs) : coeffs(coeffs)
+    {}
+
+    constexpr Quaternion(const Vector<T, 3> &vec, const T &scalar) : coeffs(vec.x, vec.y, vec.z, scalar)
+    {}
+
+    static constexpr Quaternion identity()
+    {
+        return Quaternion();
+    }
+
+    /**
+     * Creates the rotation of angle radians about an axis, counterclockwise when looking down the axis.
+     * @param axis The unit axis of rotation.
+     * @param angle The angle of rotation in radians.
+     * @return A unit quaternion.
+     */
+    static Quaternion fromAxisAngle(const Vector<T, 3> &axis, const T &angle)
+    {
+        T half = angle / T(2);
+        return Quaternion(axis * std::sin(half), std::cos(half));
+    }
+
+    // accessor methods
+    // The imaginary part (x, y, z).
+    constexpr Vector<T, 3> vec() const
+    {
+        return coeffs.xyz();
+    }
+
+    // The real part w.
+    constexpr T scalar() const
+    {
+        return coeffs.w;
+    }
+
+    // Arithmetic operators
+    constexpr Quaternion operator-() const
+    {
+        return Quaternion(-coeffs);
+    }
+
+    constexpr Quaternion operator+(const Quaternion &other) const
+    {
+        return Quaternion(coeffs + other.coeffs);
+    }
+
+    constexpr Quaternion operator-(const Quaternion &other) const
+    {
+        return Quaternion(coeffs - other.coeffs);
+    }
+
+    constexpr Quaternion operator*(const T &scalar) const
+    {
+        return Quaternion(coeffs * scalar);
+    }
+
+    /**
+     * Hamilton product. Applying the result rotates by other first, then by this.
+     * @param other The right hand side quaternion.
+     * @return The product this * other.
+     */
+    constexpr Quaternion operator*(const Quaternion &other) const
+    {
+        const Vector<T, 4> &a = coeffs;
+        const Vector<T, 4> &b = other.coeffs;
+        return Quaternion(Vector<T, 4>(
+                a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+        ));
+    }
+
+    constexpr Quaternion &operator*=(const Quaternion &other)
+    {
+        return *this = *this * other;
+    }
+
+    constexpr bool operator==(const Quaternion &other) const
+    {
+        return coeffs == other.coeffs;
+    }
+
+    // Quaternion functions
+    constexpr T dot(const Quaternion &other) const
+    {
+        return coeffs.dot(other.coeffs);
+    }
+
+    T length() const
+    {
+        return coeffs.length();
+    }
+
+    constexpr Quaternion conjugate() const
+    {
+        return Quaternion(-vec(), scalar());
+    }
+
+    /**
+     * Inverse function. For unit quaternions this equals the conjugate.
+     * @return The quaternion q such that q * this is the identity.
+     */
+    constexpr Quaternion inverse() const
+    {
+        T squaredLength = coeffs.squaredLength();
+        assert(squaredLength != T(0) && "Cannot invert a zero quaternion.");
+        return Quaternion(conjugate().coeffs / squaredLength);
+    }
+
+    /**
+     * Normalize function. Scales this quaternion to unit length.
+     * @return A reference to this quaternion.
+     */
+    Quaternion &normalize()
+    {
+        T len = length();
+        assert(len != T(0) && "Cannot normalize a zero quaternion.");
+        coeffs /= len;
+        return *this;
+    }
+
+    /**
+     * Normalize function.
+     * @return A unit length copy of this quaternion.
+     */
+    Quaternion normalized() const
+    {
+        Quaternion result = *this;
+        return result.normalize();
+    }
+
+    /**
+     * Rotates a vector by this unit quaternion, using v + w * t + u x t with t = 2 * (u x v) and u the imaginary part.
+     * @param v The vector to rotate.
+     * @return The rotated vector.
+     */
+    constexpr Vector<T, 3> rotate(const Vector<T, 3> &v) const
+    {
+        Vector<T, 3> u = vec();
+        Vector<T, 3> t = u.cross(v) * T(2);
+        return v + t * scalar() + u.cross(t);
+    }
+
+    /**
+     * Converts this unit quaternion to the equivalent rotation matrix, which rotates column vectors.
+     * @return The 3x3 rotation matrix.
+     */
+    constexpr Matrix<T, 3, 3> toMatrix() const
+    {
+        const T x = coeffs.x, y = coeffs.y, z = coeffs.z, w = coeffs.w;
+        return Matrix<T, 3, 3>({
+                {T(1) - T(2) * (y * y + z * z), T(2) * (x * y - z * w), T(2) * (x * z + y * w)},
+                {T(2) * (x * y + z * w), T(1) - T(2) * (x * x + z * z), T(2) * (y * z - x * w)},
+                {T(2) * (x * z - y * w), T(2) * (y * z + x * w), T(1) - T(2) * (x * x + y * y)}
+        });
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Quaternion &q)
+    {
+        return os << q.coeffs;
+    }
+};
+
+// Interpolation
+/**
+ * Normalized linear interpolation. Cheaper than slerp, with a non-constant angular velocity. Takes the shortest path.
+ * @param a The rotation at t = 0.
+ * @param b The rotation at t = 1.
+ * @param t The interpolation parameter in [0, 1].
+ * @return A unit quaternion between a and b.
+ */
+template<typename T>
+Quaternion<T> nlerp(const Quaternion<T> &a, const Quaternion<T> &b, const T &t)
+{
+    Vector<T, 4> target = a.dot(b) < T(0) ? -b.coeffs : b.coeffs;
+    return Quaternion<T>(lerp(a.coeffs, target, t)).normalize();
+}
+
+/**
+ * Spherical linear interpolation. Rotates at a constant angular velocity along the shortest path, falling back to
+ * nlerp when the quaternions are nearly parallel.
+ * @param a The rotation at t = 0.
+ * @param b The rotation at t = 1.
+ * @param t The interpolation parameter in [0, 1].
+ * @return A unit quaternion between a and b.
+ */
+template<typename T>
+Quaternion<T> slerp(const Quaternion<T> &a, const Quaternion<T> &b, const T &t)
+{
+    T cosTheta = a.dot(b);
+    Vector<T, 4> target = b.coeffs;
+    if (cosTheta < T(0)) {
+        cosTheta = -cosTheta;
+        target = -target;
+    }
+    if (cosTheta > T(1) - T(16) * std::numeric_limits<T>::epsilon()) {
+        return nlerp(a, Quaternion<T>(target), t);
+    }
+    T theta = std::acos(cosTheta);
+    T sinTheta = std::sin(theta);
+    T wa = std::sin((T(1) - t) * theta) / sinTheta;
+    T wb = std::sin(t * theta) / sinTheta;
+    return Quaternion<T>(a.coeffs * wa + target * wb);
+}
+
+// Batch kernels
+/**
+ * Rotates every vector by a unit quaternion. Float spans are transposed to structure of arrays 4 vectors at a time and
+ * rotated with SSE2; other types and the remainder use the scalar path.
+ * @param q The unit rotation quaternion.
+ * @param vectors The vectors to rotate in place.
+ */
+template<typename T>
+void rotate(const Quaternion<T> &q, std::span<Vector<T, 3>> vectors)
+{
+    size_t i = 0;
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    if constexpr (std::is_same_v<T, float>) {
+        static_assert(sizeof(Vector<float, 3>) == 3 * sizeof(float), "Vec3 spans are processed as packed floats.");
+        const __m128 ux = _mm_set1_ps(q.coeffs.x);
+        const __m128 uy = _mm_set1_ps(q.coeffs.y);
+        const __m128 uz = _mm_set1_ps(q.coeffs.z);
+        const __m128 uw = _mm_set1_ps(q.coeffs.w);
+        const __m128 two = _mm_set1_ps(2.0f);
+        for (; i + 4 <= vectors.size(); i += 4) {
+            float *address = vectors[i].data.data();
+            __m128 vx, vy, vz;
+            detail::loadVec3Soa(address, vx, vy, vz);
+
+            // t = 2 * (u x v)
+            __m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy)));
+            __m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz)));
+            __m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx)));
+            // v + w * t + u x t
+            vx = _mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(uw, tx)), _mm_sub_ps(_mm_mul_ps(uy, tz), _mm_mul_ps(uz, ty)));
+            vy = _mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(uw, ty)), _mm_sub_ps(_mm_mul_ps(uz, tx), _mm_mul_ps(ux, tz)));
+            vz = _mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(uw, tz)), _mm_sub_ps(_mm_mul_ps(ux, ty), _mm_mul_ps(uy, tx)));
+
+            detail::storeVec3Soa(address, vx, vy, vz);
+        }
+    }
+#endif
+    for (; i < vectors.size(); ++i) {
+        vectors[i] = q.rotate(vectors[i]);
+    }
+}
+
+#ifdef USING_ALL_QUATERNION_TYPES
+    #define USING_FLOATING_QUATERNION_TYPES
+    #define USING_DOUBLE_QUATERNION_TYPES
+#endif
+
+#ifdef USING_FLOATING_QUATERNION_TYPES
+using QuatF = Quaternion<float>;
+#endif
+
+#ifdef USING_DOUBLE_QUATERNION_TYPES
+using QuatD = Quaternion<double>;
+#endif
+
+}
@@ -0,0 +1,615 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace MathUtils
+{
+
+// Storage orders of SparseMatrix.
+enum class SparseStorage : uint8_t
+{
+    // CSR. Each row stores its nonzeros sorted by column. Fastest for products with dense vectors and matrices.
+    CompressedRows,
+    // CSC. Each column stores its nonzeros sorted by row. Fastest for column access and products with the transpose.
+    CompressedColumns
+};
+
+// One nonzero of a sparse matrix in coordinate (COO) form.
+template<typename T>
+struct Triplet
+{
+    size_t row;
+    size_t col;
+    T value;
+};
+
+namespace detail
+{
+/**
+ * Stable sorts items. Each thread sorts one run, then the runs are merged pairwise in parallel. Being stable, the result
+ * does not depend on the thread count.
+ */
+template<typename X, typename Compare>
+void parallelStableSort(std::vector<X> &items, Compare compare)
+{
+    size_t runs = std::min(parallelThreads(items.size()), std::max<size_t>(items.size(), 1));
+    size_t step = (items.size() + runs - 1) / runs;
+    auto bound = [&](size_t run) { return items.begin() + static_cast<ptrdiff_t>(std::min(run * step, items.size())); };
+    parallelRanges(0, runs, items.size(), [&](size_t first, size_t last) {
+        for (size_t run = first; run < last; ++run) {
+            std::stable_sort(bound(run), bound(run + 1), compare);
+        }
+    });
+    for (size_t width = 1; width < runs; width *= 2) {
+        size_t pairs = (runs + 2 * width - 1) / (2 * width);
+        parallelRanges(0, pairs, items.size(), [&](size_t first, size_t last) {
+            for (size_t pair = first; pair < last; ++pair) {
+                size_t left = pair * 2 * width;
+                std::inplace_merge(bound(left), bound(left + width), bound(left + 2 * width), compare);
+            }
+        });
+    }
+}
+
+/**
+ * y[i] = sum(values[k] * x[indices[k]]) over the nonzeros k of the compressed rows i in [rowBegin, rowEnd). Every
+ * nonzero is read once and every y[i] written once, so the kernel moves the minimum number of bytes.
+ */
+template<typename T, typename Index>
+void multiplyRows(const size_t *starts, const Index *indices, const T *values, const T *x, T *y, size_t rowBegin,
+                  size_t rowEnd)
+{
+    for (size_t i = rowBegin; i < rowEnd; ++i) {
+        T sum = T(0);
+        for (size_t k = starts[i]; k < starts[i + 1]; ++k) {
+            sum += values[k] * x[indices[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+/**
+ * Merge-path SpMV (Merrill and Garland). The merge of the row ends with the nonzero indices is cut into parts of equal
+ * length, so each thread gets the same number of rows plus nonzeros however unevenly the nonzeros are spread over the
+ * rows. A row cut by a part boundary is written by the last part it reaches. The partial sums of the earlier parts are
+ * added after the threads join, in part order, so the result depends only on parts.
+ */
+template<typename T, typename Index>
+void mergePathMultiply(const size_t *starts, const Index *indices, const T *values, const T *x, T *y, size_t rows,
+                       size_t parts)
+{
+    size_t nonZeros = starts[rows];
+    size_t length = rows + nonZeros;
+    // The (row, nonzero) at which the merge path crosses the given diagonal.
+    auto split = [&](size_t diagonal) {
+        size_t low = diagonal > nonZeros ? diagonal - nonZeros : 0;
+        size_t high = std::min(diagonal, rows);
+        while (low < high) {
+            size_t pivot = (low + high) / 2;
+            if (starts[pivot + 1] <= diagonal - pivot - 1) {
+                low = pivot + 1;
+            } else {
+                high = pivot;
+            }
+        }
+        return std::pair<size_t, size_t>(low, diagonal - low);
+    };
+
+    // The row each part ends inside of and its partial sum of that row.
+    std::vector<std::pair<size_t, T>> carries(parts);
+    auto run = [&](size_t part) {
+        auto [row, k] = split(length * part / parts);
+        auto [rowEnd, kEnd] = split(length * (part + 1) / parts);
+        for (; row < rowEnd; ++row) {
+            T sum = T(0);
+            for (; k < starts[row + 1]; ++k) {
+                sum += values[k] * x[indices[k]];
+            }
+            y[row] = sum;
+        }
+        T sum = T(0);
+        for (; k < kEnd; ++k) {
+            sum += values[k] * x[indices[k]];
+        }
+        carries[part] = {rowEnd, sum};
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for (size_t part = 1; part < parts; ++part) {
+        workers.emplace_back(run, part);
+    }
+    run(0);
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    for (size_t part = 0; part + 1 < parts; ++part) {
+        if (carries[part].first < rows) {
+            y[carries[part].first] += carries[part].second;
+        }
+    }
+}
+}
+
+/**
+ * A sparse matrix with sizes chosen at runtime, stored in compressed rows (CSR) or compressed columns (CSC). Only the
+ * nonzeros are stored: for each outer index (a row for CSR, a column for CSC) a range of inner indices sorted in
+ * increasing order and their values. Inner indices are 32 bit, so a product streams sizeof(T) + 4 bytes per nonzero.
+ * @tparam T The element type.
+ * @tparam S The storage order.
+ */
+template<typename T, SparseStorage S = SparseStorage::CompressedRows>
+class SparseMatrix
+{
+    static_assert(std::is_arithmetic_v<T>, "SparseMatrix's template parameter T must be a numerical type.");
+
+public:
+    using Index = uint32_t;
+
+private:
+    static constexpr bool rowMajor = S == SparseStorage::CompressedRows;
+
+    size_t rowCount;
+    size_t colCount;
+    // outerSize() + 1 offsets into innerIndices and nonZeroValues. Outer index o owns [starts[o], starts[o + 1]).
+    std::vector<size_t> starts;
+    std::vector<Index> innerIndices;
+    std::vector<T> nonZeroValues;
+
+public:
+    // Constructors
+    // The 0 x 0 matrix.
+    SparseMatrix() : rowCount(0), colCount(0), starts(1, 0)
+    {}
+
+    // A rows x cols matrix of zeros.
+    SparseMatrix(size_t rows, size_t cols) : rowCount(rows), colCount(cols), starts((rowMajor ? rows : cols) + 1, 0)
+    {
+        assert(innerSize() <= std::numeric_limits<Index>::max() && "SparseMatrix inner dimension is too large.");
+    }
+
+    /**
+     * Takes ownership of already compressed arrays.
+     * @param rows The number of rows.
+     * @param cols The number of columns.
+     * @param starts The outerSize() + 1 offsets of each outer index's range in indices and values, starting at 0.
+     * @param indices The inner index of each nonzero, sorted increasingly within each outer index.
+     * @param values The value of each nonzero.
+     */
+    SparseMatrix(size_t rows, size_t cols, std::vector<size_t> starts, std::vector<Index> indices,
+                 std::vector<T> values)
+            : rowCount(rows), colCount(cols), starts(std::move(starts)), innerIndices(std::move(indices)),
+              nonZeroValues(std::move(values))
+    {
+        assert(innerSize() <= std::numeric_limits<Index>::max() && "SparseMatrix inner dimension is too large.");
+        assert(isCompressed() && "Invalid compressed sparse arrays.");
+    }
+
+    /**
+     * Builds a matrix from unordered coordinate triplets. Duplicate coordinates are summed in the order they appear in
+     * triplets, so the result is deterministic. Large inputs are sorted in parallel.
+     * @param rows The number of rows.
+     * @param cols The number of columns.
+     * @param triplets The nonzeros.
+     * @return The compressed matrix.
+     */
+    static SparseMatrix fromTriplets(size_t rows, size_t cols, std::span<const Triplet<T>> triplets)
+    {
+        auto outerOf = [](const Triplet<T> &t) { return rowMajor ? t.row : t.col; };
+        auto innerOf = [](const Triplet<T> &t) { return rowMajor ? t.col : t.row; };
+        std::vector<Triplet<T>> sorted(triplets.begin(), triplets.end());
+        detail::parallelStableSort(sorted, [&](const Triplet<T> &a, const Triplet<T> &b) {
+            return outerOf(a) < outerOf(b) || (outerOf(a) == outerOf(b) && innerOf(a) < innerOf(b));
+        });
+
+        SparseMatrix result(rows, cols);
+        result.innerIndices.reserve(sorted.size());
+        result.nonZeroValues.reserve(sorted.size());
+        size_t lastOuter = 0;
+        for (const Triplet<T> &t: sorted) {
+            assert(t.row < rows && t.col < cols && "Triplet index out of bounds.");
+            size_t outer = outerOf(t);
+            Index inner = static_cast<Index>(innerOf(t));
+            if (!result.innerIndices.empty() && outer == lastOuter && result.innerIndices.back() == inner) {
+                result.nonZeroValues.back() += t.value;
+                continue;
+            }
+            result.innerIndices.push_back(inner);
+            result.nonZeroValues.push_back(t.value);
+            ++result.starts[outer + 1];
+            lastOuter = outer;
+        }
+        std::partial_sum(result.starts.begin(), result.starts.end(), result.starts.begin());
+        return result;
+    }
+
+    // Stores the nonzero elements of a dense matrix.
+    template<size_t N, size_t M>
+    static SparseMatrix fromDense(const Matrix<T, N, M> &dense)
+    {
+        SparseMatrix result(N, M);
+        for (size_t outer = 0; outer < result.outerSize(); ++outer) {
+            for (size_t inner = 0; inner < result.innerSize(); ++inner) {
+                const T &value = rowMajor ? dense(outer, inner) : dense(inner, outer);
+                if (value != T(0)) {
+                    result.innerIndices.push_back(static_cast<Index>(inner));
+                    result.nonZeroValues.push_back(value);
+                }
+            }
+            result.starts[outer + 1] = result.innerIndices.size();
+        }
+        return result;
+    }
+
+    // The dense matrix with the same elements. N and M must equal rows() and cols().
+    template<size_t N, size_t M>
+    Matrix<T, N, M> toDense() const
+    {
+        assert(N == rowCount && M == colCount && "Matrix dimension mismatch.");
+        Matrix<T, N, M> result;
+        forEachNonZero([&](size_t row, size_t col, const T &value) { result(row, col) = value; });
+        return result;
+    }
+
+    // accessor methods
+    [[nodiscard]] size_t rows() const
+    { return rowCount; }
+
+    [[nodiscard]] size_t cols() const
+    { return colCount; }
+
+    [[nodiscard]] size_t nonZeros() const
+    { return nonZeroValues.size(); }
+
+    // The number of rows for CSR, columns for CSC.
+    [[nodiscard]] size_t outerSize() const
+    { return rowMajor ? rowCount : colCount; }
+
+    // The number of columns for CSR, rows for CSC.
+    [[nodiscard]] size_t innerSize() const
+    { return rowMajor ? colCount : rowCount; }
+
+    std::span<const size_t> outerStarts() const
+    { return starts; }
+
+    std::span<const Index> indices() const
+    { return innerIndices; }
+
+    std::span<const T> values() const
+    { return nonZeroValues; }
+
+    // The values may be changed in place, the sparsity pattern may not.
+    std::span<T> values()
+    { return nonZeroValues; }
+
+    // The element at (row, col), 0 if it is not stored. Binary searches the row (CSR) or column (CSC).
+    T operator()(size_t row, size_t col) const
+    {
+        assert(row < rowCount && col < colCount && "SparseMatrix index out of bounds.");
+        size_t outer = rowMajor ? row : col;
+        Index inner = static_cast<Index>(rowMajor ? col : row);
+        auto first = innerIndices.begin() + static_cast<ptrdiff_t>(starts[outer]);
+        auto last = innerIndices.begin() + static_cast<ptrdiff_t>(starts[outer + 1]);
+        auto found = std::lower_bound(first, last, inner);
+        return found != last && *found == inner ? nonZeroValues[found - innerIndices.begin()] : T(0);
+    }
+
+    // Calls f(row, col, value) for every stored element, in storage order.
+    template<typename F>
+    void forEachNonZero(F &&f) const
+    {
+        for (size_t outer = 0; outer < outerSize(); ++outer) {
+            for (size_t k = starts[outer]; k < starts[outer + 1]; ++k) {
+                if constexpr (rowMajor) {
+                    f(outer, static_cast<size_t>(innerIndices[k]), nonZeroValues[k]);
+                } else {
+                    f(static_cast<size_t>(innerIndices[k]), outer, nonZeroValues[k]);
+                }
+            }
+        }
+    }
+
+    // The transpose, in the same storage order. Costs one counting sort pass over the nonzeros.
+    SparseMatrix transpose() const
+    {
+        return transposed<S>(colCount, rowCount);
+    }
+
+    // The same matrix in storage order To. Converting between CSR and CSC costs the same as a transpose.
+    template<SparseStorage To>
+    SparseMatrix<T, To> toStorage() const
+    {
+        if constexpr (To == S) {
+            return *this;
+        } else {
+            return transposed<To>(rowCount, colCount);
+        }
+    }
+
+    /**
+     * Sparse matrix-vector product y = A x. For CSR, products of at least MATHUTILS_MATRIX_PARALLEL_THRESHOLD rows plus
+     * nonzeros are split across threads by multiplyMergePath.
+     * @param x The cols() elements of the vector to multiply.
+     * @param y The rows() elements of the result. Must not overlap x.
+     */
+    void multiply(std::span<const T> x, std::span<T> y) const
+    {
+        assert(x.size() == colCount && y.size() == rowCount && "Span size mismatch.");
+        if constexpr (rowMajor) {
+            size_t threads = detail::parallelThreads(nonZeros() + rowCount);
+            if (threads > 1) {
+                multiplyMergePath(x, y, threads);
+            } else {
+                detail::multiplyRows(starts.data(), innerIndices.data(), nonZeroValues.data(), x.data(), y.data(), 0,
+                                     rowCount);
+            }
+        } else {
+            std::fill(y.begin(), y.end(), T(0));
+            for (size_t j = 0; j < colCount; ++j) {
+                T xj = x[j];
+                for (size_t k = starts[j]; k < starts[j + 1]; ++k) {
+                    y[innerIndices[k]] += nonZeroValues[k] * xj;
+                }
+            }
+        }
+    }
+
+    /**
+     * Sparse matrix-vector product y = A x on parts threads, each given an equal share of rows plus nonzeros. A few
+     * huge rows do not leave the other threads idle, unlike splitting by rows. The result is deterministic for a given
+     * number of parts, but may round differently than the serial product.
+     * @param x The cols() elements of the vector to multiply.
+     * @param y The rows() elements of the result. Must not overlap x.
+     * @param parts The number of threads to use, including the calling thread.
+     */
+    void multiplyMergePath(std::span<const T> x, std::span<T> y, size_t parts) const requires (rowMajor)
+    {
+        assert(x.size() == colCount && y.size() == rowCount && "Span size mismatch.");
+        assert(parts > 0 && "Merge path needs at least one part.");
+        detail::mergePathMultiply(starts.data(), innerIndices.data(), nonZeroValues.data(), x.data(), y.data(),
+                                  rowCount, std::min(parts, rowCount + nonZeros() + 1));
+    }
+
+    // y = A x for fixed size vectors. N and M must equal rows() and cols().
+    template<size_t N, size_t M>
+    void multiply(const Vector<T, M> &x, Vector<T, N> &y) const
+    {
+        multiply(std::span<const T>(x.data), std::span<T>(y.data));
+    }
+
+    /**
+     * Sparse times dense matrix product C = A B with B and C stored row-major.
+     * @param b The cols() x p elements of B.
+     * @param p The number of columns of B and C.
+     * @param c The rows() x p elements of C. Must not overlap b.
+     */
+    void multiply(std::span<const T> b, size_t p, std::span<T> c) const
+    {
+        assert(b.size() == colCount * p && c.size() == rowCount * p && "Span size mismatch.");
+        if constexpr (rowMajor) {
+            for (size_t i = 0; i < rowCount; ++i) {
+                T *ci = c.data() + i * p;
+                std::fill(ci, ci + p, T(0));
+                for (size_t k = starts[i]; k < starts[i + 1]; ++k) {
+                    const T *bj = b.data() + innerIndices[k] * p;
+                    T value = nonZeroValues[k];
+                    for (size_t col = 0; col < p; ++col) {
+                        ci[col] += value * bj[col];
+                    }
+                }
+            }
+        } else {
+            std::fill(c.begin(), c.end(), T(0));
+            for (size_t j = 0; j < colCount; ++j) {
+                const T *bj = b.data() + j * p;
+                for (size_t k = starts[j]; k < starts[j + 1]; ++k) {
+                    T *ci = c.data() + innerIndices[k] * p;
+                    T value = nonZeroValues[k];
+                    for (size_t col = 0; col < p; ++col) {
+                        ci[col] += value * bj[col];
+                    }
+                }
+            }
+        }
+    }
+
+    // C = A B for fixed size matrices. N and M must equal rows() and cols(). Each row of C is a Vector update.
+    template<size_t N, size_t M, size_t P>
+    void multiply(const Matrix<T, M, P> &b, Matrix<T, N, P> &c) const
+    {
+        assert(N == rowCount && M == colCount && "Matrix dimension mismatch.");
+        for (size_t i = 0; i < N; ++i) {
+            c[i] = Vector<T, P>(T(0));
+        }
+        forEachNonZero([&](size_t row, size_t col, const T &value) { c[row] += b[col] * value; });
+    }
+
+private:
+    /**
+     * Counting sorts the nonzeros by inner index. The arrays that come out store the transpose in this storage order,
+     * which is also this matrix in the other storage order.
+     */
+    template<SparseStorage To>
+    SparseMatrix<T, To> transposed(size_t rows, size_t cols) const
+    {
+        std::vector<size_t> outStarts(innerSize() + 1, 0);
+        std::vector<typename SparseMatrix<T, To>::Index> outIndices(nonZeros());
+        std::vector<T> outValues(nonZeros());
+        for (Index inner: innerIndices) {
+            ++outStarts[inner + 1];
+        }
+        std::partial_sum(outStarts.begin(), outStarts.end(), outStarts.begin());
+        std::vector<size_t> next(outStarts.begin(), outStarts.end() - 1);
+        for (size_t outer = 0; outer < outerSize(); ++outer) {
+            for (size_t k = starts[outer]; k < starts[outer + 1]; ++k) {
+                size_t slot = next[innerIndices[k]]++;
+                outIndices[slot] = static_cast<Index>(outer);
+                outValues[slot] = nonZeroValues[k];
+            }
+        }
+        return SparseMatrix<T, To>(rows, cols, std::move(outStarts), std::move(outIndices), std::move(outValues));
+    }
+
+    // Whether the arrays are consistent and every outer index's inner indices are increasing and in range.
+    bool isCompressed() const
+    {
+        if (starts.size() != outerSize() + 1 || starts.front() != 0 || starts.back() != innerIndices.size()
+            || innerIndices.size() != nonZeroValues.size()) {
+            return false;
+        }
+        for (size_t outer = 0; outer < outerSize(); ++outer) {
+            if (starts[outer] > starts[outer + 1]) {
+                return false;
+            }
+            for (size_t k = starts[outer]; k < starts[outer + 1]; ++k) {
+                if (innerIndices[k] >= innerSize() || (k > starts[outer] && innerIndices[k] <= innerIndices[k - 1])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * A read-only sparse matrix in SELL-C-σ format for SIMD products. Rows are grouped into slices of C = simdLanes<T> rows
+ * and each slice is padded to its longest row and stored column by column, so one SIMD step multiplies one nonzero of C
+ * rows. To keep the padding small, rows are sorted by length within windows of sigma rows before being sliced. Padding
+ * is never multiplied, so infinite or NaN elements of x only reach the rows that reference them.
+ * @tparam T The element type.
+ */
+template<typename T>
+class SlicedEllpackMatrix
+{
+public:
+    using Index = uint32_t;
+
+    // The number of rows in a slice.
+    static constexpr size_t sliceRows = detail::simdLanes<T>;
+
+private:
+    size_t rowCount;
+    size_t colCount;
+    // The original row of each sorted row.
+    std::vector<Index> rowOrder;
+    // The number of nonzeros of each sorted row.
+    std::vector<Index> rowLengths;
+    // sliceCount + 1 offsets into columns and paddedValues. Element j of lane l in slice s is at sliceStarts[s] + j * C + l.
+    std::vector<size_t> sliceStarts;
+    std::vector<Index> columns;
+    std::vector<T> paddedValues;
+
+public:
+    /**
+     * Converts a CSR matrix.
+     * @param csr The matrix to convert.
+     * @param sigma The number of rows sorted by length together. Rounded up to a multiple of sliceRows. Larger windows
+     * need less padding, smaller ones keep the accesses to x closer to the original row order.
+     */
+    explicit SlicedEllpackMatrix(const SparseMatrix<T> &csr, size_t sigma = 32 * sliceRows)
+            : rowCount(csr.rows()), colCount(csr.cols()), rowOrder(csr.rows()), rowLengths(csr.rows())
+    {
+        constexpr size_t C = sliceRows;
+        std::span<const size_t> starts = csr.outerStarts();
+        auto length = [&](Index row) { return starts[row + 1] - starts[row]; };
+        sigma = std::max<size_t>((sigma + C - 1) / C * C, C);
+        std::iota(rowOrder.begin(), rowOrder.end(), Index(0));
+        for (size_t window = 0; window < rowCount; window += sigma) {
+            auto first = rowOrder.begin() + static_cast<ptrdiff_t>(window);
+            auto last = rowOrder.begin() + static_cast<ptrdiff_t>(std::min(window + sigma, rowCount));
+            std::stable_sort(first, last, [&](Index a, Index b) { return length(a) > length(b); });
+        }
+
+        for (size_t sorted = 0; sorted < rowCount; ++sorted) {
+            rowLengths[sorted] = static_cast<Index>(length(rowOrder[sorted]));
+        }
+        size_t slices = (rowCount + C - 1) / C;
+        sliceStarts.resize(slices + 1, 0);
+        for (size_t slice = 0; slice < slices; ++slice) {
+            // Rows are sorted by decreasing length within a window, and windows start on a slice boundary.
+            sliceStarts[slice + 1] = sliceStarts[slice] + length(rowOrder[slice * C]) * C;
+        }
+        columns.assign(sliceStarts.back(), Index(0));
+        paddedValues.assign(sliceStarts.back(), T(0));
+        for (size_t sorted = 0; sorted < rowCount; ++sorted) {
+            Index row = rowOrder[sorted];
+            size_t offset = sliceStarts[sorted / C] + sorted % C;
+            for (size_t k = starts[row], j = 0; k < starts[row + 1]; ++k, ++j) {
+                columns[offset + j * C] = csr.indices()[k];
+                paddedValues[offset + j * C] = csr.values()[k];
+            }
+        }
+    }
+
+    // accessor methods
+    [[nodiscard]] size_t rows() const
+    { return rowCount; }
+
+    [[nodiscard]] size_t cols() const
+    { return colCount; }
+
+    // The number of stored elements, including padding.
+    [[nodiscard]] size_t storedElements() const
+    { return paddedValues.size(); }
+
+    /**
+     * Sparse matrix-vector product y = A x. Slices are split across threads when the stored elements reach
+     * MATHUTILS_MATRIX_PARALLEL_THRESHOLD.
+     * @param x The cols() elements of the vector to multiply.
+     * @param y The rows() elements of the result. Must not overlap x.
+     */
+    void multiply(std::span<const T> x, std::span<T> y) const
+    {
+        assert(x.size() == colCount && y.size() == rowCount && "Span size mismatch.");
+        constexpr size_t C = sliceRows;
+        detail::parallelRanges(0, sliceStarts.size() - 1, storedElements(), [&](size_t first, size_t last) {
+            for (size_t slice = first; slice < last; ++slice) {
+                T sum[C] = {};
+                // Rows are sorted by decreasing length, so up to the length of the slice's last row every lane holds a
+                // nonzero. Past it the rows that still have nonzeros are a shrinking prefix of the lanes.
+                size_t lastRow = std::min(slice * C + C, rowCount) - 1;
+                size_t full = sliceStarts[slice] + rowLengths[lastRow] * C;
+                for (size_t k = sliceStarts[slice]; k < full; k += C) {
+                    for (size_t lane = 0; lane < C; ++lane) {
+                        sum[lane] += paddedValues[k + lane] * x[columns[k + lane]];
+                    }
+                }
+                for (size_t k = full, j = rowLengths[lastRow]; k < sliceStarts[slice + 1]; k += C, ++j) {
+                    for (size_t lane = 0; slice * C + lane < lastRow && j < rowLengths[slice * C + lane]; ++lane) {
+                        sum[lane] += paddedValues[k + lane] * x[columns[k + lane]];
+                    }
+                }
+                for (size_t lane = 0; lane < C && slice * C + lane < rowCount; ++lane) {
+                    y[rowOrder[slice * C + lane]] = sum[lane];
+                }
+            }
+        });
+    }
+};
+
+#ifdef USING_ALL_SPARSE_TYPES
+    #define USING_FLOATING_SPARSE_TYPES
+    #define USING_DOUBLE_SPARSE_TYPES
+#endif
+
+#ifdef USING_FLOATING_SPARSE_TYPES
+using SparseMatrixF = SparseMatrix<float>;
+using SparseMatrixCscF = SparseMatrix<float, SparseStorage::CompressedColumns>;
+#endif
+
+#ifdef USING_DOUBLE_SPARSE_TYPES
+using SparseMatrixD = SparseMatrix<double>;
+using SparseMatrixCscD = SparseMatrix<double, SparseStorage::CompressedColumns>;
+#endif
+
+}
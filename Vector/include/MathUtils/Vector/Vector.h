@@ -1,9 +1,14 @@
 #pragma once
 
 #include <cstdlib>
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <span>
+#include <type_traits>
 
 // Define this macro to try to force the compiler to unroll the for loops.
 #ifndef MATHUTILS_VECTOR_FORCE_FOR_LOOP_UNROLL
@@ -20,11 +25,525 @@
     #endif
 #endif
 
+// Vectors with more elements than this are processed in SIMD-width chunks instead of being fully unrolled.
+#ifndef MATHUTILS_VECTOR_CHUNK_THRESHOLD
+    #define MATHUTILS_VECTOR_CHUNK_THRESHOLD 16
+#endif
+
+// Width in bytes of the SIMD registers the chunked loops are sized for.
+#ifndef MATHUTILS_VECTOR_SIMD_BYTES
+    #if defined(__AVX512F__)
+        #define MATHUTILS_VECTOR_SIMD_BYTES 64
+    #elif defined(__AVX__)
+        #define MATHUTILS_VECTOR_SIMD_BYTES 32
+    #else
+        #define MATHUTILS_VECTOR_SIMD_BYTES 16
+    #endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MATHUTILS_VECTOR_HAS_SSE2
+    #include <immintrin.h>
+#endif
+
 namespace MathUtils
 {
 
+// Summation orders for the floating point reductions of Vector.
+enum class Summation : uint8_t
+{
+    // Fastest order for the target. Large vectors are summed in SIMD lanes whose count depends on the target.
+    Fast,
+    // A fixed lane count and tree order, so results are bit-identical across targets and build flags.
+    Deterministic,
+    // Recursive pairwise summation. The error grows with log(N) instead of N.
+    Pairwise,
+    // Kahan compensated summation, run in independent SIMD lanes.
+    Kahan,
+    // Neumaier's variant of Kahan summation, which also stays accurate when a term is larger than the running sum.
+    Neumaier,
+    // Accumulates in a wider floating point type (float in double, double in long double) and rounds once at the end.
+    Widened
+};
+
 namespace detail
 {
+// 8 and 16 bit integers accumulate in 32 bits of the same signedness, every other type accumulates in itself.
+template<typename T>
+using DefaultAccumulator = std::conditional_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) < 4),
+                                              std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>, T>;
+}
+
+/**
+ * Describes how Vector stores and computes with an element type. Specialize it to allow storage-only element types
+ * such as the half precision types in Half.h.
+ * @tparam T The element type.
+ */
+template<typename T>
+struct ElementTraits
+{
+    // Whether T may be used as the element type of a Vector.
+    static constexpr bool isElement = std::is_arithmetic_v<T>;
+
+    // The type dot products, sums, products and matrix products over T are accumulated in and returned as. Narrow
+    // integers widen so these do not overflow.
+    using Accumulator = detail::DefaultAccumulator<T>;
+};
+
+// Pass as the P parameter of Vector::norm to get the maximum norm.
+inline constexpr size_t InfinityNorm = static_cast<size_t>(-1);
+
+namespace detail
+{
+// Number of elements of type T that fit in one SIMD register.
+template<typename T>
+inline constexpr size_t simdLanes = (MATHUTILS_VECTOR_SIMD_BYTES / sizeof(T)) > 0 ? (MATHUTILS_VECTOR_SIMD_BYTES / sizeof(T)) : 1;
+
+// Number of independent accumulators used by chunked reductions to hide the latency of the add/FMA chain.
+inline constexpr size_t reductionAccumulators = 4;
+
+template<size_t N>
+inline constexpr bool useChunkedLoop = (N > MATHUTILS_VECTOR_CHUNK_THRESHOLD);
+
+// Calls f(i) for every index i in [0, n) in SIMD-width chunks. The kernel of the large fixed size and the dynamic size
+// vectors.
+template<typename T, typename F>
+constexpr void forEachIndex(size_t n, F &&f)
+{
+    constexpr size_t W = simdLanes<T>;
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        for (size_t j = 0; j < W; ++j) {
+            f(i + j);
+        }
+    }
+    for (; i < n; ++i) {
+        f(i);
+    }
+}
+
+/**
+ * Calls f(i) for every index i in [0, N). Small sizes keep the plain (optionally unrolled) loop, larger sizes are
+ * strip-mined into SIMD-width chunks so the compiler emits one vectorized body plus a scalar tail.
+ * @tparam T The element type, used to pick the chunk width.
+ * @tparam N The number of indices to visit.
+ * @param f The function to call with each index.
+ */
+template<typename T, size_t N, typename F>
+constexpr void forEachIndex(F &&f)
+{
+    if constexpr (!useChunkedLoop<N>) {
+        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
+        for (size_t i = 0; i < N; ++i) {
+            f(i);
+        }
+    } else {
+        forEachIndex<T>(N, f);
+    }
+}
+
+
+// Combines the accumulators of a chunked reduction with a tree reduction.
+template<typename T, size_t Lanes, typename Op>
+constexpr T combineLanes(std::array<T, Lanes> &acc, Op &&op)
+{
+    for (size_t live = Lanes; live > 1;) {
+        size_t half = live / 2;
+        for (size_t j = 0; j < half; ++j) {
+            acc[j] = op(acc[j], acc[j + live - half]);
+        }
+        live -= half;
+    }
+    return acc[0];
+}
+
+/**
+ * Reduces f(i) over [0, n) with op using Lanes independent accumulators, which are then combined with a tree reduction.
+ * Every accumulator starts at init, so init must be an identity of op (or idempotent under it, as for min and max).
+ * @tparam T The accumulator type.
+ * @tparam Lanes The number of independent accumulators.
+ * @param n The number of terms.
+ * @param init The initial value of every accumulator.
+ * @param f The function returning the i-th term.
+ * @param op The associative binary reduction.
+ * @return The reduction of all terms.
+ */
+template<typename T, size_t Lanes, typename F, typename Op>
+constexpr T chunkedReduce(size_t n, const T &init, F &&f, Op &&op)
+{
+    std::array<T, Lanes> acc;
+    acc.fill(init);
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j) {
+            acc[j] = op(acc[j], f(i + j));
+        }
+    }
+    for (size_t j = 0; i + j < n; ++j) {
+        acc[j] = op(acc[j], f(i + j));
+    }
+    return combineLanes(acc, op);
+}
+
+// chunkedReduce over the N terms of a fixed size vector.
+template<typename T, size_t N, size_t Lanes, typename F, typename Op>
+constexpr T chunkedReduce(const T &init, F &&f, Op &&op)
+{
+    return chunkedReduce<T, Lanes>(N, init, f, op);
+}
+
+// Lane count of the fastest reduction for T on the current target.
+template<typename T>
+inline constexpr size_t fastReductionLanes = simdLanes<T> * reductionAccumulators;
+
+// Lane count used by the default reductions: serial for small vectors, SIMD-width accumulators for large ones.
+template<typename T, size_t N>
+inline constexpr size_t reductionLanes = useChunkedLoop<N> ? fastReductionLanes<T> : 1;
+
+// Lane count of the deterministic reduction. Fixed so the summation order does not depend on the target or on
+// MATHUTILS_VECTOR_CHUNK_THRESHOLD.
+inline constexpr size_t deterministicReductionLanes = 16;
+
+/**
+ * Finds the index of the element of data that is preferred by better, using one candidate per SIMD lane. Ties are
+ * resolved towards the smallest index.
+ * @param data The elements to search.
+ * @param better Returns true if its first argument should replace its second.
+ * @return The index of the preferred element.
+ */
+template<size_t Lanes, typename T, typename Better>
+constexpr size_t chunkedArgBest(const T *data, size_t n, Better &&better)
+{
+    std::array<T, Lanes> best;
+    std::array<size_t, Lanes> index{};
+    best.fill(data[0]);
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j) {
+            bool take = better(data[i + j], best[j]);
+            best[j] = take ? data[i + j] : best[j];
+            index[j] = take ? i + j : index[j];
+        }
+    }
+    for (size_t j = 0; i + j < n; ++j) {
+        bool take = better(data[i + j], best[j]);
+        best[j] = take ? data[i + j] : best[j];
+        index[j] = take ? i + j : index[j];
+    }
+    size_t result = 0;
+    for (size_t j = 1; j < Lanes; ++j) {
+        bool take = better(best[j], best[result]) || (!better(best[result], best[j]) && index[j] < index[result]);
+        result = take ? j : result;
+    }
+    return index[result];
+}
+
+template<typename T, size_t N, typename Better>
+constexpr size_t chunkedArgBest(const std::array<T, N> &data, Better &&better)
+{
+    return chunkedArgBest<useChunkedLoop<N> ? simdLanes<T> : 1>(data.data(), N, better);
+}
+
+// Accumulator type used by Summation::Widened.
+template<typename T>
+using WidenedFloat = std::conditional_t<std::is_same_v<T, float>, double, long double>;
+
+// The type a reduction over T accumulates in under summation order S.
+template<typename T, Summation S, typename Accumulator = typename ElementTraits<T>::Accumulator>
+using SummationType = std::conditional_t<S == Summation::Widened && std::is_floating_point_v<Accumulator>,
+                                         WidenedFloat<Accumulator>, Accumulator>;
+
+// Number of terms summed serially at the leaves of a pairwise summation.
+inline constexpr size_t pairwiseBlock = 32;
+
+/**
+ * Sums f(i) over [begin, end) by recursively splitting the range in half.
+ */
+template<typename T, typename F>
+constexpr T pairwiseSum(F &f, size_t begin, size_t end)
+{
+    if (end - begin <= pairwiseBlock) {
+        T result = T();
+        for (size_t i = begin; i < end; ++i) {
+            result += f(i);
+        }
+        return result;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    return pairwiseSum<T>(f, begin, mid) + pairwiseSum<T>(f, mid, end);
+}
+
+/**
+ * Sums f(i) over [0, n) with Kahan or Neumaier compensation. Each of the Lanes lanes keeps its own running sum and
+ * compensation, and the lanes are merged with Neumaier's algorithm at the end.
+ * @tparam Neumaier Selects Neumaier's variant instead of classic Kahan summation.
+ */
+template<typename T, size_t Lanes, bool Neumaier, typename F>
+constexpr T compensatedSum(size_t n, F &&f)
+{
+    std::array<T, Lanes> sum{};
+    std::array<T, Lanes> compensation{};
+    auto magnitude = [](const T &v) { return v < T() ? -v : v; };
+    auto add = [&](size_t j, const T &value) {
+        if constexpr (Neumaier) {
+            T t = sum[j] + value;
+            compensation[j] += magnitude(sum[j]) >= magnitude(value) ? (sum[j] - t) + value : (value - t) + sum[j];
+            sum[j] = t;
+        } else {
+            T y = value - compensation[j];
+            T t = sum[j] + y;
+            compensation[j] = (t - sum[j]) - y;
+            sum[j] = t;
+        }
+    };
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j) {
+            add(j, f(i + j));
+        }
+    }
+    for (size_t j = 0; i + j < n; ++j) {
+        add(j, f(i + j));
+    }
+
+    // Kahan keeps the negated error, Neumaier the error itself.
+    T total = T();
+    T correction = T();
+    for (size_t j = 0; j < Lanes; ++j) {
+        T t = total + sum[j];
+        correction += magnitude(total) >= magnitude(sum[j]) ? (total - t) + sum[j] : (sum[j] - t) + total;
+        total = t;
+        correction += Neumaier ? compensation[j] : -compensation[j];
+    }
+    return total + correction;
+}
+
+/**
+ * Sums f(i) over [0, n) in the order selected by S. Integer types are exact in any order and always take the fast
+ * path. Summation::Widened expects f to already return the widened type.
+ * @tparam Lanes The number of accumulators of the fast and compensated orders.
+ */
+template<typename T, Summation S, size_t Lanes, typename F>
+constexpr T accumulate(size_t n, F &&f)
+{
+    auto add = [](const T &a, const T &b) { return static_cast<T>(a + b); };
+    if constexpr (!std::is_floating_point_v<T> || S == Summation::Fast || S == Summation::Widened) {
+        return chunkedReduce<T, Lanes>(n, T(), f, add);
+    } else if constexpr (S == Summation::Deterministic) {
+        return chunkedReduce<T, deterministicReductionLanes>(n, T(), f, add);
+    } else if constexpr (S == Summation::Pairwise) {
+        return pairwiseSum<T>(f, 0, n);
+    } else {
+        return compensatedSum<T, Lanes, S == Summation::Neumaier>(n, f);
+    }
+}
+
+// accumulate over the N terms of a fixed size vector. Small vectors sum serially.
+template<typename T, size_t N, Summation S, typename F>
+constexpr T accumulate(F &&f)
+{
+    return accumulate<T, S, reductionLanes<T, N>>(N, f);
+}
+
+// Element types whose ElementTraits convert a whole array to the accumulator type at once, with
+// widen(const T *in, size_t count, Accumulator *out).
+template<typename T>
+concept BlockWidened = requires(const T *in, typename ElementTraits<T>::Accumulator *out) {
+    ElementTraits<T>::widen(in, size_t(), out);
+};
+
+// Whether reductions over T in summation order S widen blocks of elements instead of one element at a time. The
+// compensated and pairwise orders keep the element path.
+template<typename T, Summation S>
+inline constexpr bool widensInBlocks = BlockWidened<T> &&
+                                       (S == Summation::Fast || S == Summation::Deterministic ||
+                                        S == Summation::Widened);
+
+// Elements widened at a time into stack buffers. A multiple of every reduction lane count.
+inline constexpr size_t widenBlockSize = 256;
+
+/**
+ * accumulate for BlockWidened element types. Blocks of each input are widened into buffers and the terms are summed
+ * from those by the same accumulators accumulate uses, so the result is identical to summing element by element.
+ * @param inputs The element arrays, each holding n elements.
+ * @param term Returns the term of element j of the current block, given the array of widened buffers.
+ */
+template<typename Acc, Summation S, size_t Lanes, typename T, size_t K, typename F>
+Acc widenedAccumulate(size_t n, const std::array<const T *, K> &inputs, F &&term)
+{
+    constexpr size_t L = S == Summation::Deterministic ? deterministicReductionLanes : Lanes;
+    static_assert(widenBlockSize % L == 0, "Widened blocks must hold a whole number of accumulator rows.");
+    std::array<std::array<typename ElementTraits<T>::Accumulator, widenBlockSize>, K> wide;
+    std::array<Acc, L> acc;
+    acc.fill(Acc());
+    for (size_t begin = 0; begin < n; begin += widenBlockSize) {
+        size_t count = std::min(widenBlockSize, n - begin);
+        for (size_t k = 0; k < K; ++k) {
+            ElementTraits<T>::widen(inputs[k] + begin, count, wide[k].data());
+        }
+        size_t i = 0;
+        for (; i + L <= count; i += L) {
+            for (size_t j = 0; j < L; ++j) {
+                acc[j] += term(wide, i + j);
+            }
+        }
+        for (size_t j = 0; i + j < count; ++j) {
+            acc[j] += term(wide, i + j);
+        }
+    }
+    return combineLanes(acc, [](const Acc &a, const Acc &b) { return static_cast<Acc>(a + b); });
+}
+
+/**
+ * Adds or subtracts two integers, clamping the result to the range of T instead of wrapping.
+ * @tparam Subtract Computes a - b instead of a + b.
+ */
+template<bool Subtract, typename T>
+constexpr T saturatingAddSub(const T &a, const T &b)
+{
+    constexpr T lowest = std::numeric_limits<T>::min();
+    constexpr T highest = std::numeric_limits<T>::max();
+    if constexpr (sizeof(T) < sizeof(int32_t)) {
+        int32_t r = Subtract ? int32_t(a) - int32_t(b) : int32_t(a) + int32_t(b);
+        return static_cast<T>(r < lowest ? lowest : (r > highest ? highest : r));
+    } else if constexpr (std::is_unsigned_v<T>) {
+        if constexpr (Subtract) {
+            return a < b ? lowest : static_cast<T>(a - b);
+        } else {
+            return static_cast<T>(a + b) < a ? highest : static_cast<T>(a + b);
+        }
+    } else {
+        if constexpr (Subtract) {
+            if (b < 0 && a > highest + b) {
+                return highest;
+            }
+            if (b > 0 && a < lowest + b) {
+                return lowest;
+            }
+            return static_cast<T>(a - b);
+        } else {
+            if (b > 0 && a > highest - b) {
+                return highest;
+            }
+            if (b < 0 && a < lowest - b) {
+                return lowest;
+            }
+            return static_cast<T>(a + b);
+        }
+    }
+}
+
+// True for the element types with SSE2/AVX2 saturating add and subtract instructions.
+template<typename T>
+inline constexpr bool hasSaturatingSimd = std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t> ||
+                                          std::is_same_v<T, int16_t> || std::is_same_v<T, uint16_t>;
+
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+/**
+ * Saturating add or subtract of whole registers (padds/psubs). Processes the longest prefix of the arrays that fills
+ * complete registers.
+ * @return The number of elements processed.
+ */
+template<bool Subtract, typename T>
+inline size_t saturatingAddSubSimd(const T *a, const T *b, T *out, size_t n)
+{
+    static_assert(hasSaturatingSimd<T>, "No saturating SIMD instructions for this type.");
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 32 / sizeof(T) <= n; i += 32 / sizeof(T)) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i r;
+        if constexpr (std::is_same_v<T, int8_t>) {
+            r = Subtract ? _mm256_subs_epi8(va, vb) : _mm256_adds_epi8(va, vb);
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+            r = Subtract ? _mm256_subs_epu8(va, vb) : _mm256_adds_epu8(va, vb);
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            r = Subtract ? _mm256_subs_epi16(va, vb) : _mm256_adds_epi16(va, vb);
+        } else {
+            r = Subtract ? _mm256_subs_epu16(va, vb) : _mm256_adds_epu16(va, vb);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), r);
+    }
+#endif
+    for (; i + 16 / sizeof(T) <= n; i += 16 / sizeof(T)) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i r;
+        if constexpr (std::is_same_v<T, int8_t>) {
+            r = Subtract ? _mm_subs_epi8(va, vb) : _mm_adds_epi8(va, vb);
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+            r = Subtract ? _mm_subs_epu8(va, vb) : _mm_adds_epu8(va, vb);
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            r = Subtract ? _mm_subs_epi16(va, vb) : _mm_adds_epi16(va, vb);
+        } else {
+            r = Subtract ? _mm_subs_epu16(va, vb) : _mm_adds_epu16(va, vb);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), r);
+    }
+    return i;
+}
+#endif
+
+// True when std::fma maps to a single hardware instruction for T instead of a software routine.
+template<typename T>
+inline constexpr bool hasFastFma =
+#if defined(FP_FAST_FMAF)
+        std::is_same_v<T, float> ||
+#endif
+#if defined(FP_FAST_FMA)
+        std::is_same_v<T, double> ||
+#endif
+#if defined(FP_FAST_FMAL)
+        std::is_same_v<T, long double> ||
+#endif
+        false;
+
+/**
+ * Computes a * b + c. Uses a single rounding hardware FMA for floating point types when the target has one.
+ */
+template<typename T>
+constexpr T multiplyAdd(const T &a, const T &b, const T &c)
+{
+    if constexpr (hasFastFma<T>) {
+        if !consteval {
+            return std::fma(a, b, c);
+        }
+    }
+    return a * b + c;
+}
+
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+/**
+ * Loads 4 packed float 3D vectors (12 floats) and transposes them to structure of arrays: one register per component.
+ */
+inline void loadVec3Soa(const float *in, __m128 &x, __m128 &y, __m128 &z)
+{
+    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+    __m128 a = _mm_loadu_ps(in);
+    __m128 b = _mm_loadu_ps(in + 4);
+    __m128 c = _mm_loadu_ps(in + 8);
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                       _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                       _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/**
+ * The inverse of loadVec3Soa: interleaves one register per component back into 4 packed float 3D vectors.
+ */
+inline void storeVec3Soa(float *out, __m128 x, __m128 y, __m128 z)
+{
+    _mm_storeu_ps(out, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                                      _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                          _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                                          _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
 template<typename T, size_t N>
 class VectorBase
 {
@@ -34,7 +553,7 @@ public:
         std::array<T, N> data;
         struct
         {
-            T x, y, z;
+            T x, y, z, w;
         };
     };
 };
@@ -65,32 +584,274 @@ public:
         };
     };
 };
+
+// Partial specialization for N = 3.
+template<typename T>
+class VectorBase<T, 3>
+{
+public:
+    union
+    {
+        std::array<T, 3> data;
+        struct
+        {
+            T x, y, z;
+        };
+    };
+};
+
+// True if no index appears twice, so a swizzle of them can be assigned to.
+template<size_t... I>
+consteval bool uniqueIndices()
+{
+    constexpr std::array<size_t, sizeof...(I)> indices{I...};
+    for (size_t i = 0; i < indices.size(); ++i) {
+        for (size_t j = i + 1; j < indices.size(); ++j) {
+            if (indices[i] == indices[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}
+
+
+/**
+ * The result of a component-wise Vector comparison. Holds one boolean lane per vector element and is consumed by
+ * select, any, all and none.
+ * @tparam N The number of lanes.
+ */
+template<size_t N>
+class Mask
+{
+    static_assert(N > 0, "Mask's size N must be greater than 0.");
+
+public:
+    std::array<bool, N> data{};
+
+    constexpr Mask() = default;
+
+    constexpr explicit Mask(bool value)
+    {
+        data.fill(value);
+    }
+
+    constexpr explicit Mask(const std::array<bool, N> &data) : data(data)
+    {}
+
+    constexpr bool &operator[](size_t index)
+    {
+        assert(index < N && "Index out of bounds.");
+        return data[index];
+    }
+
+    constexpr const bool &operator[](size_t index) const
+    {
+        assert(index < N && "Index out of bounds.");
+        return data[index];
+    }
+
+    consteval size_t size()
+    {
+        return N;
+    }
+
+    // Lane-wise logical operators.
+    constexpr Mask operator&(const Mask &other) const
+    {
+        Mask result;
+        detail::forEachIndex<bool, N>([&](size_t i) {
+            result.data[i] = data[i] & other.data[i];
+        });
+        return result;
+    }
+
+    constexpr Mask operator|(const Mask &other) const
+    {
+        Mask result;
+        detail::forEachIndex<bool, N>([&](size_t i) {
+            result.data[i] = data[i] | other.data[i];
+        });
+        return result;
+    }
+
+    constexpr Mask operator^(const Mask &other) const
+    {
+        Mask result;
+        detail::forEachIndex<bool, N>([&](size_t i) {
+            result.data[i] = data[i] ^ other.data[i];
+        });
+        return result;
+    }
+
+    constexpr Mask operator~() const
+    {
+        Mask result;
+        detail::forEachIndex<bool, N>([&](size_t i) {
+            result.data[i] = !data[i];
+        });
+        return result;
+    }
+
+    constexpr bool operator==(const Mask &other) const = default;
+
+    friend std::ostream &operator<<(std::ostream &os, const Mask<N> &mask)
+    {
+        os << "(";
+        for (size_t i = 0; i < N; ++i) {
+            os << mask.data[i];
+            if (i < N - 1) {
+                os << ", ";
+            }
+        }
+        os << ")";
+        return os;
+    }
+};
+
+/**
+ * Returns true if any lane of the mask is set. Every lane is visited so the loop stays branch free.
+ */
+template<size_t N>
+constexpr bool any(const Mask<N> &mask)
+{
+    bool result = false;
+    detail::forEachIndex<bool, N>([&](size_t i) {
+        result |= mask.data[i];
+    });
+    return result;
+}
+
+/**
+ * Returns true if every lane of the mask is set.
+ */
+template<size_t N>
+constexpr bool all(const Mask<N> &mask)
+{
+    bool result = true;
+    detail::forEachIndex<bool, N>([&](size_t i) {
+        result &= mask.data[i];
+    });
+    return result;
+}
+
+/**
+ * Returns true if no lane of the mask is set.
+ */
+template<size_t N>
+constexpr bool none(const Mask<N> &mask)
+{
+    return !any(mask);
+}
+
+template<typename T, size_t N>
+class Vector;
+
+template<typename T, size_t N, size_t... I>
+class SwizzleRef;
+
+// Named swizzles over x, y, z and w. Each one only exists when every component it reads is in the vector.
+#define MATHUTILS_VECTOR_SWIZZLE_2(A, IA, B, IB) \
+    constexpr Vector<T, 2> A##B() const requires (IA < N && IB < N) \
+    { return self().template swizzle<IA, IB>(); }
+#define MATHUTILS_VECTOR_SWIZZLE_3(A, IA, B, IB, C, IC) \
+    constexpr Vector<T, 3> A##B##C() const requires (IA < N && IB < N && IC < N) \
+    { return self().template swizzle<IA, IB, IC>(); }
+#define MATHUTILS_VECTOR_SWIZZLE_4(A, IA, B, IB, C, IC, D, ID) \
+    constexpr Vector<T, 4> A##B##C##D() const requires (IA < N && IB < N && IC < N && ID < N) \
+    { return self().template swizzle<IA, IB, IC, ID>(); }
+
+#define MATHUTILS_VECTOR_SWIZZLES_2_B(A, IA) \
+    MATHUTILS_VECTOR_SWIZZLE_2(A, IA, x, 0) MATHUTILS_VECTOR_SWIZZLE_2(A, IA, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLE_2(A, IA, z, 2) MATHUTILS_VECTOR_SWIZZLE_2(A, IA, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_2 \
+    MATHUTILS_VECTOR_SWIZZLES_2_B(x, 0) MATHUTILS_VECTOR_SWIZZLES_2_B(y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_2_B(z, 2) MATHUTILS_VECTOR_SWIZZLES_2_B(w, 3)
+
+#define MATHUTILS_VECTOR_SWIZZLES_3_C(A, IA, B, IB) \
+    MATHUTILS_VECTOR_SWIZZLE_3(A, IA, B, IB, x, 0) MATHUTILS_VECTOR_SWIZZLE_3(A, IA, B, IB, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLE_3(A, IA, B, IB, z, 2) MATHUTILS_VECTOR_SWIZZLE_3(A, IA, B, IB, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_3_B(A, IA) \
+    MATHUTILS_VECTOR_SWIZZLES_3_C(A, IA, x, 0) MATHUTILS_VECTOR_SWIZZLES_3_C(A, IA, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_3_C(A, IA, z, 2) MATHUTILS_VECTOR_SWIZZLES_3_C(A, IA, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_3 \
+    MATHUTILS_VECTOR_SWIZZLES_3_B(x, 0) MATHUTILS_VECTOR_SWIZZLES_3_B(y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_3_B(z, 2) MATHUTILS_VECTOR_SWIZZLES_3_B(w, 3)
+
+#define MATHUTILS_VECTOR_SWIZZLES_4_D(A, IA, B, IB, C, IC) \
+    MATHUTILS_VECTOR_SWIZZLE_4(A, IA, B, IB, C, IC, x, 0) MATHUTILS_VECTOR_SWIZZLE_4(A, IA, B, IB, C, IC, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLE_4(A, IA, B, IB, C, IC, z, 2) MATHUTILS_VECTOR_SWIZZLE_4(A, IA, B, IB, C, IC, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_4_C(A, IA, B, IB) \
+    MATHUTILS_VECTOR_SWIZZLES_4_D(A, IA, B, IB, x, 0) MATHUTILS_VECTOR_SWIZZLES_4_D(A, IA, B, IB, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_4_D(A, IA, B, IB, z, 2) MATHUTILS_VECTOR_SWIZZLES_4_D(A, IA, B, IB, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_4_B(A, IA) \
+    MATHUTILS_VECTOR_SWIZZLES_4_C(A, IA, x, 0) MATHUTILS_VECTOR_SWIZZLES_4_C(A, IA, y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_4_C(A, IA, z, 2) MATHUTILS_VECTOR_SWIZZLES_4_C(A, IA, w, 3)
+#define MATHUTILS_VECTOR_SWIZZLES_4 \
+    MATHUTILS_VECTOR_SWIZZLES_4_B(x, 0) MATHUTILS_VECTOR_SWIZZLES_4_B(y, 1) \
+    MATHUTILS_VECTOR_SWIZZLES_4_B(z, 2) MATHUTILS_VECTOR_SWIZZLES_4_B(w, 3)
+
+namespace detail
+{
+// The named swizzles of Vector, which only vectors of up to 4 elements have. Larger vectors use Vector::swizzle, so
+// they do not carry hundreds of members they cannot use meaningfully.
+template<typename T, size_t N, bool Named = (N <= 4)>
+class VectorSwizzles
+{
+};
+
+template<typename T, size_t N>
+class VectorSwizzles<T, N, true>
+{
+    constexpr const Vector<T, N> &self() const
+    { return static_cast<const Vector<T, N> &>(*this); }
+
+public:
+    MATHUTILS_VECTOR_SWIZZLES_2
+    MATHUTILS_VECTOR_SWIZZLES_3
+    MATHUTILS_VECTOR_SWIZZLES_4
+};
 }
 
+#undef MATHUTILS_VECTOR_SWIZZLE_2
+#undef MATHUTILS_VECTOR_SWIZZLE_3
+#undef MATHUTILS_VECTOR_SWIZZLE_4
+#undef MATHUTILS_VECTOR_SWIZZLES_2_B
+#undef MATHUTILS_VECTOR_SWIZZLES_2
+#undef MATHUTILS_VECTOR_SWIZZLES_3_C
+#undef MATHUTILS_VECTOR_SWIZZLES_3_B
+#undef MATHUTILS_VECTOR_SWIZZLES_3
+#undef MATHUTILS_VECTOR_SWIZZLES_4_D
+#undef MATHUTILS_VECTOR_SWIZZLES_4_C
+#undef MATHUTILS_VECTOR_SWIZZLES_4_B
+#undef MATHUTILS_VECTOR_SWIZZLES_4
 
 template<typename T, size_t N>
-class Vector : public detail::VectorBase<T, N>
+class Vector : public detail::VectorSwizzles<T, N>, public detail::VectorBase<T, N>
 {
 
-    static_assert(std::is_arithmetic<T>::value,
+    static_assert(ElementTraits<T>::isElement,
                   "Vector's template parameter T must be a numerical type.");
     static_assert(N > 0, "Vector's size N must be greater than 0.");
 
 public:
 
+    // The type dot products, sums and products of this vector are accumulated in.
+    using AccumulatorType = typename ElementTraits<T>::Accumulator;
+
     // Constructors
     consteval Vector() : detail::VectorBase<T, N>()
     {}
 
+    // A single argument goes to the fill or copy constructors unless the vector has exactly one element.
     template<typename... Args>
+    requires (sizeof...(Args) != 1 || (N == 1 && (std::is_convertible_v<Args, T> && ...)))
     constexpr explicit Vector(Args &&... args) : detail::VectorBase<T, N>()
     {
         static_assert(sizeof...(args) == N, "Incorrect number of arguments for Vector construction.");
-        T temp_data[] = {static_cast<T>(std::forward<Args>(args))...};
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
-            this->data[i] = temp_data[i];
-        }
+        size_t i = 0;
+        ((this->data[i++] = static_cast<T>(std::forward<Args>(args))), ...);
     }
 
     constexpr Vector(const Vector &other) : detail::VectorBase<T, N>()
@@ -101,10 +862,9 @@ public:
     template<size_t M, typename = std::enable_if_t<(N >= M)>>
     constexpr explicit Vector(const Vector<T, M> &other) : detail::VectorBase<T, N>()
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < M; ++i) {
+        detail::forEachIndex<T, M>([&](size_t i) {
             this->data[i] = other.data[i];
-        }
+        });
     }
 
     constexpr Vector(Vector &&other) noexcept: detail::VectorBase<T, N>()
@@ -114,10 +874,9 @@ public:
 
     constexpr explicit Vector(const T &value) : detail::VectorBase<T, N>()
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] = value;
-        }
+        });
     }
 
     constexpr explicit Vector(const std::array<T, N> &data)
@@ -132,16 +891,16 @@ public:
 
     constexpr explicit Vector(const T (&data)[N])
     {
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] = data[i];
-        }
+        });
     }
 
     constexpr explicit Vector(T (&&data)[N])
     {
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] = std::move(data[i]);
-        }
+        });
     }
 
     consteval size_t size() {
@@ -204,12 +963,11 @@ public:
      */
     constexpr Vector<T, N> operator-() const
     {
-        static_assert(std::is_signed<T>::value, "Vector's element type must be a signed type.");
+        static_assert(!std::is_unsigned<T>::value, "Vector's element type must be a signed type.");
         Vector<T, N> result;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] = -this->data[i];
-        }
+        });
         return result;
     }
 
@@ -234,17 +992,15 @@ public:
     {
         if constexpr (N >= M) {
             Vector<T, N> result = *this;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < M; ++i) {
+            detail::forEachIndex<T, M>([&](size_t i) {
                 result.data[i] += other.data[i];
-            }
+            });
             return result;
         } else {
             Vector<T, M> result = other;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < N; ++i) {
+            detail::forEachIndex<T, N>([&](size_t i) {
                 result.data[i] += this->data[i];
-            }
+            });
             return result;
         }
     }
@@ -260,17 +1016,15 @@ public:
     {
         if constexpr (N >= M) {
             Vector<T, N> result = *this;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < M; ++i) {
+            detail::forEachIndex<T, M>([&](size_t i) {
                 result.data[i] -= other.data[i];
-            }
+            });
             return result;
         } else {
             Vector<T, M> result = -other;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < N; ++i) {
+            detail::forEachIndex<T, N>([&](size_t i) {
                 result.data[i] += this->data[i];
-            }
+            });
             return result;
         }
     }
@@ -286,17 +1040,15 @@ public:
     {
         if constexpr (N >= M) {
             Vector<T, N> result;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < M; ++i) {
+            detail::forEachIndex<T, M>([&](size_t i) {
                 result.data[i] = this->data[i] * other.data[i];
-            }
+            });
             return result;
         } else {
             Vector<T, M> result;
-            MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-            for (size_t i = 0; i < N; ++i) {
+            detail::forEachIndex<T, N>([&](size_t i) {
                 result.data[i] = this->data[i] * other.data[i];
-            }
+            });
             return result;
         }
     }
@@ -311,10 +1063,9 @@ public:
     constexpr Vector<T, M> operator/(const Vector<T, M> &other) const
     {
         Vector<T, M> result;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] = this->data[i] / other.data[i];
-        }
+        });
         return result;
     }
 
@@ -328,10 +1079,9 @@ public:
     template<size_t M, typename = std::enable_if_t<(N >= M)>>
     constexpr Vector<T, N> &operator+=(const Vector<T, M> &other)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < M; ++i) {
+        detail::forEachIndex<T, M>([&](size_t i) {
             this->data[i] += other.data[i];
-        }
+        });
         return *this;
     }
 
@@ -344,10 +1094,9 @@ public:
     template<size_t M, typename = std::enable_if_t<(N >= M)>>
     constexpr Vector<T, N> &operator-=(const Vector<T, M> &other)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < M; ++i) {
+        detail::forEachIndex<T, M>([&](size_t i) {
             this->data[i] -= other.data[i];
-        }
+        });
         return *this;
     }
 
@@ -360,10 +1109,9 @@ public:
     template<size_t M, typename = std::enable_if_t<(N >= M)>>
     constexpr Vector<T, N> &operator*=(const Vector<T, M> &other)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < M; ++i) {
+        detail::forEachIndex<T, M>([&](size_t i) {
             this->data[i] *= other.data[i];
-        }
+        });
         return *this;
     }
 
@@ -374,11 +1122,10 @@ public:
      */
     constexpr Vector<T, N> &operator/=(const Vector<T, N> &other)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             assert(other[i] != T() && "Division by zero.");
             this->data[i] /= other[i];
-        }
+        });
         return *this;
     }
 
@@ -391,10 +1138,9 @@ public:
     constexpr Vector<T, N> operator+(const T &scalar) const
     {
         Vector<T, N> result = *this;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] += scalar;
-        }
+        });
         return result;
     }
 
@@ -406,10 +1152,9 @@ public:
     constexpr Vector<T, N> operator-(const T &scalar) const
     {
         Vector<T, N> result = *this;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] -= scalar;
-        }
+        });
         return result;
     }
 
@@ -421,10 +1166,9 @@ public:
     constexpr Vector<T, N> operator*(const T &scalar) const
     {
         Vector<T, N> result = *this;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] *= scalar;
-        }
+        });
         return result;
     }
 
@@ -437,10 +1181,9 @@ public:
     {
         assert(scalar != T() && "Division by zero.");
         Vector<T, N> result = *this;
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             result.data[i] /= scalar;
-        }
+        });
         return result;
     }
 
@@ -452,10 +1195,9 @@ public:
      */
     constexpr Vector<T, N> &operator+=(const T &scalar)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] += scalar;
-        }
+        });
         return *this;
     }
 
@@ -466,10 +1208,9 @@ public:
      */
     constexpr Vector<T, N> &operator-=(const T &scalar)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] -= scalar;
-        }
+        });
         return *this;
     }
 
@@ -480,10 +1221,9 @@ public:
      */
     constexpr Vector<T, N> &operator*=(const T &scalar)
     {
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] *= scalar;
-        }
+        });
         return *this;
     }
 
@@ -495,26 +1235,193 @@ public:
     constexpr Vector<T, N> &operator/=(const T &scalar)
     {
         assert(scalar != T() && "Division by zero.");
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
+        detail::forEachIndex<T, N>([&](size_t i) {
             this->data[i] /= scalar;
-        }
+        });
         return *this;
     }
 
     // Vector functions
     /**
-     * Dot product function. Computes the dot product of this vector with another vector.
+     * Dot product function. Computes the dot product of this vector with another vector. Large vectors are reduced
+     * with several independent accumulators, so the result may differ from a serial sum by rounding.
+     * @tparam S The summation order used to accumulate the products.
      * @param other The other vector to compute the dot product with.
      * @return The dot product of this vector and the other vector.
      */
-    constexpr T dot(const Vector<T, N> &other) const
+    template<Summation S = Summation::Fast>
+    constexpr AccumulatorType dot(const Vector<T, N> &other) const
     {
-        T result = T(); // Initialize with a zero value
-        MATHUTILS_VECTOR_FOR_LOOP_UNROLL
-        for (size_t i = 0; i < N; ++i) {
-            result += this->data[i] * other.data[i];
+        using Acc = detail::SummationType<T, S>;
+        if constexpr (detail::widensInBlocks<T, S> && detail::useChunkedLoop<N>) {
+            if !consteval {
+                auto term = [](const auto &wide, size_t j) {
+                    return static_cast<Acc>(static_cast<Acc>(wide[0][j]) * static_cast<Acc>(wide[1][j]));
+                };
+                return static_cast<AccumulatorType>(detail::widenedAccumulate<Acc, S, detail::reductionLanes<Acc, N>>(
+                        N, std::array{this->data.data(), other.data.data()}, term));
+            }
+        }
+        return static_cast<AccumulatorType>(detail::accumulate<Acc, N, S>([&](size_t i) {
+            return static_cast<Acc>(static_cast<Acc>(this->data[i]) * static_cast<Acc>(other.data[i]));
+        }));
+    }
+
+    // Reductions
+    /**
+     * Sum function. Computes the sum of all elements of this vector.
+     * @tparam S The summation order. Summation::Deterministic gives the same result on every target.
+     * @return The sum of the elements.
+     */
+    template<Summation S = Summation::Fast>
+    constexpr AccumulatorType sum() const
+    {
+        using Acc = detail::SummationType<T, S>;
+        if constexpr (detail::widensInBlocks<T, S> && detail::useChunkedLoop<N>) {
+            if !consteval {
+                auto term = [](const auto &wide, size_t j) { return static_cast<Acc>(wide[0][j]); };
+                return static_cast<AccumulatorType>(detail::widenedAccumulate<Acc, S, detail::reductionLanes<Acc, N>>(
+                        N, std::array{this->data.data()}, term));
+            }
+        }
+        return static_cast<AccumulatorType>(detail::accumulate<Acc, N, S>([&](size_t i) {
+            return static_cast<Acc>(this->data[i]);
+        }));
+    }
+
+    /**
+     * Product function. Computes the product of all elements of this vector.
+     * @return The product of the elements.
+     */
+    constexpr AccumulatorType product() const
+    {
+        using Acc = AccumulatorType;
+        auto term = [&](size_t i) { return static_cast<Acc>(this->data[i]); };
+        auto mul = [](const Acc &a, const Acc &b) { return static_cast<Acc>(a * b); };
+        return detail::chunkedReduce<Acc, N, detail::reductionLanes<Acc, N>>(Acc(1), term, mul);
+    }
+
+    /**
+     * Minimum element function.
+     * @return The smallest element of this vector.
+     */
+    constexpr T minElement() const
+    {
+        return detail::chunkedReduce<T, N, detail::useChunkedLoop<N> ? detail::simdLanes<T> : 1>(
+                this->data[0], [&](size_t i) { return this->data[i]; },
+                [](const T &a, const T &b) { return b < a ? b : a; });
+    }
+
+    /**
+     * Maximum element function.
+     * @return The largest element of this vector.
+     */
+    constexpr T maxElement() const
+    {
+        return detail::chunkedReduce<T, N, detail::useChunkedLoop<N> ? detail::simdLanes<T> : 1>(
+                this->data[0], [&](size_t i) { return this->data[i]; },
+                [](const T &a, const T &b) { return a < b ? b : a; });
+    }
+
+    /**
+     * Argmin function.
+     * @return The index of the first occurrence of the smallest element of this vector.
+     */
+    constexpr size_t argmin() const
+    {
+        return detail::chunkedArgBest(this->data, [](const T &a, const T &b) { return a < b; });
+    }
+
+    /**
+     * Argmax function.
+     * @return The index of the first occurrence of the largest element of this vector.
+     */
+    constexpr size_t argmax() const
+    {
+        return detail::chunkedArgBest(this->data, [](const T &a, const T &b) { return b < a; });
+    }
+
+    /**
+     * Squared length function. Computes the dot product of this vector with itself, avoiding the square root.
+     * @tparam S The summation order used to accumulate the squares.
+     * @return The squared Euclidean length of this vector.
+     */
+    template<Summation S = Summation::Fast>
+    constexpr AccumulatorType squaredLength() const
+    {
+        return dot<S>(*this);
+    }
+
+    /**
+     * Norm function. Computes the L1, L2, general Lp or maximum norm of this vector. Integer vectors return a double.
+     * @tparam P The order of the norm. Pass InfinityNorm for the maximum norm.
+     * @tparam S The summation order used for the finite norms.
+     * @return The P-norm of this vector.
+     */
+    template<size_t P, Summation S = Summation::Fast>
+    constexpr auto norm() const
+    {
+        static_assert(P > 0, "The order of a norm must be greater than 0.");
+        using Real = std::conditional_t<std::is_floating_point_v<AccumulatorType>, AccumulatorType, double>;
+        auto absolute = [](const T &v) {
+            Real r = static_cast<Real>(v);
+            return r < Real() ? -r : r;
+        };
+        if constexpr (P == InfinityNorm) {
+            return detail::chunkedReduce<Real, N, detail::useChunkedLoop<N> ? detail::simdLanes<Real> : 1>(
+                    Real(), [&](size_t i) { return absolute(this->data[i]); },
+                    [](const Real &a, const Real &b) { return a < b ? b : a; });
+        } else if constexpr (P == 1) {
+            using Acc = detail::SummationType<Real, S>;
+            return static_cast<Real>(detail::accumulate<Acc, N, S>([&](size_t i) {
+                return static_cast<Acc>(absolute(this->data[i]));
+            }));
+        } else if constexpr (P == 2) {
+            return static_cast<Real>(std::sqrt(static_cast<Real>(squaredLength<S>())));
+        } else {
+            using Acc = detail::SummationType<Real, S>;
+            auto power = [&](size_t i) { return static_cast<Acc>(std::pow(static_cast<Acc>(absolute(this->data[i])), Acc(P))); };
+            return static_cast<Real>(std::pow(detail::accumulate<Acc, N, S>(power), Acc(1) / Acc(P)));
         }
+    }
+
+    /**
+     * Length function. Computes the Euclidean length of this vector.
+     * @return The L2 norm of this vector.
+     */
+    constexpr auto length() const
+    {
+        return norm<2>();
+    }
+
+    /**
+     * Multiply-add function. Computes this * other + addend element-wise, fused into a single pass and a single
+     * rounding when the target has hardware FMA.
+     * @param other The vector to multiply this by.
+     * @param addend The vector to add to the product.
+     * @return A new vector containing this * other + addend.
+     */
+    constexpr Vector<T, N> madd(const Vector<T, N> &other, const Vector<T, N> &addend) const
+    {
+        Vector<T, N> result;
+        detail::forEachIndex<T, N>([&](size_t i) {
+            result.data[i] = detail::multiplyAdd(this->data[i], other.data[i], addend.data[i]);
+        });
+        return result;
+    }
+
+    /**
+     * Scalar multiply-add function. Computes this * scalar + addend element-wise.
+     * @param scalar The scalar to multiply this by.
+     * @param addend The vector to add to the product.
+     * @return A new vector containing this * scalar + addend.
+     */
+    constexpr Vector<T, N> madd(const T &scalar, const Vector<T, N> &addend) const
+    {
+        Vector<T, N> result;
+        detail::forEachIndex<T, N>([&](size_t i) {
+            result.data[i] = detail::multiplyAdd(this->data[i], scalar, addend.data[i]);
+        });
         return result;
     }
 
@@ -560,6 +1467,33 @@ public:
         return result;
     }
 
+    // Swizzles
+    /**
+     * Swizzle function. Gathers the elements at the given indices into a new vector, e.g. v.swizzle<2, 1, 0>() reverses
+     * a 3D vector. The indices are known at compile time, so the copy compiles to a shuffle where the target has one.
+     * @tparam I The indices of the elements to gather. Indices may repeat.
+     * @return A new vector of size sizeof...(I) holding the gathered elements.
+     */
+    template<size_t... I>
+    constexpr Vector<T, sizeof...(I)> swizzle() const
+    {
+        static_assert(sizeof...(I) > 0, "A swizzle needs at least one index.");
+        static_assert(((I < N) && ...), "Swizzle index out of bounds.");
+        return Vector<T, sizeof...(I)>(this->data[I]...);
+    }
+
+    /**
+     * Writable swizzle function. Returns a reference to the elements at the given indices, so that
+     * v.swizzleRef<2, 0>() = Vector<T, 2>(a, b) sets v.z to a and v.x to b.
+     * @tparam I The indices of the elements to reference. Indices must be unique.
+     * @return A proxy that reads and writes the referenced elements of this vector.
+     */
+    template<size_t... I>
+    constexpr SwizzleRef<T, N, I...> swizzleRef()
+    {
+        return SwizzleRef<T, N, I...>(*this);
+    }
+
     /**
      * Equality operator. Compares this vector with another vector of the same or different size. The shorter vector is implicitly padded with 0's before the comparison.
      * @tparam M The size of the other vector.
@@ -818,6 +1752,324 @@ public:
     }
 };
 
+/**
+ * A writable view of some elements of a vector, returned by Vector::swizzleRef. Reading it gathers the referenced
+ * elements into a vector and assigning to it scatters a vector back into them.
+ * @tparam T The element type.
+ * @tparam N The size of the referenced vector.
+ * @tparam I The referenced indices.
+ */
+template<typename T, size_t N, size_t... I>
+class SwizzleRef
+{
+    static_assert(sizeof...(I) > 0, "A swizzle needs at least one index.");
+    static_assert(((I < N) && ...), "Swizzle index out of bounds.");
+    static_assert(detail::uniqueIndices<I...>(), "A writable swizzle cannot reference the same element twice.");
+
+    Vector<T, N> &vec;
+
+public:
+    constexpr explicit SwizzleRef(Vector<T, N> &vec) : vec(vec)
+    {}
+
+    constexpr operator Vector<T, sizeof...(I)>() const
+    {
+        return vec.template swizzle<I...>();
+    }
+
+    // Takes the value by copy, so assigning the referenced vector itself, e.g. v.swizzleRef<1, 0>() = v, is safe.
+    constexpr SwizzleRef &operator=(Vector<T, sizeof...(I)> value)
+    {
+        size_t i = 0;
+        ((vec.data[I] = value.data[i++]), ...);
+        return *this;
+    }
+
+    constexpr SwizzleRef &operator=(const SwizzleRef &other)
+    {
+        return *this = static_cast<Vector<T, sizeof...(I)>>(other);
+    }
+
+    constexpr SwizzleRef &operator+=(const Vector<T, sizeof...(I)> &value)
+    {
+        return *this = static_cast<Vector<T, sizeof...(I)>>(*this) + value;
+    }
+
+    constexpr SwizzleRef &operator-=(const Vector<T, sizeof...(I)> &value)
+    {
+        return *this = static_cast<Vector<T, sizeof...(I)>>(*this) - value;
+    }
+
+    constexpr SwizzleRef &operator*=(const T &scalar)
+    {
+        return *this = static_cast<Vector<T, sizeof...(I)>>(*this) * scalar;
+    }
+};
+
+// Fused Vector functions
+/**
+ * Fused multiply-add. Computes a * b + c element-wise.
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param c The addend.
+ * @return A new vector containing a * b + c.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> fma(const Vector<T, N> &a, const Vector<T, N> &b, const Vector<T, N> &c)
+{
+    return a.madd(b, c);
+}
+
+/**
+ * Fused multiply-add with a scalar factor. Computes a * s + c element-wise.
+ * @param a The vector factor.
+ * @param s The scalar factor.
+ * @param c The addend.
+ * @return A new vector containing a * s + c.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> fma(const Vector<T, N> &a, const std::type_identity_t<T> &s, const Vector<T, N> &c)
+{
+    return a.madd(s, c);
+}
+
+/**
+ * BLAS style axpy. Updates y in place to alpha * x + y.
+ * @param alpha The scalar to scale x by.
+ * @param x The vector to scale.
+ * @param y The vector to accumulate into.
+ */
+template<typename T, size_t N>
+constexpr void axpy(const std::type_identity_t<T> &alpha, const Vector<T, N> &x, Vector<T, N> &y)
+{
+    detail::forEachIndex<T, N>([&](size_t i) {
+        y.data[i] = detail::multiplyAdd(alpha, x.data[i], y.data[i]);
+    });
+}
+
+/**
+ * Linear interpolation between a and b. Computed as t * b + (a - t * a) so that t = 0 returns a and t = 1 returns b
+ * exactly for floating point types.
+ * @param a The start value, returned for t = 0.
+ * @param b The end value, returned for t = 1.
+ * @param t The interpolation parameter.
+ * @return A new vector interpolated between a and b.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> lerp(const Vector<T, N> &a, const Vector<T, N> &b, const std::type_identity_t<T> &t)
+{
+    Vector<T, N> result;
+    detail::forEachIndex<T, N>([&](size_t i) {
+        result.data[i] = detail::multiplyAdd(t, b.data[i], detail::multiplyAdd(static_cast<T>(-t), a.data[i], a.data[i]));
+    });
+    return result;
+}
+
+// Batched fused Vector functions. The inputs are taken as non-deduced spans so std::vector and arrays convert to them
+// implicitly; the output span determines T and N.
+/**
+ * Batched fused multiply-add. Computes out[k] = a[k] * b[k] + c[k] for every k.
+ */
+template<typename T, size_t N>
+constexpr void fma(std::type_identity_t<std::span<const Vector<T, N>>> a,
+                   std::type_identity_t<std::span<const Vector<T, N>>> b,
+                   std::type_identity_t<std::span<const Vector<T, N>>> c,
+                   std::span<Vector<T, N>> out)
+{
+    assert(a.size() == out.size() && b.size() == out.size() && c.size() == out.size() && "Span size mismatch.");
+    for (size_t k = 0; k < out.size(); ++k) {
+        detail::forEachIndex<T, N>([&](size_t i) {
+            out[k].data[i] = detail::multiplyAdd(a[k].data[i], b[k].data[i], c[k].data[i]);
+        });
+    }
+}
+
+/**
+ * Batched axpy. Updates y[k] in place to alpha * x[k] + y[k] for every k.
+ */
+template<typename T, size_t N>
+constexpr void axpy(const std::type_identity_t<T> &alpha,
+                    std::type_identity_t<std::span<const Vector<T, N>>> x,
+                    std::span<Vector<T, N>> y)
+{
+    assert(x.size() == y.size() && "Span size mismatch.");
+    for (size_t k = 0; k < y.size(); ++k) {
+        axpy(alpha, x[k], y[k]);
+    }
+}
+
+/**
+ * Batched linear interpolation. Computes out[k] = lerp(a[k], b[k], t) for every k.
+ */
+template<typename T, size_t N>
+constexpr void lerp(std::type_identity_t<std::span<const Vector<T, N>>> a,
+                    std::type_identity_t<std::span<const Vector<T, N>>> b,
+                    const std::type_identity_t<T> &t,
+                    std::span<Vector<T, N>> out)
+{
+    assert(a.size() == out.size() && b.size() == out.size() && "Span size mismatch.");
+    for (size_t k = 0; k < out.size(); ++k) {
+        out[k] = lerp(a[k], b[k], t);
+    }
+}
+
+// Component-wise comparison functions. Unlike the lexicographic comparison operators these compare every element
+// independently and return a Mask, which the compiler lowers to SIMD compares.
+#define MATHUTILS_VECTOR_COMPONENT_COMPARISON(NAME, OP)                           \
+template<typename T, size_t N>                                                  \
+constexpr Mask<N> NAME(const Vector<T, N> &a, const Vector<T, N> &b)            \
+{                                                                               \
+    Mask<N> result;                                                             \
+    detail::forEachIndex<T, N>([&](size_t i) {                                  \
+        result.data[i] = a.data[i] OP b.data[i];                                \
+    });                                                                         \
+    return result;                                                              \
+}
+
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(equal, ==)
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(notEqual, !=)
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(lessThan, <)
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(lessThanEqual, <=)
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(greaterThan, >)
+MATHUTILS_VECTOR_COMPONENT_COMPARISON(greaterThanEqual, >=)
+
+#undef MATHUTILS_VECTOR_COMPONENT_COMPARISON
+
+/**
+ * Branch free blend. Picks a[i] where the mask is set and b[i] elsewhere.
+ * @param mask The lanes to take from a.
+ * @param a The vector to take set lanes from.
+ * @param b The vector to take cleared lanes from.
+ * @return A new vector blended from a and b.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> select(const Mask<N> &mask, const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    Vector<T, N> result;
+    detail::forEachIndex<T, N>([&](size_t i) {
+        result.data[i] = mask.data[i] ? a.data[i] : b.data[i];
+    });
+    return result;
+}
+
+/**
+ * Component-wise minimum of two vectors.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> min(const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    Vector<T, N> result;
+    detail::forEachIndex<T, N>([&](size_t i) {
+        result.data[i] = b.data[i] < a.data[i] ? b.data[i] : a.data[i];
+    });
+    return result;
+}
+
+/**
+ * Component-wise maximum of two vectors.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> max(const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    Vector<T, N> result;
+    detail::forEachIndex<T, N>([&](size_t i) {
+        result.data[i] = a.data[i] < b.data[i] ? b.data[i] : a.data[i];
+    });
+    return result;
+}
+
+/**
+ * Component-wise clamp of a vector between lower and upper bounds.
+ * @param v The vector to clamp.
+ * @param lo The per-element lower bounds.
+ * @param hi The per-element upper bounds.
+ * @return A new vector with every element clamped to [lo[i], hi[i]].
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> clamp(const Vector<T, N> &v, const Vector<T, N> &lo, const Vector<T, N> &hi)
+{
+    return min(max(v, lo), hi);
+}
+
+/**
+ * Component-wise clamp of a vector between scalar bounds.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> clamp(const Vector<T, N> &v, const std::type_identity_t<T> &lo,
+                             const std::type_identity_t<T> &hi)
+{
+    return clamp(v, Vector<T, N>(lo), Vector<T, N>(hi));
+}
+
+/**
+ * Component-wise absolute value. Returns the vector unchanged for unsigned element types.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> abs(const Vector<T, N> &v)
+{
+    if constexpr (std::is_unsigned_v<T>) {
+        return v;
+    } else {
+        Vector<T, N> result;
+        detail::forEachIndex<T, N>([&](size_t i) {
+            result.data[i] = v.data[i] < T() ? static_cast<T>(-v.data[i]) : v.data[i];
+        });
+        return result;
+    }
+}
+
+/**
+ * Component-wise saturating addition. Results that do not fit in T are clamped to its range instead of wrapping.
+ * 8 and 16 bit types use the SIMD padds/paddus instructions.
+ * @param a The first vector.
+ * @param b The vector to add.
+ * @return A new vector containing the saturated sums.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> addSaturate(const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    static_assert(std::is_integral_v<T>, "Saturating arithmetic requires an integer element type.");
+    Vector<T, N> result;
+    size_t start = 0;
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    if constexpr (detail::hasSaturatingSimd<T>) {
+        if !consteval {
+            start = detail::saturatingAddSubSimd<false>(a.data.data(), b.data.data(), result.data.data(), N);
+        }
+    }
+#endif
+    for (size_t i = start; i < N; ++i) {
+        result.data[i] = detail::saturatingAddSub<false>(a.data[i], b.data[i]);
+    }
+    return result;
+}
+
+/**
+ * Component-wise saturating subtraction. Results that do not fit in T are clamped to its range instead of wrapping.
+ * 8 and 16 bit types use the SIMD psubs/psubus instructions.
+ * @param a The vector to subtract from.
+ * @param b The vector to subtract.
+ * @return A new vector containing the saturated differences.
+ */
+template<typename T, size_t N>
+constexpr Vector<T, N> subSaturate(const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    static_assert(std::is_integral_v<T>, "Saturating arithmetic requires an integer element type.");
+    Vector<T, N> result;
+    size_t start = 0;
+#ifdef MATHUTILS_VECTOR_HAS_SSE2
+    if constexpr (detail::hasSaturatingSimd<T>) {
+        if !consteval {
+            start = detail::saturatingAddSubSimd<true>(a.data.data(), b.data.data(), result.data.data(), N);
+        }
+    }
+#endif
+    for (size_t i = start; i < N; ++i) {
+        result.data[i] = detail::saturatingAddSub<true>(a.data[i], b.data[i]);
+    }
+    return result;
+}
+
 #define USING_VECTOR(L, SUFFIX, TYPE) using Vec##L##SUFFIX = Vector<TYPE, L>;
 
 #define VECTOR_ALL(SUFFIX, TYPE) \
@@ -0,0 +1,87 @@
+#define USING_FLOATING_AFFINE_TYPES
+#define USING_FLOATING_VECTOR_TYPES
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "MathUtils/Vector/Affine3.h"
+
+using namespace MathUtils;
+
+class AffineTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+static void expectNear(const Vec3F &a, const Vec3F &b, float tolerance = 1e-5f)
+{
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(a[i], b[i], tolerance);
+    }
+}
+
+static Affine3F getTransform()
+{
+    return Affine3F(Matrix<float, 3, 4>({{2.0f, 0.5f, 0.0f, 1.0f},
+                                         {0.0f, 1.0f, -1.0f, 2.0f},
+                                         {0.25f, 0.0f, 3.0f, -4.0f}}));
+}
+
+TEST_F(AffineTest, TransformAndCompose)
+{
+    Affine3F a = getTransform();
+    Affine3F b = Affine3F::fromTranslation(Vec3F(1.0f, 2.0f, 3.0f));
+    Vec3F p(1.0f, -2.0f, 0.5f);
+
+    expectNear(a.transformPoint(p), Vec3F(2.0f, -0.5f, -2.25f));
+    expectNear(a.transformVector(p), Vec3F(1.0f, -2.5f, 1.75f));
+    expectNear((a * b).transformPoint(p), a.transformPoint(b.transformPoint(p)));
+
+    Matrix<float, 4, 4> homogeneous = a.toMatrix();
+    EXPECT_EQ(homogeneous(3, 3), 1.0f);
+    EXPECT_EQ(Affine3F(homogeneous), a);
+}
+
+TEST_F(AffineTest, Inverse)
+{
+    Affine3F a = getTransform();
+    Vec3F p(1.0f, -2.0f, 0.5f);
+    expectNear(a.inverse()->transformPoint(a.transformPoint(p)), p);
+
+    // A rotation of 90 degrees about z followed by a translation.
+    Affine3F rigid(Matrix<float, 3, 4>({{0.0f, -1.0f, 0.0f, 5.0f},
+                                        {1.0f, 0.0f, 0.0f, -1.0f},
+                                        {0.0f, 0.0f, 1.0f, 2.0f}}));
+    EXPECT_EQ(rigid.rigidInverse(), *rigid.inverse());
+    expectNear(rigid.rigidInverse().transformPoint(rigid.transformPoint(p)), p);
+
+    // A projection onto the xy plane has no inverse.
+    Affine3F flatten(Matrix<float, 3, 4>({{1.0f, 0.0f, 0.0f, 1.0f},
+                                          {0.0f, 1.0f, 0.0f, 2.0f},
+                                          {0.0f, 0.0f, 0.0f, 3.0f}}));
+    EXPECT_FALSE(flatten.inverse());
+}
+
+TEST_F(AffineTest, BatchTransform)
+{
+    Affine3F a = getTransform();
+    std::vector<Vec3F> points;
+    for (int i = 0; i < 11; ++i) {
+        points.emplace_back(static_cast<float>(i), 1.0f - static_cast<float>(i), 0.5f * static_cast<float>(i));
+    }
+    std::vector<Vec3F> transformed(points.size());
+    transformPoints(a, points, std::span<Vec3F>(transformed));
+    for (size_t i = 0; i < points.size(); ++i) {
+        expectNear(transformed[i], a.transformPoint(points[i]));
+    }
+
+    transformVectors(a, points, std::span<Vec3F>(points));
+    for (size_t i = 0; i < points.size(); ++i) {
+        expectNear(points[i], a.transformVector(Vec3F(static_cast<float>(i), 1.0f - static_cast<float>(i),
+                                                      0.5f * static_cast<float>(i))));
+    }
+}
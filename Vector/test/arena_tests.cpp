@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <thread>
+#include "MathUtils/Vector/Arena.h"
+#include "MathUtils/Vector/DynMatrix.h"
+
+using namespace MathUtils;
+
+class ArenaTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+// An upstream resource that counts the blocks an arena requests.
+class BlockCounter : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t live = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        ++live;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+static DynMatrix<double> getMatrix(size_t n, double offset)
+{
+    DynMatrix<double> m(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            m(i, j) = static_cast<double>((i * 3 + j) % 7) - offset;
+        }
+    }
+    return m;
+}
+
+TEST_F(ArenaTest, BumpAllocation)
+{
+    BlockCounter upstream;
+    {
+        Arena arena(1024, MATHUTILS_ARENA_THRESHOLD, &upstream);
+        EXPECT_EQ(arena.capacity(), 0u);
+
+        void *a = arena.allocate(10, 1);
+        void *b = arena.allocate(64, 64);
+        EXPECT_LE(static_cast<std::byte *>(a) + 10, static_cast<std::byte *>(b));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 64, 0u);
+        EXPECT_EQ(upstream.allocations, 1u);
+        EXPECT_GE(arena.used(), 74u);
+        size_t used = arena.used();
+
+        // Freeing the last allocation returns it, freeing an earlier one does nothing.
+        arena.deallocate(b, 64, 64);
+        EXPECT_LT(arena.used(), used);
+        EXPECT_EQ(arena.allocate(64, 64), b);
+        arena.deallocate(a, 10, 1);
+        EXPECT_EQ(arena.used(), used);
+
+        // Allocations larger than a block get their own.
+        Arena::Marker marker = arena.mark();
+        EXPECT_NE(arena.allocate(5000, 8), nullptr);
+        EXPECT_NE(arena.allocate(600, 8), nullptr);
+        EXPECT_EQ(upstream.allocations, 3u);
+        EXPECT_EQ(arena.capacity(), 1024u + 5008u + 1024u);
+        size_t peak = arena.peak();
+        EXPECT_GE(peak, used + 5600);
+
+        // Rewinding keeps the blocks, so the same allocations do not reach upstream again.
+        arena.rewind(marker);
+        EXPECT_EQ(arena.used(), used);
+        EXPECT_EQ(arena.peak(), peak);
+        EXPECT_NE(arena.allocate(5000, 8), nullptr);
+        EXPECT_NE(arena.allocate(600, 8), nullptr);
+        EXPECT_EQ(upstream.allocations, 3u);
+
+        arena.rewind(marker);
+        arena.resetPeak();
+        EXPECT_EQ(arena.peak(), used);
+        arena.release();
+        EXPECT_EQ(arena.used(), 0u);
+        EXPECT_EQ(upstream.live, 0u);
+        EXPECT_NE(arena.allocate(8, 8), nullptr);
+    }
+    EXPECT_EQ(upstream.live, 0u);
+}
+
+TEST_F(ArenaTest, ScopedResults)
+{
+    BlockCounter upstream;
+    Arena arena(1 << 16, 4096, &upstream);
+    DynMatrix<double> a = getMatrix(32, 1.0);
+    DynMatrix<double> b = getMatrix(32, 2.0);
+    DynMatrix<double> d = getMatrix(32, 3.0);
+    DynMatrix<double> expected = a.matMult(b).matMult(a) + d;
+    DynMatrix<double> result;
+    EXPECT_EQ(Arena::active(), nullptr);
+    {
+        Arena::Scope scope(arena);
+        EXPECT_EQ(Arena::active(), &arena);
+
+        // Each 32 x 32 temporary holds 8192 bytes and is placed in the arena.
+        DynMatrix<double> product = a.matMult(b);
+        EXPECT_EQ(product.memoryResource(), &arena);
+        result = product.matMult(a) + d;
+        EXPECT_GE(arena.peak(), 3 * 32 * 32 * sizeof(double));
+        EXPECT_LT(arena.peak(), 3 * 32 * 32 * sizeof(double) + 64);
+
+        // Results below the threshold stay in the operand's resource.
+        DynMatrix<double> small = getMatrix(4, 0.0) * 2.0;
+        EXPECT_EQ(small.memoryResource(), std::pmr::get_default_resource());
+        {
+            Arena::Scope inner(arena);
+            DynVector<double> v = a.matMult(DynVector<double>(32, 1.0)) * 2.0;
+            EXPECT_EQ(v.memoryResource(), std::pmr::get_default_resource());
+            arena.setThreshold(0);
+            EXPECT_EQ((v + v).memoryResource(), &arena);
+            arena.setThreshold(4096);
+        }
+        EXPECT_EQ(Arena::active(), &arena);
+    }
+    EXPECT_EQ(Arena::active(), nullptr);
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(upstream.allocations, 1u);
+
+    // Assigning to a matrix declared outside the scope copied the result out of the arena.
+    EXPECT_EQ(result.memoryResource(), std::pmr::get_default_resource());
+    EXPECT_EQ(result, expected);
+
+    // The scope is per thread.
+    std::thread other([&]() {
+        EXPECT_EQ(Arena::active(), nullptr);
+        Arena::Scope scope;
+        EXPECT_EQ(Arena::active(), &Arena::threadLocal());
+        EXPECT_EQ((a + b).memoryResource(), &Arena::threadLocal());
+    });
+    {
+        Arena::Scope scope(arena);
+        other.join();
+        EXPECT_EQ(Arena::active(), &arena);
+    }
+}
+
+// Computes a + a, in a scope of its own if scoped is set.
+static DynVector<double> twice(const DynVector<double> &a, bool scoped)
+{
+    if (scoped) {
+        Arena::Scope scope;
+        DynVector<double> result = a + a;
+        return result;
+    }
+    return a + a;
+}
+
+TEST_F(ArenaTest, ReturnedResults)
+{
+    DynVector<double> a(1024, 1.0);
+    DynVector<double> r = twice(a, true);
+    EXPECT_EQ(r.memoryResource(), std::pmr::get_default_resource());
+    {
+        // Reusing the arena does not overwrite the returned result.
+        Arena::Scope scope;
+        DynVector<double> other = a * 7.0;
+        EXPECT_EQ(other.memoryResource(), &Arena::threadLocal());
+        EXPECT_EQ(r, DynVector<double>(1024, 2.0));
+    }
+    EXPECT_EQ(twice(a, false), r);
+}
+
+TEST_F(ArenaTest, NestedScopes)
+{
+    BlockCounter upstream;
+    Arena arena(1 << 16, 4096, &upstream);
+    DynVector<double> a(1024, 3.0);
+    DynVector<double> b(1024, 1.0);
+    {
+        Arena::Scope outer(arena);
+        DynVector<double> x = a + b;
+        DynVector<double> longer(2048, &arena);
+        EXPECT_EQ(x.memoryResource(), &arena);
+        {
+            Arena::Scope inner(arena);
+            // Results of the inner scope are copied into x, whose memory is not rewound when the scope ends.
+            x = a * b;
+            EXPECT_EQ(x.memoryResource(), &arena);
+
+            // Growing an object of the outer scope takes its memory from upstream.
+            size_t allocations = upstream.allocations;
+            longer = DynVector<double>(4096, 2.0);
+            EXPECT_EQ(upstream.allocations, allocations + 1);
+            EXPECT_EQ(longer.memoryResource(), &arena);
+
+            // Move assignments within the inner scope keep the allocation.
+            DynVector<double> y = a - b;
+            DynVector<double> z = a + b;
+            const double *data = y.data();
+            z = std::move(y);
+            EXPECT_EQ(z.data(), data);
+        }
+        DynVector<double> y = a - b;
+        EXPECT_NE(x.data(), y.data());
+        EXPECT_EQ(x, DynVector<double>(1024, 3.0));
+        EXPECT_EQ(y, DynVector<double>(1024, 2.0));
+        EXPECT_EQ(longer, DynVector<double>(4096, 2.0));
+
+        // Results of the same scope are still moved.
+        const double *data = y.data();
+        x = std::move(y);
+        EXPECT_EQ(x.data(), data);
+    }
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(upstream.live, 1u);
+}
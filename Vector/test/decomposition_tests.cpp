@@ -0,0 +1,174 @@
+#define USING_FLOATING_MATRIX_TYPES
+#define USING_DOUBLE_MATRIX_TYPES
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "MathUtils/Vector/Decomposition3.h"
+
+using namespace MathUtils;
+
+class DecompositionTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+// Reference eigenvalues from classic cyclic Jacobi in double precision, run to convergence.
+static Vec3D referenceEigenvalues(Mat3x3D a)
+{
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        for (size_t p = 0; p < 2; ++p) {
+            for (size_t q = p + 1; q < 3; ++q) {
+                if (a(p, q) == 0.0) {
+                    continue;
+                }
+                double theta = (a(q, q) - a(p, p)) / (2.0 * a(p, q));
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (size_t k = 0; k < 3; ++k) {
+                    double akp = a(k, p), akq = a(k, q);
+                    a(k, p) = c * akp - s * akq;
+                    a(k, q) = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < 3; ++k) {
+                    double apk = a(p, k), aqk = a(q, k);
+                    a(p, k) = c * apk - s * aqk;
+                    a(q, k) = s * apk + c * aqk;
+                }
+            }
+        }
+    }
+    std::array<double, 3> values = {a(0, 0), a(1, 1), a(2, 2)};
+    std::sort(values.begin(), values.end());
+    return Vec3D(values);
+}
+
+template<typename T>
+static Matrix<T, 3, 3> getMatrix(int seed)
+{
+    Matrix<T, 3, 3> m;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            m(i, j) = static_cast<T>(std::sin(static_cast<double>(seed * 9 + static_cast<int>(i * 3 + j) + 1)) * 3.0);
+        }
+    }
+    return m;
+}
+
+template<typename T>
+static Matrix<T, 3, 3> getSymmetric(int seed)
+{
+    Matrix<T, 3, 3> m = getMatrix<T>(seed);
+    return m + m.transpose();
+}
+
+template<typename T>
+static void expectRotation(const Matrix<T, 3, 3> &r, T tolerance)
+{
+    Matrix<T, 3, 3> product = r.matMult(r.transpose());
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(product(i, j), i == j ? T(1) : T(0), tolerance);
+        }
+    }
+    EXPECT_NEAR(r.determinant(), T(1), tolerance);
+}
+
+template<typename T>
+static void expectEigen(const Matrix<T, 3, 3> &a, const SymmetricEigen3<T> &eigen, T tolerance)
+{
+    expectRotation(eigen.vectors, tolerance);
+    Matrix<double, 3, 3> reference;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            reference(i, j) = a(i, j);
+        }
+    }
+    Vec3D expected = referenceEigenvalues(reference);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(eigen.values[i], expected[i], tolerance * 10);
+        // A v = lambda v for each column.
+        for (size_t r = 0; r < 3; ++r) {
+            T av = a(r, 0) * eigen.vectors(0, i) + a(r, 1) * eigen.vectors(1, i) + a(r, 2) * eigen.vectors(2, i);
+            EXPECT_NEAR(av, eigen.values[i] * eigen.vectors(r, i), tolerance * 10);
+        }
+    }
+}
+
+template<typename T>
+static void expectSvd(const Matrix<T, 3, 3> &a, const Svd3<T> &svd, T tolerance)
+{
+    expectRotation(svd.u, tolerance);
+    expectRotation(svd.v, tolerance);
+    EXPECT_GE(std::abs(svd.sigma[0]), std::abs(svd.sigma[1]));
+    EXPECT_GE(std::abs(svd.sigma[1]), std::abs(svd.sigma[2]));
+    EXPECT_GE(svd.sigma[1], T(0));
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            T sum = T(0);
+            for (size_t k = 0; k < 3; ++k) {
+                sum += svd.u(i, k) * svd.sigma[k] * svd.v(j, k);
+            }
+            EXPECT_NEAR(sum, a(i, j), tolerance * 10);
+        }
+    }
+}
+
+TEST_F(DecompositionTest, SymmetricEigen)
+{
+    for (int seed = 0; seed < 20; ++seed) {
+        expectEigen(getSymmetric<float>(seed), symmetricEigen(getSymmetric<float>(seed)), 1e-4f);
+        expectEigen(getSymmetric<double>(seed), symmetricEigen(getSymmetric<double>(seed)), 1e-10);
+    }
+    // Already diagonal, with a repeated eigenvalue.
+    Mat3x3F diagonal({{2, 0, 0}, {0, -1, 0}, {0, 0, 2}});
+    SymmetricEigen3<float> eigen = symmetricEigen(diagonal);
+    EXPECT_NEAR(eigen.values[0], -1.0f, 1e-5f);
+    EXPECT_NEAR(eigen.values[2], 2.0f, 1e-5f);
+    expectEigen(diagonal, eigen, 1e-5f);
+}
+
+TEST_F(DecompositionTest, Svd)
+{
+    for (int seed = 0; seed < 20; ++seed) {
+        expectSvd(getMatrix<float>(seed), svd(getMatrix<float>(seed)), 1e-4f);
+        expectSvd(getMatrix<double>(seed), svd(getMatrix<double>(seed)), 1e-10);
+    }
+    // A reflection has a negative last singular value, and a singular matrix a zero one.
+    Mat3x3F reflection({{1, 0, 0}, {0, 1, 0}, {0, 0, -2}});
+    Svd3<float> reflected = svd(reflection);
+    expectSvd(reflection, reflected, 1e-5f);
+    EXPECT_NEAR(reflected.sigma[0], 2.0f, 1e-5f);
+    EXPECT_LT(reflected.sigma[2], 0.0f);
+    Mat3x3F singular({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}});
+    Svd3<float> flat = svd(singular);
+    expectSvd(singular, flat, 1e-4f);
+    EXPECT_NEAR(flat.sigma[2], 0.0f, 1e-4f);
+}
+
+TEST_F(DecompositionTest, Batch)
+{
+    // Not a multiple of any SIMD width, so the last group is partial.
+    constexpr int count = 13;
+    std::vector<Mat3x3F> general, symmetric;
+    for (int seed = 0; seed < count; ++seed) {
+        general.push_back(getMatrix<float>(seed));
+        symmetric.push_back(getSymmetric<float>(seed));
+    }
+    std::vector<Svd3<float>> svds(count);
+    std::vector<SymmetricEigen3<float>> eigens(count);
+    svd(general, std::span<Svd3<float>>(svds));
+    symmetricEigen(symmetric, std::span<SymmetricEigen3<float>>(eigens));
+    for (int i = 0; i < count; ++i) {
+        expectSvd(general[i], svds[i], 1e-4f);
+        expectEigen(symmetric[i], eigens[i], 1e-4f);
+        EXPECT_NEAR(svds[i].sigma[0], svd(general[i]).sigma[0], 1e-5f);
+    }
+}
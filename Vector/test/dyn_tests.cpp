@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+#include "MathUtils/Vector/DynMatrix.h"
+
+using namespace MathUtils;
+
+class DynTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+// A memory resource that counts the allocations it forwards to the default resource.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t live = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        ++live;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+template<size_t N>
+static Vector<double, N> getVector(double offset)
+{
+    Vector<double, N> v;
+    for (size_t i = 0; i < N; ++i) {
+        v[i] = std::sin(static_cast<double>(i) + offset) * 10.0;
+    }
+    return v;
+}
+
+TEST_F(DynTest, VectorArithmetic)
+{
+    DynVector<int> a{1, 2, 3, 4};
+    DynVector<int> b{5, 6, 7, 8};
+    EXPECT_EQ(a.size(), 4u);
+    EXPECT_EQ(a + b, (DynVector<int>{6, 8, 10, 12}));
+    EXPECT_EQ(b - a, (DynVector<int>(4, 4)));
+    EXPECT_EQ(a * b, (DynVector<int>{5, 12, 21, 32}));
+    EXPECT_EQ(b / a, (DynVector<int>{5, 3, 2, 2}));
+    EXPECT_EQ(a * 2, (DynVector<int>{2, 4, 6, 8}));
+    EXPECT_EQ(-a, (DynVector<int>{-1, -2, -3, -4}));
+    EXPECT_EQ(a.madd(b, a), (DynVector<int>{6, 14, 24, 36}));
+    EXPECT_NE(a, DynVector<int>(3));
+
+    a += b;
+    a -= 1;
+    EXPECT_EQ(a, (DynVector<int>{5, 7, 9, 11}));
+    EXPECT_EQ(a.toVector<4>(), (Vector<int, 4>(5, 7, 9, 11)));
+    EXPECT_EQ(DynVector<int>(Vector<int, 3>(1, 2, 3)), (DynVector<int>{1, 2, 3}));
+
+    std::stringstream ss;
+    ss << DynVector<int>{1, 2};
+    EXPECT_EQ(ss.str(), "(1, 2)");
+}
+
+TEST_F(DynTest, ReductionsMatchFixedSize)
+{
+    Vector<double, 3> small = getVector<3>(0.5);
+    Vector<double, 300> large = getVector<300>(0.0);
+    Vector<double, 300> other = getVector<300>(1.0);
+    DynVector<double> dynSmall(small);
+    DynVector<double> dynLarge(large);
+    DynVector<double> dynOther(other);
+
+    // The shared kernels give bit-identical results.
+    EXPECT_EQ(dynSmall.dot(dynSmall), small.dot(small));
+    EXPECT_EQ(dynLarge.dot(dynOther), large.dot(other));
+    EXPECT_EQ(dynLarge.sum(), large.sum());
+    EXPECT_EQ(dynLarge.sum<Summation::Neumaier>(), large.sum<Summation::Neumaier>());
+    EXPECT_EQ(dynLarge.sum<Summation::Deterministic>(), large.sum<Summation::Deterministic>());
+    EXPECT_EQ(dynLarge.dot<Summation::Pairwise>(dynOther), large.dot<Summation::Pairwise>(other));
+    EXPECT_EQ(dynLarge.minElement(), large.minElement());
+    EXPECT_EQ(dynLarge.maxElement(), large.maxElement());
+    EXPECT_EQ(dynLarge.argmin(), large.argmin());
+    EXPECT_EQ(dynLarge.argmax(), large.argmax());
+    EXPECT_EQ(dynLarge.norm<1>(), large.norm<1>());
+    EXPECT_EQ(dynLarge.norm<3>(), large.norm<3>());
+    EXPECT_EQ(dynLarge.norm<InfinityNorm>(), large.norm<InfinityNorm>());
+    EXPECT_EQ(dynLarge.length(), large.length());
+    EXPECT_EQ(dynSmall.product(), small.product());
+
+    // Narrow integers accumulate in the wider type.
+    DynVector<int8_t> bytes(100, int8_t(100));
+    EXPECT_EQ(bytes.dot(bytes), 1000000);
+    EXPECT_EQ(bytes.sum(), 10000);
+}
+
+TEST_F(DynTest, SmallBufferAndMemoryResource)
+{
+    CountingResource counting;
+    constexpr size_t inlineCount = detail::DynStorage<float>::inlineCount;
+
+    DynVector<float> small(inlineCount, 1.0f, &counting);
+    EXPECT_EQ(counting.allocations, 0u);
+    DynVector<float> large(inlineCount + 1, 1.0f, &counting);
+    EXPECT_EQ(counting.allocations, 1u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large.data()) % detail::dynAlignment<float>, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(small.data()) % detail::dynAlignment<float>, 0u);
+
+    // Results are allocated from the left operand's resource.
+    DynVector<float> sum = large + large;
+    EXPECT_EQ(sum.memoryResource(), &counting);
+    EXPECT_EQ(counting.allocations, 2u);
+
+    // Moving between equal resources steals the allocation.
+    const float *elements = sum.data();
+    DynVector<float> moved(std::move(sum));
+    EXPECT_EQ(moved.data(), elements);
+    EXPECT_EQ(counting.allocations, 2u);
+
+    // Moving into a different resource copies.
+    DynVector<float> elsewhere;
+    elsewhere = std::move(moved);
+    EXPECT_EQ(elsewhere.memoryResource(), std::pmr::get_default_resource());
+    EXPECT_NE(elsewhere.data(), elements);
+    EXPECT_EQ(elsewhere, DynVector<float>(inlineCount + 1, 2.0f));
+
+    // Copies use the default resource unless given one.
+    DynVector<float> copy(large);
+    EXPECT_EQ(copy.memoryResource(), std::pmr::get_default_resource());
+    DynVector<float> counted(large, &counting);
+    EXPECT_EQ(counting.allocations, 3u);
+
+    // A monotonic buffer bump allocates all temporaries of an expression.
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    DynVector<double> x(100, 1.5, &arena);
+    DynVector<double> y = (x + x) * 2.0 - x;
+    EXPECT_EQ(y, DynVector<double>(100, 4.5));
+    EXPECT_GE(static_cast<const void *>(y.data()), static_cast<const void *>(buffer));
+    EXPECT_LT(static_cast<const void *>(y.data()), static_cast<const void *>(buffer + sizeof(buffer)));
+
+    copy = DynVector<float>();
+    counted = DynVector<float>();
+    elsewhere = DynVector<float>();
+    moved = DynVector<float>();
+    small = DynVector<float>();
+    large = DynVector<float>();
+    EXPECT_EQ(counting.live, 0u);
+}
+
+TEST_F(DynTest, MatrixArithmetic)
+{
+    DynMatrix<int> a{{1, 2, 3},
+                     {4, 5, 6}};
+    DynMatrix<int> b{{7, 8},
+                     {9, 10},
+                     {11, 12}};
+    EXPECT_EQ(a.rows(), 2u);
+    EXPECT_EQ(a.cols(), 3u);
+    EXPECT_EQ(a(1, 2), 6);
+    EXPECT_EQ(a[1][0], 4);
+
+    EXPECT_EQ(a.matMult(b), (DynMatrix<int>{{58, 64},
+                                            {139, 154}}));
+    EXPECT_EQ(a.matMult(DynVector<int>{1, 0, -1}), (DynVector<int>{-2, -2}));
+    EXPECT_EQ(a.transpose().transpose(), a);
+    EXPECT_EQ(a + a, a * 2);
+    EXPECT_EQ(a - a, DynMatrix<int>(2, 3));
+    EXPECT_EQ(a * a, (DynMatrix<int>{{1, 4, 9},
+                                     {16, 25, 36}}));
+    EXPECT_EQ(DynMatrix<int>::identity(3).matMult(b), b);
+
+    Matrix<int, 2, 3> fixed = a.toMatrix<2, 3>();
+    EXPECT_EQ(DynMatrix<int>(fixed), a);
+    EXPECT_TRUE((fixed.matMult(b.toMatrix<3, 2>()) == a.matMult(b).toMatrix<2, 2>()));
+}
+
+TEST_F(DynTest, LargeMatrixMultiply)
+{
+    constexpr size_t n = 70;
+    DynMatrix<double> a(n, n + 3);
+    DynMatrix<double> b(n + 3, n - 5);
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < a.cols(); ++j) {
+            a(i, j) = std::sin(static_cast<double>(i * 7 + j));
+        }
+    }
+    for (size_t i = 0; i < b.rows(); ++i) {
+        for (size_t j = 0; j < b.cols(); ++j) {
+            b(i, j) = std::cos(static_cast<double>(i + j * 3));
+        }
+    }
+    DynMatrix<double> c = a.matMult(b);
+    for (size_t i = 0; i < n; i += 7) {
+        for (size_t j = 0; j < n - 5; j += 5) {
+            double expected = 0.0;
+            for (size_t k = 0; k < n + 3; ++k) {
+                expected += a(i, k) * b(k, j);
+            }
+            EXPECT_NEAR(c(i, j), expected, 1e-12);
+        }
+    }
+
+    DynMatrix<int8_t> bytes(40, 40);
+    for (size_t i = 0; i < 40; ++i) {
+        for (size_t j = 0; j < 40; ++j) {
+            bytes(i, j) = 127;
+        }
+    }
+    EXPECT_EQ(bytes.matMult(bytes)(3, 5), 40 * 127 * 127);
+}
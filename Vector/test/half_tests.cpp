@@ -0,0 +1,107 @@
+#define USING_HALF_VECTOR_TYPES
+#define USING_BFLOAT16_VECTOR_TYPES
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "MathUtils/Vector/Half.h"
+
+using namespace MathUtils;
+
+class HalfTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+
+TEST_F(HalfTest, HalfRoundTrip)
+{
+    EXPECT_EQ(float16_t(1.0f).bits, 0x3C00);
+    EXPECT_EQ(float16_t(-2.0f).bits, 0xC000);
+    EXPECT_EQ(float16_t(65504.0f).bits, 0x7BFF);
+    EXPECT_EQ(float16_t(1.0e6f).bits, 0x7C00);
+    EXPECT_EQ(float16_t(5.9604645e-8f).bits, 0x0001);
+
+    // 1 + 2^-11 is halfway between 1 and the next half, and rounds to even.
+    EXPECT_EQ(float16_t(1.00048828125f).bits, 0x3C00);
+
+    EXPECT_FLOAT_EQ(float(float16_t::fromBits(0x3555)), 0.333251953125f);
+    EXPECT_FLOAT_EQ(float(float16_t::fromBits(0x0001)), 5.9604645e-8f);
+
+    static_assert(detail::floatToHalfBits(0.5f) == 0x3800);
+    static_assert(detail::halfBitsToFloat(0x3800) == 0.5f);
+}
+
+TEST_F(HalfTest, BFloat16RoundTrip)
+{
+    EXPECT_EQ(bfloat16_t(1.0f).bits, 0x3F80);
+    EXPECT_FLOAT_EQ(float(bfloat16_t(3.140625f)), 3.140625f);
+    EXPECT_FLOAT_EQ(float(bfloat16_t(1.0f + 1.0f / 512.0f)), 1.0f);
+}
+
+TEST_F(HalfTest, VectorArithmetic)
+{
+    Vec3H a(1.0f, 2.0f, 3.0f);
+    Vec3H b(0.5f, 0.5f, 0.5f);
+
+    Vec3H sum = a + b;
+    EXPECT_FLOAT_EQ(float(sum[2]), 3.5f);
+    EXPECT_EQ(sizeof(Vec3H), 3 * sizeof(uint16_t));
+
+    float dot = a.dot(b);
+    EXPECT_FLOAT_EQ(dot, 3.0f);
+
+    Vec4BF16 c(1.0f, -2.0f, 4.0f, 8.0f);
+    EXPECT_FLOAT_EQ(c.sum(), 11.0f);
+    EXPECT_FLOAT_EQ(c.norm<InfinityNorm>(), 8.0f);
+}
+
+TEST_F(HalfTest, BatchConversion)
+{
+    std::vector<float> values(37);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<float>(i) * 0.25f - 3.0f;
+    }
+
+    std::vector<float16_t> halves(values.size());
+    std::vector<float> widened(values.size());
+    convertFromFloat(values, halves);
+    convertToFloat(halves, widened);
+    EXPECT_EQ(values, widened);
+
+    std::vector<bfloat16_t> bhalves(values.size());
+    convertFromFloat(values, bhalves);
+    convertToFloat(bhalves, widened);
+    EXPECT_EQ(values, widened);
+
+    Vector<float16_t, 20> v(float16_t(1.5f));
+    EXPECT_EQ(toFloat(v), (Vector<float, 20>(1.5f)));
+}
+
+TEST_F(HalfTest, BlockedReductions)
+{
+    // Large reductions widen blocks of elements at a time, and sum the widened terms in the same order as float does.
+    constexpr size_t n = 1003;
+    Vector<float16_t, n> a;
+    Vector<float16_t, n> b;
+    Vector<bfloat16_t, n> c;
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = float16_t(static_cast<float>(i % 17) * 0.125f - 1.0f);
+        b[i] = float16_t(static_cast<float>(i % 5) * 0.5f + 0.25f);
+        c[i] = bfloat16_t(static_cast<float>(i % 11) * 0.375f - 2.0f);
+    }
+    Vector<float, n> wideA = toFloat(a);
+    Vector<float, n> wideB = toFloat(b);
+    Vector<float, n> wideC = toFloat(c);
+
+    EXPECT_EQ(a.dot(b), wideA.dot(wideB));
+    EXPECT_EQ(a.dot<Summation::Widened>(b), wideA.dot<Summation::Widened>(wideB));
+    EXPECT_EQ(a.sum<Summation::Deterministic>(), wideA.sum<Summation::Deterministic>());
+    EXPECT_EQ(c.sum(), wideC.sum());
+    EXPECT_EQ(c.squaredLength(), wideC.squaredLength());
+    EXPECT_FLOAT_EQ(c.sum<Summation::Kahan>(), wideC.sum<Summation::Kahan>());
+}
@@ -0,0 +1,239 @@
+#define USING_DOUBLE_SPARSE_TYPES
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "MathUtils/Vector/IterativeSolvers.h"
+
+using namespace MathUtils;
+
+class IterativeTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+/**
+ * The 5-point finite difference matrix of -div(grad u) + c . grad(u) on a side x side grid. Symmetric positive definite
+ * when c is 0.
+ */
+static SparseMatrixD getGridMatrix(size_t side, double convection = 0.0)
+{
+    std::vector<Triplet<double>> triplets;
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            size_t i = y * side + x;
+            triplets.push_back({i, i, 4.0});
+            if (x > 0) {
+                triplets.push_back({i, i - 1, -1.0 - convection});
+            }
+            if (x + 1 < side) {
+                triplets.push_back({i, i + 1, -1.0 + convection});
+            }
+            if (y > 0) {
+                triplets.push_back({i, i - side, -1.0 - 0.5 * convection});
+            }
+            if (y + 1 < side) {
+                triplets.push_back({i, i + side, -1.0 + 0.5 * convection});
+            }
+        }
+    }
+    return SparseMatrixD::fromTriplets(side * side, side * side, triplets);
+}
+
+static std::vector<double> getSolution(size_t n)
+{
+    std::vector<double> solution(n);
+    for (size_t i = 0; i < n; ++i) {
+        solution[i] = std::sin(static_cast<double>(i) * 0.3) + 0.5;
+    }
+    return solution;
+}
+
+// Checks x against the solution b was made from, and the residual the solver reported.
+template<typename A>
+static void expectSolved(const A &a, const std::vector<double> &solution, const std::vector<double> &x,
+                         const SolverResult<double> &result, double tolerance)
+{
+    EXPECT_TRUE(result.converged);
+    EXPECT_LE(result.residual, tolerance);
+    std::vector<double> ax(x.size());
+    detail::applyOperator(a, std::span<const double>(x), std::span<double>(ax));
+    std::vector<double> b(x.size());
+    detail::applyOperator(a, std::span<const double>(solution), std::span<double>(b));
+    double residual = 0.0;
+    double bNorm = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        residual += (ax[i] - b[i]) * (ax[i] - b[i]);
+        bNorm += b[i] * b[i];
+    }
+    EXPECT_LE(std::sqrt(residual / bNorm), tolerance * 10);
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_NEAR(x[i], solution[i], 1e-6);
+    }
+}
+
+TEST_F(IterativeTest, ConjugateGradient)
+{
+    SparseMatrixD a = getGridMatrix(30);
+    std::vector<double> solution = getSolution(a.rows());
+    std::vector<double> b(a.rows());
+    a.multiply(solution, b);
+    SolverOptions<double> options{1000, 1e-10};
+
+    std::vector<double> x(a.rows(), 0.0);
+    SolverResult<double> plain = conjugateGradient(a, b, std::span<double>(x), options);
+    expectSolved(a, solution, x, plain, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> jacobi = conjugateGradient(a, b, std::span<double>(x), options,
+                                                    JacobiPreconditioner<double>(a));
+    expectSolved(a, solution, x, jacobi, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> block = conjugateGradient(a, b, std::span<double>(x), options,
+                                                   BlockJacobiPreconditioner<double, 6>(a));
+    expectSolved(a, solution, x, block, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    IncompleteCholeskyPreconditioner<double> ic(a);
+    EXPECT_TRUE(ic.positiveDefinite());
+    SolverResult<double> cholesky = conjugateGradient(a, b, std::span<double>(x), options, ic);
+    expectSolved(a, solution, x, cholesky, 1e-10);
+
+    EXPECT_LT(block.iterations, plain.iterations);
+    EXPECT_LT(cholesky.iterations, plain.iterations);
+
+    // Starting from the solution takes no iterations.
+    SolverResult<double> done = conjugateGradient(a, b, std::span<double>(x), SolverOptions<double>{1000, 1e-6}, ic);
+    EXPECT_EQ(done.iterations, 0u);
+    EXPECT_TRUE(done.converged);
+
+    // A zero right hand side has the solution 0.
+    std::vector<double> zero(a.rows(), 0.0);
+    EXPECT_TRUE(conjugateGradient(a, zero, std::span<double>(x)).converged);
+    EXPECT_EQ(x, zero);
+
+    // Running out of iterations is reported.
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> limited = conjugateGradient(a, b, std::span<double>(x), SolverOptions<double>{3, 1e-10});
+    EXPECT_EQ(limited.iterations, 3u);
+    EXPECT_FALSE(limited.converged);
+}
+
+TEST_F(IterativeTest, IncompleteCholeskyIsExactWithoutFillIn)
+{
+    // A tridiagonal matrix has no fill-in, so IC(0) is its exact Cholesky factor.
+    std::vector<Triplet<double>> triplets;
+    for (size_t i = 0; i < 8; ++i) {
+        triplets.push_back({i, i, 3.0 + static_cast<double>(i)});
+        if (i > 0) {
+            triplets.push_back({i, i - 1, -1.0});
+            triplets.push_back({i - 1, i, -1.0});
+        }
+    }
+    SparseMatrixD a = SparseMatrixD::fromTriplets(8, 8, triplets);
+    IncompleteCholeskyPreconditioner<double> ic(a);
+    Matrix<double, 8, 8> l = a.toDense<8, 8>().cholesky().matrixL();
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            EXPECT_NEAR(ic.matrixL()(i, j), l(i, j), 1e-12);
+        }
+    }
+    std::vector<double> solution = getSolution(8);
+    std::vector<double> b(8);
+    a.multiply(solution, b);
+    std::vector<double> x(8);
+    ic.apply(b, x);
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_NEAR(x[i], solution[i], 1e-12);
+    }
+}
+
+TEST_F(IterativeTest, BiCgStab)
+{
+    SparseMatrixD a = getGridMatrix(30, 0.4);
+    std::vector<double> solution = getSolution(a.rows());
+    std::vector<double> b(a.rows());
+    a.multiply(solution, b);
+    SolverOptions<double> options{1000, 1e-10};
+
+    std::vector<double> x(a.rows(), 0.0);
+    SolverResult<double> plain = biCgStab(a, b, std::span<double>(x), options);
+    expectSolved(a, solution, x, plain, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> jacobi = biCgStab(a, b, std::span<double>(x), options, JacobiPreconditioner<double>(a));
+    expectSolved(a, solution, x, jacobi, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> block = biCgStab(a, b, std::span<double>(x), options, BlockJacobiPreconditioner<double, 4>(a));
+    expectSolved(a, solution, x, block, 1e-10);
+    EXPECT_LT(block.iterations, plain.iterations);
+}
+
+TEST_F(IterativeTest, Gmres)
+{
+    SparseMatrixD a = getGridMatrix(30, 0.4);
+    std::vector<double> solution = getSolution(a.rows());
+    std::vector<double> b(a.rows());
+    a.multiply(solution, b);
+    SolverOptions<double> options{2000, 1e-10};
+
+    std::vector<double> x(a.rows(), 0.0);
+    SolverResult<double> plain = gmres(a, b, std::span<double>(x), options);
+    expectSolved(a, solution, x, plain, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> restarted = gmres(a, b, std::span<double>(x), options, IdentityPreconditioner<double>(), 5);
+    expectSolved(a, solution, x, restarted, 1e-10);
+
+    std::fill(x.begin(), x.end(), 0.0);
+    SolverResult<double> block = gmres(a, b, std::span<double>(x), options, BlockJacobiPreconditioner<double, 30>(a),
+                                       20);
+    expectSolved(a, solution, x, block, 1e-10);
+    EXPECT_LT(block.iterations, plain.iterations);
+}
+
+TEST_F(IterativeTest, DenseAndMatrixFreeOperators)
+{
+    // A dense nonsymmetric, diagonally dominant matrix.
+    Matrix<double, 12, 12> dense;
+    for (size_t i = 0; i < 12; ++i) {
+        for (size_t j = 0; j < 12; ++j) {
+            dense(i, j) = i == j ? 20.0 : std::sin(static_cast<double>(i * 12 + j));
+        }
+    }
+    std::vector<double> solution = getSolution(12);
+    std::vector<double> b(12);
+    detail::applyOperator(dense, std::span<const double>(solution), std::span<double>(b));
+    SolverOptions<double> options{100, 1e-12};
+
+    std::vector<double> x(12, 0.0);
+    SolverResult<double> result = biCgStab(dense, b, std::span<double>(x), options,
+                                           JacobiPreconditioner<double>(dense));
+    expectSolved(dense, solution, x, result, 1e-12);
+    std::fill(x.begin(), x.end(), 0.0);
+    result = gmres(dense, b, std::span<double>(x), options, BlockJacobiPreconditioner<double, 5>(dense));
+    expectSolved(dense, solution, x, result, 1e-12);
+
+    // The 1D Laplacian without storing it.
+    constexpr size_t n = 200;
+    auto laplacian = [](std::span<const double> in, std::span<double> out) {
+        for (size_t i = 0; i < in.size(); ++i) {
+            out[i] = 2.0 * in[i] - (i > 0 ? in[i - 1] : 0.0) - (i + 1 < in.size() ? in[i + 1] : 0.0);
+        }
+    };
+    solution = getSolution(n);
+    b.resize(n);
+    laplacian(solution, b);
+    x.assign(n, 0.0);
+    result = conjugateGradient(laplacian, b, std::span<double>(x), SolverOptions<double>{1000, 1e-12});
+    expectSolved(laplacian, solution, x, result, 1e-12);
+    // CG is exact after n steps in exact arithmetic and needs about n/2 here.
+    EXPECT_LE(result.iterations, n);
+}
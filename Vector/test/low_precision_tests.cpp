@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "MathUtils/Vector/LowPrecisionGemm.h"
+
+using namespace MathUtils;
+
+class LowPrecisionTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+static std::vector<int8_t> getInt8(size_t count, size_t seed)
+{
+    std::vector<int8_t> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<int8_t>(static_cast<int32_t>((i * 37 + seed * 11) % 255) - 127);
+    }
+    return values;
+}
+
+static std::vector<float> getFloats(size_t count, double seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>(std::sin(seed + static_cast<double>(i) * 0.7));
+    }
+    return values;
+}
+
+TEST_F(LowPrecisionTest, Int8Gemm)
+{
+    // k covers the 64 and 32 byte kernels and the scalar tail, m a full column tile and a partial one.
+    constexpr size_t n = 5;
+    constexpr size_t k = 101;
+    constexpr size_t m = 7;
+    std::vector<int8_t> a = getInt8(n * k, 1);
+    std::vector<int8_t> bt = getInt8(m * k, 2);
+    std::vector<int32_t> expected(n * m);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t p = 0; p < k; ++p) {
+                expected[i * m + j] += static_cast<int32_t>(a[i * k + p]) * static_cast<int32_t>(bt[j * k + p]);
+            }
+        }
+    }
+
+    std::vector<int32_t> c(n * m);
+    gemmInt8(n, k, m, a, bt, std::span<int32_t>(c));
+    EXPECT_EQ(c, expected);
+
+    // The largest products do not saturate.
+    std::vector<int8_t> large(2 * 64, 127);
+    std::fill(large.begin() + 64, large.end(), -127);
+    std::vector<int32_t> extremes(4);
+    gemmInt8(2, 64, 2, large, large, std::span<int32_t>(extremes));
+    EXPECT_EQ(extremes, (std::vector<int32_t>{64 * 127 * 127, -64 * 127 * 127, -64 * 127 * 127, 64 * 127 * 127}));
+
+    // -128 is multiplied exactly as well.
+    std::vector<int8_t> lowest(4 * 64, -128);
+    std::vector<int32_t> squares(4);
+    gemmInt8(1, 64, 4, std::span(lowest).first(64), lowest, std::span<int32_t>(squares));
+    EXPECT_EQ(squares, std::vector<int32_t>(4, 64 * 128 * 128));
+}
+
+TEST_F(LowPrecisionTest, Requantization)
+{
+    constexpr size_t n = 3;
+    constexpr size_t k = 40;
+    constexpr size_t m = 6;
+    std::vector<float> x = getFloats(n * k, 0.0);
+    std::vector<float> w = getFloats(m * k, 1.0);
+    std::vector<float> bias = getFloats(m, 2.0);
+
+    // Per-row scales for the activations and per-column scales for the weights.
+    std::vector<float> rowScales(n);
+    std::vector<float> colScales(m);
+    std::vector<int8_t> qx(n * k);
+    std::vector<int8_t> qw(m * k);
+    for (size_t i = 0; i < n; ++i) {
+        auto row = std::span<const float>(x).subspan(i * k, k);
+        rowScales[i] = std::abs(*std::max_element(row.begin(), row.end(), [](float p, float q) {
+            return std::abs(p) < std::abs(q);
+        })) / static_cast<float>(QuantizedMax);
+        quantize(row, rowScales[i], 0, std::span(qx).subspan(i * k, k));
+    }
+    for (size_t j = 0; j < m; ++j) {
+        auto row = std::span<const float>(w).subspan(j * k, k);
+        colScales[j] = std::abs(*std::max_element(row.begin(), row.end(), [](float p, float q) {
+            return std::abs(p) < std::abs(q);
+        })) / static_cast<float>(QuantizedMax);
+        quantize(row, colScales[j], 0, std::span(qw).subspan(j * k, k));
+    }
+
+    DequantizeEpilogue dequantize{rowScales, colScales, bias};
+    std::vector<float> y(n * m);
+    gemmInt8(n, k, m, qx, qw, std::span<float>(y), dequantize);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            float exact = bias[j];
+            for (size_t p = 0; p < k; ++p) {
+                exact += x[i * k + p] * w[j * k + p];
+            }
+            EXPECT_NEAR(y[i * m + j], exact, 0.1f);
+        }
+    }
+
+    RequantizeEpilogue requantize{dequantize, 0.05f, 3};
+    std::vector<int8_t> q(n * m);
+    gemmInt8(n, k, m, qx, qw, std::span<int8_t>(q), requantize);
+    std::vector<int8_t> expected(n * m);
+    quantize(y, 0.05f, 3, expected);
+    EXPECT_EQ(q, expected);
+}
+
+TEST_F(LowPrecisionTest, HalfPrecisionGemm)
+{
+    constexpr size_t n = 6;
+    constexpr size_t k = 33;
+    constexpr size_t m = 19;
+    std::vector<float> a = getFloats(n * k, 0.0);
+    std::vector<float> b = getFloats(k * m, 3.0);
+    std::vector<float16_t> ha(n * k);
+    std::vector<float16_t> hb(k * m);
+    std::vector<bfloat16_t> ba(n * k);
+    std::vector<bfloat16_t> bb(k * m);
+    convertFromFloat(a, ha);
+    convertFromFloat(b, hb);
+    convertFromFloat(a, ba);
+    convertFromFloat(b, bb);
+
+    // The exact product of the rounded inputs, which float accumulation should match closely.
+    auto reference = [&](auto &left, auto &right, size_t i, size_t j) {
+        double sum = 0.0;
+        for (size_t p = 0; p < k; ++p) {
+            sum += static_cast<double>(static_cast<float>(left[i * k + p])) *
+                   static_cast<double>(static_cast<float>(right[p * m + j]));
+        }
+        return sum;
+    };
+
+    std::vector<float> c(n * m, 1.0f);
+    gemm(n, k, m, 2.0f, ha, hb, 0.5f, std::span<float>(c));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            EXPECT_NEAR(c[i * m + j], 2.0 * reference(ha, hb, i, j) + 0.5, 1e-4);
+        }
+    }
+
+    std::vector<float> relu(n * m);
+    gemm(n, k, m, 1.0f, ba, bb, 0.0f, std::span<float>(relu), [](float v) { return v > 0.0f ? v : 0.0f; });
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            EXPECT_NEAR(relu[i * m + j], std::max(reference(ba, bb, i, j), 0.0), 1e-4);
+        }
+    }
+
+    // Half precision outputs are rounded once, from the float sums.
+    std::vector<float16_t> h(n * m);
+    gemm(n, k, m, 1.0f, ha, hb, 0.0f, std::span<float16_t>(h));
+    std::vector<float> sums(n * m);
+    gemm(n, k, m, 1.0f, ha, hb, 0.0f, std::span<float>(sums));
+    for (size_t i = 0; i < n * m; ++i) {
+        EXPECT_EQ(h[i].bits, float16_t(sums[i]).bits);
+    }
+}
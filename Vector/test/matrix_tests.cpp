@@ -1,7 +1,12 @@
 
 #define USING_INT64_MATRIX_TYPES
+#define USING_FLOATING_MATRIX_TYPES
+#define USING_DOUBLE_MATRIX_TYPES
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
 #include "MathUtils/Vector/Matrix.h"
 
 using namespace MathUtils;
@@ -80,4 +85,593 @@ TEST_F(MatrixTest, MatrixMultiply)
 
     EXPECT_EQ(result, expected);
     EXPECT_NE(result, Mat2x4I64());
-}
\ No newline at end of file
+}
+TEST_F(MatrixTest, MatrixMultiplyWidensNarrowTypes)
+{
+    int8_t data[2][2] = {
+            {100, 100},
+            {-100, 100}
+    };
+    Matrix<int8_t, 2, 2> m(data);
+
+    Matrix<int32_t, 2, 2> result = m.matMult(m);
+
+    int32_t expectedData[2][2] = {
+            {0, 20000},
+            {-20000, 0}
+    };
+    EXPECT_EQ(result, (Matrix<int32_t, 2, 2>(expectedData)));
+}
+
+template<typename T, size_t N>
+static void expectIdentity(const Matrix<T, N, N> &m, T tolerance)
+{
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            EXPECT_NEAR(m(i, j), i == j ? T(1) : T(0), tolerance);
+        }
+    }
+}
+
+// A well conditioned matrix with a dominant diagonal.
+template<typename T, size_t N>
+static Matrix<T, N, N> getInvertible()
+{
+    Matrix<T, N, N> m;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            m(i, j) = i == j ? T(N + 2) : T((i * 7 + j * 3) % 5) - T(2);
+        }
+    }
+    return m;
+}
+
+TEST_F(MatrixTest, Transpose)
+{
+    Mat2x3I64 m({{1, 2, 3}, {4, 5, 6}});
+    Matrix<int64_t, 3, 2> expected({{1, 4}, {2, 5}, {3, 6}});
+    EXPECT_EQ(m.transpose(), expected);
+    EXPECT_EQ(m.transpose().transpose(), m);
+}
+
+TEST_F(MatrixTest, Determinant)
+{
+    EXPECT_EQ(Mat2x2I64({{3, 8}, {4, 6}}).determinant(), -14);
+    EXPECT_EQ(Mat3x3I64({{6, 1, 1}, {4, -2, 5}, {2, 8, 7}}).determinant(), -306);
+    EXPECT_EQ(getMatrix().determinant(), 0);
+    EXPECT_EQ(Mat4x4I64({{1, 0, 2, -1}, {3, 0, 0, 5}, {2, 1, 4, -3}, {1, 0, 5, 0}}).determinant(), 30);
+
+    // The elimination path agrees with the cofactor expansion on a block diagonal matrix.
+    Matrix<double, 6, 6> big;
+    Mat3x3D block({{6, 1, 1}, {4, -2, 5}, {2, 8, 7}});
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            big(i, j) = block(i, j);
+            big(i + 3, j + 3) = block(i, j);
+        }
+    }
+    EXPECT_NEAR(big.determinant(), 306.0 * 306.0, 1e-6);
+}
+
+TEST_F(MatrixTest, Inverse)
+{
+    Mat2x2D m2 = getInvertible<double, 2>();
+    Mat3x3D m3 = getInvertible<double, 3>();
+    Mat4x4D m4 = getInvertible<double, 4>();
+    Mat4x4F m4f = getInvertible<float, 4>();
+    Matrix<double, 7, 7> m7 = getInvertible<double, 7>();
+
+    expectIdentity(m2.matMult(*m2.inverse()), 1e-12);
+    expectIdentity(m3.matMult(*m3.inverse()), 1e-12);
+    expectIdentity(m4.matMult(*m4.inverse()), 1e-12);
+    expectIdentity(m4f.matMult(*m4f.inverse()), 1e-5f);
+    expectIdentity(m7.matMult(*m7.inverse()), 1e-12);
+
+    // A permutation needs pivoting on the elimination path.
+    Matrix<double, 5, 5> permutation;
+    for (size_t i = 0; i < 5; ++i) {
+        permutation(i, (i + 2) % 5) = 1.0;
+    }
+    EXPECT_EQ(*permutation.inverse(), permutation.transpose());
+
+    EXPECT_FALSE(Mat3x3D({{1, 2, 3}, {2, 4, 6}, {0, 1, 1}}).inverse());
+    Mat4x4F singular = m4f;
+    singular[3] = singular[0] * 2.0f;
+    EXPECT_FALSE(singular.inverse());
+    Matrix<double, 5, 5> singularBig;
+    EXPECT_FALSE(singularBig.inverse());
+}
+
+template<size_t N>
+static void expectBatchInverse()
+{
+    // Not a multiple of the SIMD width, with singular matrices in the first and last groups.
+    std::vector<Matrix<double, N, N>> matrices(11, getInvertible<double, N>());
+    for (size_t m = 0; m < matrices.size(); ++m) {
+        matrices[m](0, N - 1) += 0.5 * double(m);
+    }
+    matrices[1] = Matrix<double, N, N>();
+    matrices[10] = Matrix<double, N, N>();
+    std::vector<Matrix<double, N, N>> inverses(matrices.size());
+
+    EXPECT_EQ(inverse(matrices, std::span<Matrix<double, N, N>>(inverses)), 2u);
+    EXPECT_EQ(inverses[1], (Matrix<double, N, N>()));
+    EXPECT_EQ(inverses[10], (Matrix<double, N, N>()));
+    for (size_t m = 0; m < matrices.size(); ++m) {
+        if (m != 1 && m != 10) {
+            expectIdentity(matrices[m].matMult(inverses[m]), 1e-12);
+        }
+    }
+}
+
+TEST_F(MatrixTest, BatchInverse)
+{
+    Mat4x4F m = getInvertible<float, 4>();
+    std::vector<Mat4x4F> matrices(5, m);
+    matrices[2] = Mat4x4F();
+    std::vector<Mat4x4F> inverses(matrices.size());
+
+    EXPECT_EQ(inverse(matrices, std::span<Mat4x4F>(inverses)), 1u);
+    EXPECT_EQ(inverses[2], Mat4x4F());
+    expectIdentity(m.matMult(inverses[4]), 1e-5f);
+
+    // Every size of the interleaved adjugate kernel, and the LU path.
+    expectBatchInverse<1>();
+    expectBatchInverse<2>();
+    expectBatchInverse<3>();
+    expectBatchInverse<4>();
+    expectBatchInverse<6>();
+}
+
+TEST_F(MatrixTest, LUSolve)
+{
+    Mat3x3D m({{2, 1, 1}, {4, -6, 0}, {-2, 7, 2}});
+    LU<double, 3> lu = m.lu();
+    EXPECT_FALSE(lu.singular());
+    EXPECT_NEAR(lu.determinant(), m.determinant(), 1e-12);
+
+    Vec3D x = lu.solve(Vec3D(5.0, -2.0, 9.0));
+    Matrix<double, 3, 1> b = m.matMult(x);
+    EXPECT_NEAR(b(0, 0), 5.0, 1e-12);
+    EXPECT_NEAR(b(1, 0), -2.0, 1e-12);
+    EXPECT_NEAR(b(2, 0), 9.0, 1e-12);
+
+    Matrix<double, 3, 2> rhs({{1, 0}, {0, 1}, {3, -2}});
+    Matrix<double, 3, 2> solved = lu.solve(rhs);
+    Matrix<double, 3, 2> product = m.matMult(solved);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(product(i, 0), rhs(i, 0), 1e-12);
+        EXPECT_NEAR(product(i, 1), rhs(i, 1), 1e-12);
+    }
+
+    EXPECT_TRUE(Mat3x3D({{1, 2, 3}, {2, 4, 6}, {0, 1, 1}}).lu().singular());
+}
+
+TEST_F(MatrixTest, BlockedLU)
+{
+    // Spans several panels with a partial last one, and is large enough to split the trailing update across threads.
+    constexpr size_t n = 300;
+    auto m = std::make_unique<Matrix<double, n, n>>(getInvertible<double, n>());
+    // Small leading pivots force row swaps in every panel.
+    for (size_t i = 0; i < n; i += 7) {
+        (*m)(i, i) = 1e-3;
+    }
+    auto lu = std::make_unique<LU<double, n>>(*m);
+    EXPECT_FALSE(lu->singular());
+
+    // P A = L U
+    const Matrix<double, n, n> &packed = lu->packed();
+    for (size_t i = 0; i < n; i += 13) {
+        for (size_t j = 0; j < n; j += 11) {
+            double sum = 0.0;
+            for (size_t k = 0; k <= std::min(i, j); ++k) {
+                sum += (k == i ? 1.0 : packed(i, k)) * packed(k, j);
+            }
+            EXPECT_NEAR(sum, (*m)(lu->rowPermutation()[i], j), 1e-9);
+        }
+    }
+
+    Vector<double, n> expected(1.0);
+    Vector<double, n> b;
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = (*m)[i].sum();
+    }
+    Vector<double, n> x = lu->solve(b);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(x[i], 1.0, 1e-9);
+    }
+}
+
+TEST_F(MatrixTest, LargeInverse)
+{
+    // 8 MB, as large as the whole stack on common platforms, so no N x N temporary may be placed on it.
+    constexpr size_t n = 1024;
+    auto m = std::make_unique<Matrix<double, n, n>>();
+    for (size_t i = 0; i < n; ++i) {
+        (*m)(i, i) = i < 10 ? 2.0 : 1.0;
+        for (size_t j = i + 1; j < n; ++j) {
+            (*m)(i, j) = ((i * 7 + j * 3) % 5 == 0) ? 1e-3 : 0.0;
+        }
+    }
+    // Upper triangular, so the determinant is the product of the diagonal.
+    EXPECT_DOUBLE_EQ(m->determinant(), 1024.0);
+
+    // Initialized directly from the returned prvalue, as make_unique would materialize it on the stack first.
+    std::unique_ptr<std::optional<Matrix<double, n, n>>> inverse(new std::optional(m->inverse()));
+    ASSERT_TRUE(inverse->has_value());
+    const Matrix<double, n, n> &inv = **inverse;
+    for (size_t i = 0; i < n; i += 37) {
+        for (size_t j = 0; j < n; j += 41) {
+            double sum = 0.0;
+            for (size_t k = 0; k < n; ++k) {
+                sum += (*m)(i, k) * inv(k, j);
+            }
+            EXPECT_NEAR(sum, i == j ? 1.0 : 0.0, 1e-12);
+        }
+    }
+}
+
+// B B^T + N I, which is symmetric positive definite.
+template<typename T, size_t N>
+static Matrix<T, N, N> getSpd()
+{
+    Matrix<T, N, N> b = getInvertible<T, N>();
+    Matrix<T, N, N> spd = b.matMult(b.transpose());
+    for (size_t i = 0; i < N; ++i) {
+        spd(i, i) += T(N);
+    }
+    return spd;
+}
+
+template<size_t N>
+static void expectSymmetricSolves()
+{
+    Matrix<double, N, N> a = getSpd<double, N>();
+    Cholesky<double, N> cholesky = a.cholesky();
+    LDLT<double, N> ldlt = a.ldlt();
+    ASSERT_TRUE(cholesky.positiveDefinite());
+    ASSERT_FALSE(ldlt.singular());
+
+    const Matrix<double, N, N> &l = cholesky.matrixL();
+    Matrix<double, N, N> product = l.matMult(l.transpose());
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            EXPECT_NEAR(product(i, j), a(i, j), 1e-9 * a(i, i));
+        }
+        EXPECT_EQ(l(0, i), i == 0 ? l(0, 0) : 0.0);
+    }
+
+    Vector<double, N> b;
+    for (size_t i = 0; i < N; ++i) {
+        b[i] = a[i].sum();
+    }
+    Vector<double, N> x = cholesky.solve(b);
+    Vector<double, N> y = ldlt.solve(b);
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_NEAR(x[i], 1.0, 1e-9);
+        EXPECT_NEAR(y[i], 1.0, 1e-9);
+    }
+}
+
+TEST_F(MatrixTest, CholeskyAndLDLT)
+{
+    // Unrolled and blocked kernels, the latter over several panels.
+    expectSymmetricSolves<6>();
+    expectSymmetricSolves<150>();
+
+    Mat3x3D spd = getSpd<double, 3>();
+    EXPECT_NEAR(spd.cholesky().determinant(), spd.determinant(), 1e-9);
+    EXPECT_NEAR(spd.ldlt().determinant(), spd.determinant(), 1e-9);
+    expectIdentity(spd.matMult(spd.ldlt().inverse()), 1e-12);
+
+    // Indefinite: LDLT handles it, Cholesky does not.
+    Mat2x2D indefinite({{1, 2}, {2, 1}});
+    EXPECT_FALSE(indefinite.cholesky().positiveDefinite());
+    EXPECT_FALSE(indefinite.ldlt().singular());
+    EXPECT_NEAR(indefinite.ldlt().vectorD()[1], -3.0, 1e-12);
+    EXPECT_FALSE((Matrix<double, 12, 12>().cholesky().positiveDefinite()));
+}
+
+template<size_t N>
+static void expectBatchSymmetric()
+{
+    // Not a multiple of the SIMD width, with one indefinite and one zero matrix in different groups.
+    std::vector<Matrix<double, N, N>> matrices(11, getSpd<double, N>());
+    for (size_t m = 0; m < matrices.size(); ++m) {
+        matrices[m](0, 0) += double(m);
+        matrices[m](N - 1, 0) += 0.1 * double(m);
+    }
+    matrices[3](1, 1) = -matrices[3](1, 1);
+    matrices[9] = Matrix<double, N, N>();
+    std::vector<Matrix<double, N, N>> lower(matrices.size());
+    std::vector<Matrix<double, N, N>> packed(matrices.size());
+
+    EXPECT_EQ(cholesky(matrices, std::span<Matrix<double, N, N>>(lower)), 2u);
+    EXPECT_EQ(ldlt(matrices, std::span<Matrix<double, N, N>>(packed)), 1u);
+    for (size_t m = 0; m < matrices.size(); ++m) {
+        if (m == 3 || m == 9) {
+            continue;
+        }
+        Matrix<double, N, N> expectedL = matrices[m].cholesky().matrixL();
+        Matrix<double, N, N> expectedPacked = matrices[m].ldlt().packed();
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                EXPECT_NEAR(lower[m](i, j), expectedL(i, j), 1e-12);
+                EXPECT_NEAR(packed[m](i, j), expectedPacked(i, j), 1e-12);
+            }
+        }
+    }
+}
+
+TEST_F(MatrixTest, BatchCholeskyAndLDLT)
+{
+    // Interleaved unrolled kernel and the blocked one.
+    expectBatchSymmetric<5>();
+    expectBatchSymmetric<10>();
+}
+
+TEST_F(MatrixTest, SymmetricRankOneUpdate)
+{
+    Matrix<double, 5, 5> a = getSpd<double, 5>();
+    Vector<double, 5> v(1.0, -2.0, 0.5, 3.0, 1.5);
+    Matrix<double, 5, 5> updated = a;
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+            updated(i, j) += v[i] * v[j];
+        }
+    }
+
+    Cholesky<double, 5> cholesky = a.cholesky();
+    cholesky.update(v);
+    LDLT<double, 5> ldlt = a.ldlt();
+    EXPECT_TRUE(ldlt.rankUpdate(v));
+    Cholesky<double, 5> expected = updated.cholesky();
+    LDLT<double, 5> expectedLdlt = updated.ldlt();
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            EXPECT_NEAR(cholesky.matrixL()(i, j), expected.matrixL()(i, j), 1e-9);
+            EXPECT_NEAR(ldlt.packed()(i, j), expectedLdlt.packed()(i, j), 1e-9);
+        }
+    }
+
+    // Downdating takes it back.
+    EXPECT_TRUE(cholesky.downdate(v));
+    EXPECT_TRUE(ldlt.rankUpdate(v, -1.0));
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            EXPECT_NEAR(cholesky.matrixL()(i, j), a.cholesky().matrixL()(i, j), 1e-9);
+            EXPECT_NEAR(ldlt.packed()(i, j), a.ldlt().packed()(i, j), 1e-9);
+        }
+    }
+
+    // A downdate that leaves the matrix indefinite fails.
+    EXPECT_FALSE(cholesky.downdate(v * 100.0));
+    EXPECT_FALSE(cholesky.positiveDefinite());
+}
+
+TEST_F(MatrixTest, BatchCholesky)
+{
+    std::vector<Matrix<float, 6, 6>> matrices(9, getSpd<float, 6>());
+    matrices[4] = Matrix<float, 6, 6>();
+    std::vector<Matrix<float, 6, 6>> lower(matrices.size());
+    std::vector<Matrix<float, 6, 6>> packed(matrices.size());
+
+    EXPECT_EQ(cholesky(matrices, std::span<Matrix<float, 6, 6>>(lower)), 1u);
+    EXPECT_EQ(ldlt(matrices, std::span<Matrix<float, 6, 6>>(packed)), 1u);
+    // The interleaved kernel may round differently where the compiler contracts the scalar one into FMAs.
+    Matrix<float, 6, 6> expectedL = matrices[0].cholesky().matrixL();
+    Matrix<float, 6, 6> expectedPacked = matrices[8].ldlt().packed();
+    for (size_t i = 0; i < 6; ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            EXPECT_NEAR(lower[0](i, j), expectedL(i, j), 1e-5f * std::abs(expectedL(i, i)));
+            EXPECT_NEAR(packed[8](i, j), expectedPacked(i, j), 1e-5f * std::abs(expectedPacked(i, i)));
+        }
+    }
+}
+
+template<size_t N, size_t M>
+static void expectLeastSquares()
+{
+    auto a = std::make_unique<Matrix<double, N, M>>();
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < M; ++j) {
+            (*a)(i, j) = std::sin(static_cast<double>(i * M + j + 1)) + (i == j ? 4.0 : 0.0);
+        }
+    }
+    auto qr = std::make_unique<QR<double, N, M>>(*a);
+    EXPECT_TRUE(qr->fullRank());
+
+    // Q R = A with orthonormal columns in Q.
+    auto q = std::make_unique<Matrix<double, N, M>>(qr->thinQ());
+    auto r = std::make_unique<Matrix<double, M, M>>(qr->matrixR());
+    for (size_t i = 0; i < N; i += 3) {
+        for (size_t j = 0; j < M; ++j) {
+            double sum = 0.0;
+            for (size_t k = 0; k <= j; ++k) {
+                sum += (*q)(i, k) * (*r)(k, j);
+            }
+            EXPECT_NEAR(sum, (*a)(i, j), 1e-10);
+        }
+    }
+    for (size_t j = 0; j < M; j += 5) {
+        double dot = 0.0;
+        for (size_t i = 0; i < N; ++i) {
+            dot += (*q)(i, j) * (*q)(i, M - 1 - j);
+        }
+        EXPECT_NEAR(dot, j == M - 1 - j ? 1.0 : 0.0, 1e-10);
+    }
+
+    // b = A x + a residual orthogonal to the columns of A, so the least squares solution is x.
+    Vector<double, M> expected;
+    for (size_t j = 0; j < M; ++j) {
+        expected[j] = static_cast<double>(j % 7) - 3.0;
+    }
+    Vector<double, N> b;
+    for (size_t i = 0; i < N; ++i) {
+        b[i] = (*a)[i].dot(expected);
+    }
+    // e_M - Q Q^T e_M
+    for (size_t i = 0; i < N; ++i) {
+        b[i] += i == M ? 1.0 : 0.0;
+        for (size_t j = 0; j < M; ++j) {
+            b[i] -= (*q)(i, j) * (*q)(M, j);
+        }
+    }
+    Vector<double, M> x = qr->leastSquares(b);
+    for (size_t j = 0; j < M; ++j) {
+        EXPECT_NEAR(x[j], expected[j], 1e-9);
+    }
+}
+
+TEST_F(MatrixTest, QRLeastSquares)
+{
+    expectLeastSquares<64, 6>();
+    // Several compact WY panels and a partial last one.
+    expectLeastSquares<200, 150>();
+
+    Mat3x3D square = getInvertible<double, 3>();
+    Vec3D x = square.qr().solve(Vec3D(1.0, 2.0, 3.0));
+    Matrix<double, 3, 1> product = square.matMult(x);
+    EXPECT_NEAR(product(0, 0), 1.0, 1e-12);
+    EXPECT_NEAR(product(1, 0), 2.0, 1e-12);
+    EXPECT_NEAR(product(2, 0), 3.0, 1e-12);
+
+    EXPECT_FALSE((Matrix<double, 4, 2>({{1, 2}, {2, 4}, {3, 6}, {4, 8}}).qr().fullRank()));
+}
+
+TEST_F(MatrixTest, BatchLeastSquares)
+{
+    // Not a multiple of any SIMD width, so the last group is partial.
+    constexpr size_t count = 11;
+    std::vector<Matrix<float, 16, 3>> a(count);
+    std::vector<Vector<float, 16>> b(count);
+    for (size_t n = 0; n < count; ++n) {
+        for (size_t i = 0; i < 16; ++i) {
+            float t = static_cast<float>(i) / 4.0f;
+            a[n](i, 0) = 1.0f;
+            a[n](i, 1) = t;
+            a[n](i, 2) = t * t;
+            // A quadratic with per problem coefficients plus a small alternating error.
+            b[n][i] = static_cast<float>(n) + 2.0f * t - 0.5f * t * t + (i % 2 ? 1e-3f : -1e-3f);
+        }
+    }
+    a[5] = Matrix<float, 16, 3>();
+    std::vector<Vector<float, 3>> x(count);
+
+    EXPECT_EQ((leastSquares<float, 16, 3>(a, b, x)), 1u);
+    for (size_t n = 0; n < count; ++n) {
+        if (n == 5) {
+            EXPECT_EQ(x[n], (Vector<float, 3>(0.0f)));
+            continue;
+        }
+        Vector<float, 3> expected = a[n].qr().leastSquares(b[n]);
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(x[n][j], expected[j], 1e-4f);
+        }
+        EXPECT_NEAR(x[n][0], static_cast<float>(n), 1e-2f);
+        EXPECT_NEAR(x[n][1], 2.0f, 1e-2f);
+    }
+}
+
+template<size_t N, size_t M>
+static Matrix<double, N, M> getChainFactor(double seed)
+{
+    Matrix<double, N, M> m;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < M; ++j) {
+            m(i, j) = std::sin(seed + static_cast<double>(i * M + j));
+        }
+    }
+    return m;
+}
+
+TEST_F(MatrixTest, MatMultChain)
+{
+    // The textbook chain with dimensions 30, 35, 15, 5, 10, 20, 25.
+    auto a0 = getChainFactor<30, 35>(0.0);
+    auto a1 = getChainFactor<35, 15>(1.0);
+    auto a2 = getChainFactor<15, 5>(2.0);
+    auto a3 = getChainFactor<5, 10>(3.0);
+    auto a4 = getChainFactor<10, 20>(4.0);
+    auto a5 = getChainFactor<20, 25>(5.0);
+    constexpr auto order = matMultChainOrder<decltype(a0), decltype(a1), decltype(a2), decltype(a3), decltype(a4),
+                                             decltype(a5)>();
+    static_assert(order.flops == 2 * 15125);
+    static_assert(order.parenthesization() == "((A0 (A1 A2)) ((A3 A4) A5))");
+    EXPECT_EQ(order.leftToRightFlops, 2u * (30 * 35 * 15 + 30 * 15 * 5 + 30 * 5 * 10 + 30 * 10 * 20 + 30 * 20 * 25));
+
+    Matrix<double, 30, 25> chained = matMultChain(a0, a1, a2, a3, a4, a5);
+    Matrix<double, 30, 25> leftToRight = a0.matMult(a1).matMult(a2).matMult(a3).matMult(a4).matMult(a5);
+    for (size_t i = 0; i < 30; ++i) {
+        for (size_t j = 0; j < 25; ++j) {
+            EXPECT_NEAR(chained(i, j), leftToRight(i, j), 1e-9);
+        }
+    }
+
+    // Ties keep the left to right order, and short chains are trivial.
+    static_assert(matMultChainOrder<Mat4x4D, Mat4x4D, Mat4x4D>().parenthesization() == "((A0 A1) A2)");
+    static_assert(matMultChainOrder<Mat2x3F, Mat3x4F>().flops == 2 * 24);
+    static_assert(matMultChainOrder<Mat2x3F>().parenthesization() == "A0");
+    static_assert(matMultChain(getMatrix(), getMatrix(), Mat4x4I64::identity()) == getMatrix().matMult(getMatrix()));
+    EXPECT_TRUE((matMultChain(a2) == a2));
+}
+
+TEST_F(MatrixTest, Gemm)
+{
+    auto a = getChainFactor<9, 7>(0.0);
+    auto b = getChainFactor<7, 11>(1.0);
+    auto c0 = getChainFactor<9, 11>(2.0);
+    Vector<double, 11> bias;
+    for (size_t j = 0; j < 11; ++j) {
+        bias[j] = 0.1 * static_cast<double>(j) - 0.5;
+    }
+    Matrix<double, 9, 11> product = a.matMult(b);
+
+    Matrix<double, 9, 11> c = c0;
+    gemm(2.0, a, b, -0.5, c);
+    for (size_t i = 0; i < 9; ++i) {
+        for (size_t j = 0; j < 11; ++j) {
+            EXPECT_NEAR(c(i, j), 2.0 * product(i, j) - 0.5 * c0(i, j), 1e-12);
+        }
+    }
+
+    c = c0;
+    gemm(1.0, a, b, 1.0, c, bias, [](double v) { return v > 0.0 ? v : 0.0; });
+    for (size_t i = 0; i < 9; ++i) {
+        for (size_t j = 0; j < 11; ++j) {
+            EXPECT_NEAR(c(i, j), std::max(product(i, j) + c0(i, j) + bias[j], 0.0), 1e-12);
+        }
+    }
+
+    // With beta 0 the old C is never read, and the epilogue may take the position of the element.
+    Matrix<float, 9, 11> f;
+    f(0, 0) = std::numeric_limits<float>::quiet_NaN();
+    Matrix<float, 9, 7> af;
+    Matrix<float, 7, 11> bf;
+    for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 11; ++j) {
+            bf(i, j) = static_cast<float>(b(i, j));
+        }
+        for (size_t j = 0; j < 9; ++j) {
+            af(j, i) = static_cast<float>(a(j, i));
+        }
+    }
+    gemm(1.0f, af, bf, 0.0f, f, [](float v, size_t i, size_t j) { return v + static_cast<float>(i * 100 + j); });
+    for (size_t i = 0; i < 9; ++i) {
+        for (size_t j = 0; j < 11; ++j) {
+            EXPECT_NEAR(f(i, j), product(i, j) + static_cast<double>(i * 100 + j), 1e-4);
+        }
+    }
+
+    // Narrow integers accumulate and are returned in the wider type.
+    Matrix<int8_t, 2, 3> i8({{127, 127, 127},
+                             {-128, 1, 2}});
+    Matrix<int32_t, 2, 2> i32;
+    gemm(1, i8, i8.transpose(), 0, i32);
+    EXPECT_EQ(i32(0, 0), 3 * 127 * 127);
+    EXPECT_EQ(i32(1, 1), 128 * 128 + 1 + 4);
+
+    // Subtraction and element-wise multiplication return their results.
+    EXPECT_TRUE((getMatrix() - getMatrix() == Mat4x4I64()));
+    EXPECT_EQ((getMatrix() * getMatrix())(1, 2), 49);
+}
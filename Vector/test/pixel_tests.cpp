@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "MathUtils/Vector/Pixel.h"
+
+using namespace MathUtils;
+
+class PixelTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Odd count so both the SIMD body and the scalar tail run.
+        for (uint32_t i = 0; i < 37; ++i) {
+            pixels.emplace_back(static_cast<uint8_t>(i * 7), static_cast<uint8_t>(255 - i * 3),
+                                static_cast<uint8_t>(i * 13 + 5), static_cast<uint8_t>(i * 29 % 256));
+        }
+    }
+
+    void TearDown() override
+    {}
+
+    std::vector<Pixel> pixels;
+};
+
+
+TEST_F(PixelTest, Premultiply)
+{
+    std::vector<Pixel> result = pixels;
+    premultiply(result);
+
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        double alpha = pixels[i][3] / 255.0;
+        for (size_t c = 0; c < 3; ++c) {
+            EXPECT_EQ(result[i][c], static_cast<uint8_t>(std::lround(pixels[i][c] * alpha)));
+        }
+        EXPECT_EQ(result[i][3], pixels[i][3]);
+    }
+}
+
+TEST_F(PixelTest, BlendOver)
+{
+    std::vector<Pixel> src = pixels;
+    premultiply(src);
+    std::vector<Pixel> dst(pixels.size(), Pixel(uint8_t(10), uint8_t(20), uint8_t(30), uint8_t(255)));
+    blendOver(src, dst);
+
+    for (size_t i = 0; i < src.size(); ++i) {
+        double inverse = 1.0 - src[i][3] / 255.0;
+        EXPECT_EQ(dst[i][0], static_cast<uint8_t>(src[i][0] + std::lround(10 * inverse)));
+        EXPECT_EQ(dst[i][2], static_cast<uint8_t>(src[i][2] + std::lround(30 * inverse)));
+        EXPECT_EQ(dst[i][3], 255);
+    }
+}
+
+TEST_F(PixelTest, SwizzleChannels)
+{
+    std::vector<Pixel> result = pixels;
+    swizzleChannels<2, 1, 0, 3>(result);
+
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        EXPECT_EQ(result[i], Pixel(pixels[i][2], pixels[i][1], pixels[i][0], pixels[i][3]));
+    }
+}
+
+TEST_F(PixelTest, GammaLut)
+{
+    std::array<uint8_t, 256> identity = gammaLut(1.0f);
+    std::vector<Pixel> result = pixels;
+    applyLut(result, identity);
+    EXPECT_EQ(result, pixels);
+
+    std::array<uint8_t, 256> lut = gammaLut(2.2f);
+    EXPECT_EQ(lut[0], 0);
+    EXPECT_EQ(lut[255], 255);
+    EXPECT_EQ(lut[128], 56);
+}
+
+TEST_F(PixelTest, FloatConversion)
+{
+    std::vector<Vector<float, 4>> floats(pixels.size(), Vector<float, 4>(0.0f));
+    pixelsToFloat(pixels, floats);
+    EXPECT_FLOAT_EQ(floats[1][1], 252.0f / 255.0f);
+
+    std::vector<Pixel> result(pixels.size(), Pixel(uint8_t(0)));
+    pixelsFromFloat(floats, result);
+    EXPECT_EQ(result, pixels);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "MathUtils/Vector/Quantized.h"
+
+using namespace MathUtils;
+
+class QuantizedTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+
+TEST_F(QuantizedTest, QuantizeDequantize)
+{
+    std::vector<float> values = {-1.0f, -0.5f, 0.0f, 0.25f, 1.0f, 3.0f};
+    std::vector<int8_t> quantized(values.size());
+    std::vector<float> restored(values.size());
+
+    quantize(values, 0.25f, 0, quantized);
+    EXPECT_EQ(quantized, (std::vector<int8_t>{-4, -2, 0, 1, 4, 12}));
+
+    dequantize(quantized, 0.25f, 0, restored);
+    EXPECT_EQ(restored, values);
+
+    // Out of range values saturate instead of wrapping.
+    quantize(std::vector<float>{1000.0f, -1000.0f}, 1.0f, 0, std::span(quantized).first(2));
+    EXPECT_EQ(quantized[0], QuantizedMax);
+    EXPECT_EQ(quantized[1], -QuantizedMax);
+}
+
+TEST_F(QuantizedTest, WideningDotDoesNotOverflow)
+{
+    std::vector<int8_t> a(1000, 127);
+    std::vector<int8_t> b(1000, -127);
+    b[999] = 5;
+
+    EXPECT_EQ(dotInt8(a, b), 999 * 127 * -127 + 127 * 5);
+}
+
+TEST_F(QuantizedTest, FullRangeDot)
+{
+    // -128 has no positive counterpart in int8, so negating it inside a SIMD kernel would wrap.
+    std::vector<int8_t> a(200, -128);
+    std::vector<int8_t> b(200, -128);
+    EXPECT_EQ(dotInt8(a, b), 200 * 128 * 128);
+
+    int32_t expected = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<int8_t>(static_cast<int32_t>(i * 41 % 256) - 128);
+        b[i] = static_cast<int8_t>(static_cast<int32_t>(i * 73 % 256) - 128);
+        expected += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    }
+    EXPECT_EQ(dotInt8(a, b), expected);
+    std::fill(b.begin(), b.end(), -128);
+    EXPECT_EQ(dotInt8(b, a), dotInt8(a, b));
+}
+
+TEST_F(QuantizedTest, QuantizedVectorDot)
+{
+    Vector<float, 100> x(0.0f);
+    Vector<float, 100> y(0.0f);
+    for (size_t i = 0; i < 100; ++i) {
+        x[i] = std::sin(static_cast<float>(i));
+        y[i] = std::cos(static_cast<float>(i) * 0.5f);
+    }
+
+    auto qx = QuantizedVector<100>::quantize(x);
+    auto qy = QuantizedVector<100>::quantize(y);
+    EXPECT_NEAR(qx.dot(qy), x.dot(y), 0.05f);
+
+    auto ax = QuantizedVector<100>::quantize(x, 1.0f / 64.0f, 10);
+    auto ay = QuantizedVector<100>::quantize(y, 1.0f / 64.0f, -7);
+    EXPECT_NEAR(ax.dot(ay), ax.dequantize().dot(ay.dequantize()), 1e-3f);
+}
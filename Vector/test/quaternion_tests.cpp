@@ -0,0 +1,78 @@
+#define USING_FLOATING_QUATERNION_TYPES
+#define USING_FLOATING_VECTOR_TYPES
+
+#include <gtest/gtest.h>
+#include <numbers>
+#include <vector>
+#include "MathUtils/Vector/Quaternion.h"
+
+using namespace MathUtils;
+
+class QuaternionTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+static void expectNear(const Vec3F &a, const Vec3F &b, float tolerance = 1e-5f)
+{
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(a[i], b[i], tolerance);
+    }
+}
+
+TEST_F(QuaternionTest, RotateAndMultiply)
+{
+    constexpr float quarter = std::numbers::pi_v<float> / 2.0f;
+    QuatF z = QuatF::fromAxisAngle(Vec3F(0.0f, 0.0f, 1.0f), quarter);
+    QuatF x = QuatF::fromAxisAngle(Vec3F(1.0f, 0.0f, 0.0f), quarter);
+
+    expectNear(z.rotate(Vec3F(1.0f, 0.0f, 0.0f)), Vec3F(0.0f, 1.0f, 0.0f));
+    // x * z rotates about z first, then about x.
+    expectNear((x * z).rotate(Vec3F(1.0f, 0.0f, 0.0f)), Vec3F(0.0f, 0.0f, 1.0f));
+    expectNear((z * z.inverse()).rotate(Vec3F(1.0f, 2.0f, 3.0f)), Vec3F(1.0f, 2.0f, 3.0f));
+
+    QuatF q = QuatF(Vec4F(1.0f, 2.0f, 3.0f, 4.0f)).normalize();
+    EXPECT_NEAR(q.length(), 1.0f, 1e-6f);
+    Matrix<float, 3, 3> m = q.toMatrix();
+    Vec3F v(0.5f, -1.0f, 2.0f);
+    Vec3F expected = q.rotate(v);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(m[i].dot(v), expected[i], 1e-5f);
+    }
+}
+
+TEST_F(QuaternionTest, Interpolation)
+{
+    constexpr float pi = std::numbers::pi_v<float>;
+    QuatF a;
+    QuatF b = QuatF::fromAxisAngle(Vec3F(0.0f, 1.0f, 0.0f), pi / 2.0f);
+
+    QuatF halfway = slerp(a, b, 0.5f);
+    expectNear(halfway.rotate(Vec3F(1.0f, 0.0f, 0.0f)), Vec3F(std::cos(pi / 4.0f), 0.0f, -std::sin(pi / 4.0f)));
+    expectNear(slerp(a, -b, 1.0f).rotate(Vec3F(1.0f, 0.0f, 0.0f)), Vec3F(0.0f, 0.0f, -1.0f));
+    expectNear(nlerp(a, b, 0.5f).rotate(Vec3F(1.0f, 0.0f, 0.0f)), halfway.rotate(Vec3F(1.0f, 0.0f, 0.0f)));
+    EXPECT_NEAR(slerp(a, a, 0.3f).length(), 1.0f, 1e-6f);
+}
+
+TEST_F(QuaternionTest, BatchRotate)
+{
+    QuatF q = QuatF(Vec4F(0.3f, -0.2f, 0.9f, 0.4f)).normalize();
+    std::vector<Vec3F> points;
+    for (int i = 0; i < 19; ++i) {
+        points.emplace_back(static_cast<float>(i), static_cast<float>(i % 5) - 2.0f, 0.25f * static_cast<float>(i));
+    }
+    std::vector<Vec3F> expected = points;
+    for (Vec3F &p : expected) {
+        p = q.rotate(p);
+    }
+
+    rotate(q, std::span<Vec3F>(points));
+    for (size_t i = 0; i < points.size(); ++i) {
+        expectNear(points[i], expected[i], 1e-4f);
+    }
+}
@@ -0,0 +1,280 @@
+#define USING_DOUBLE_SPARSE_TYPES
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "MathUtils/Vector/SparseMatrix.h"
+
+using namespace MathUtils;
+
+class SparseTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {}
+
+    void TearDown() override
+    {}
+};
+
+// A 5 x 7 matrix with empty rows and columns, in shuffled order with duplicates.
+static std::vector<Triplet<double>> getTriplets()
+{
+    return {{3, 6, 1.5}, {0, 0, 2.0}, {4, 2, -1.0}, {0, 5, 3.0}, {3, 1, 4.0}, {0, 0, 0.5}, {4, 6, 2.5},
+            {3, 6, -0.5}, {1, 3, 7.0}, {4, 0, -2.0}};
+}
+
+static Matrix<double, 5, 7> getDense()
+{
+    return Matrix<double, 5, 7>({{2.5, 0, 0, 0, 0, 3.0, 0},
+                                 {0, 0, 0, 7.0, 0, 0, 0},
+                                 {0, 0, 0, 0, 0, 0, 0},
+                                 {0, 4.0, 0, 0, 0, 0, 1.0},
+                                 {-2.0, 0, -1.0, 0, 0, 0, 2.5}});
+}
+
+template<SparseStorage S>
+static void expectEqualsDense(const SparseMatrix<double, S> &sparse, const Matrix<double, 5, 7> &dense)
+{
+    ASSERT_EQ(sparse.rows(), 5u);
+    ASSERT_EQ(sparse.cols(), 7u);
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 7; ++j) {
+            EXPECT_EQ(sparse(i, j), dense(i, j));
+        }
+    }
+}
+
+TEST_F(SparseTest, FromTriplets)
+{
+    std::vector<Triplet<double>> triplets = getTriplets();
+    SparseMatrixD csr = SparseMatrixD::fromTriplets(5, 7, triplets);
+    SparseMatrixCscD csc = SparseMatrixCscD::fromTriplets(5, 7, triplets);
+
+    EXPECT_EQ(csr.nonZeros(), 8u);
+    EXPECT_EQ(csc.nonZeros(), 8u);
+    expectEqualsDense(csr, getDense());
+    expectEqualsDense(csc, getDense());
+    EXPECT_EQ((std::vector<size_t>(csr.outerStarts().begin(), csr.outerStarts().end())),
+              (std::vector<size_t>{0, 2, 3, 3, 5, 8}));
+    EXPECT_EQ((std::vector<uint32_t>(csr.indices().begin(), csr.indices().end())),
+              (std::vector<uint32_t>{0, 5, 3, 1, 6, 0, 2, 6}));
+
+    EXPECT_TRUE((csr.toDense<5, 7>() == getDense()));
+    EXPECT_TRUE((csc.toDense<5, 7>() == getDense()));
+    EXPECT_TRUE((SparseMatrixCscD::fromDense(getDense()).toDense<5, 7>() == getDense()));
+    EXPECT_EQ(SparseMatrixD::fromDense(getDense()).nonZeros(), 8u);
+
+    SparseMatrixD empty = SparseMatrixD::fromTriplets(3, 2, std::vector<Triplet<double>>());
+    EXPECT_EQ(empty.nonZeros(), 0u);
+    EXPECT_EQ(empty(2, 1), 0.0);
+}
+
+TEST_F(SparseTest, TransposeAndConvert)
+{
+    SparseMatrixD csr = SparseMatrixD::fromTriplets(5, 7, getTriplets());
+    SparseMatrixCscD csc = csr.toStorage<SparseStorage::CompressedColumns>();
+    expectEqualsDense(csc, getDense());
+    expectEqualsDense(csc.toStorage<SparseStorage::CompressedRows>(), getDense());
+
+    SparseMatrixD transposed = csr.transpose();
+    EXPECT_EQ(transposed.rows(), 7u);
+    EXPECT_EQ(transposed.cols(), 5u);
+    EXPECT_TRUE((transposed.toDense<7, 5>() == getDense().transpose()));
+    EXPECT_TRUE((csc.transpose().toDense<7, 5>() == getDense().transpose()));
+    expectEqualsDense(transposed.transpose(), getDense());
+}
+
+TEST_F(SparseTest, MultiplyVector)
+{
+    SparseMatrixD csr = SparseMatrixD::fromTriplets(5, 7, getTriplets());
+    SparseMatrixCscD csc = SparseMatrixCscD::fromTriplets(5, 7, getTriplets());
+    Vector<double, 7> x(1.0, -2.0, 0.5, 3.0, 4.0, -1.5, 2.0);
+    Matrix<double, 5, 1> expected = getDense().matMult(x);
+
+    Vector<double, 5> y(9.0);
+    csr.multiply(x, y);
+    Vector<double, 5> z(9.0);
+    csc.multiply(x, z);
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_DOUBLE_EQ(y[i], expected(i, 0));
+        EXPECT_DOUBLE_EQ(z[i], expected(i, 0));
+    }
+}
+
+TEST_F(SparseTest, MultiplyMatrix)
+{
+    SparseMatrixD csr = SparseMatrixD::fromTriplets(5, 7, getTriplets());
+    SparseMatrixCscD csc = SparseMatrixCscD::fromTriplets(5, 7, getTriplets());
+    Matrix<double, 7, 3> b;
+    for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            b(i, j) = std::sin(static_cast<double>(i * 3 + j + 1));
+        }
+    }
+    Matrix<double, 5, 3> expected = getDense().matMult(b);
+
+    Matrix<double, 5, 3> c;
+    csr.multiply(b, c);
+    Matrix<double, 5, 3> d;
+    csc.multiply(b, d);
+
+    std::vector<double> flatB;
+    for (size_t i = 0; i < 7; ++i) {
+        flatB.insert(flatB.end(), b[i].data.begin(), b[i].data.end());
+    }
+    std::vector<double> flatC(15, 9.0);
+    csr.multiply(flatB, 3, flatC);
+    std::vector<double> flatD(15, 9.0);
+    csc.multiply(flatB, 3, flatD);
+
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(c(i, j), expected(i, j), 1e-12);
+            EXPECT_NEAR(d(i, j), expected(i, j), 1e-12);
+            EXPECT_NEAR(flatC[i * 3 + j], expected(i, j), 1e-12);
+            EXPECT_NEAR(flatD[i * 3 + j], expected(i, j), 1e-12);
+        }
+    }
+}
+
+TEST_F(SparseTest, LargeFromTriplets)
+{
+    // A pentadiagonal matrix in reverse row order, with every other element split into two duplicates.
+    constexpr size_t n = 20000;
+    std::vector<Triplet<double>> triplets;
+    for (size_t i = n; i-- > 0;) {
+        for (size_t j = (i >= 2 ? i - 2 : 0); j <= std::min(i + 2, n - 1); ++j) {
+            double value = static_cast<double>(i) - 0.5 * static_cast<double>(j);
+            if ((i + j) % 2 == 0) {
+                triplets.push_back({i, j, value * 0.25});
+                triplets.push_back({i, j, value * 0.75});
+            } else {
+                triplets.push_back({i, j, value});
+            }
+        }
+    }
+    SparseMatrixD a = SparseMatrixD::fromTriplets(n, n, triplets);
+    EXPECT_EQ(a.nonZeros(), 5 * n - 6);
+
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = std::cos(static_cast<double>(i));
+    }
+    std::vector<double> y(n);
+    a.multiply(x, y);
+    std::vector<double> z(n);
+    a.toStorage<SparseStorage::CompressedColumns>().multiply(x, z);
+    for (size_t i = 0; i < n; i += 97) {
+        double expected = 0.0;
+        for (size_t j = (i >= 2 ? i - 2 : 0); j <= std::min(i + 2, n - 1); ++j) {
+            expected += (static_cast<double>(i) - 0.5 * static_cast<double>(j)) * x[j];
+        }
+        EXPECT_NEAR(y[i], expected, 1e-9 * static_cast<double>(n));
+        EXPECT_NEAR(z[i], expected, 1e-9 * static_cast<double>(n));
+    }
+}
+
+// A power-law-like matrix: a few huge rows, many short ones and some empty ones.
+static SparseMatrixD getSkewed(size_t n)
+{
+    std::vector<Triplet<double>> triplets;
+    for (size_t i = 0; i < n; ++i) {
+        size_t length = i % 97 == 0 ? n / 2 : (i % 5 == 0 ? 0 : i % 7 + 1);
+        for (size_t k = 0; k < length; ++k) {
+            size_t j = (i * 31 + k * 17) % n;
+            triplets.push_back({i, j, std::sin(static_cast<double>(i + 3 * j))});
+        }
+    }
+    return SparseMatrixD::fromTriplets(n, n, triplets);
+}
+
+static std::vector<double> getX(size_t n)
+{
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = std::cos(static_cast<double>(i) * 0.5);
+    }
+    return x;
+}
+
+TEST_F(SparseTest, MergePathMultiply)
+{
+    constexpr size_t n = 1000;
+    SparseMatrixD a = getSkewed(n);
+    std::vector<double> x = getX(n);
+    std::vector<double> expected(n);
+    a.multiply(x, expected);
+
+    for (size_t parts: {1, 2, 3, 7, 64, 100000}) {
+        std::vector<double> y(n, 9.0);
+        a.multiplyMergePath(x, y, parts);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_NEAR(y[i], expected[i], 1e-10);
+        }
+        std::vector<double> z(n, -9.0);
+        a.multiplyMergePath(x, z, parts);
+        EXPECT_EQ(y, z);
+    }
+
+    std::vector<double> empty;
+    SparseMatrixD().multiplyMergePath(empty, empty, 4);
+    std::vector<double> zeros(3, 9.0);
+    SparseMatrixD(3, 2).multiplyMergePath(std::vector<double>(2, 1.0), zeros, 4);
+    EXPECT_EQ(zeros, std::vector<double>(3, 0.0));
+}
+
+TEST_F(SparseTest, SlicedEllpackMultiply)
+{
+    constexpr size_t n = 1001;
+    SparseMatrixD a = getSkewed(n);
+    std::vector<double> x = getX(n);
+    std::vector<double> expected(n);
+    a.multiply(x, expected);
+
+    for (size_t sigma: {1, 8, 64, 2048}) {
+        SlicedEllpackMatrix<double> sell(a, sigma);
+        EXPECT_EQ(sell.rows(), n);
+        EXPECT_GE(sell.storedElements(), a.nonZeros());
+        std::vector<double> y(n, 9.0);
+        sell.multiply(x, y);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_NEAR(y[i], expected[i], 1e-10);
+        }
+    }
+    // Sorting over the whole matrix needs no more padding than sorting each slice alone.
+    EXPECT_LE(SlicedEllpackMatrix<double>(a, n).storedElements(), SlicedEllpackMatrix<double>(a, 1).storedElements());
+}
+
+TEST_F(SparseTest, SlicedEllpackPaddingIgnoresX)
+{
+    // Rows of 0 to 4 nonzeros, so most slices are padded. Only every ninth row references column 0.
+    constexpr size_t n = 37;
+    std::vector<Triplet<double>> triplets;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t t = 0; t < i % 5; ++t) {
+            triplets.push_back({i, 1 + (i * 3 + t * 7) % 39, 1.0 + double(t)});
+        }
+        if (i % 9 == 0) {
+            triplets.push_back({i, 0, 2.0});
+        }
+    }
+    SparseMatrixD a = SparseMatrixD::fromTriplets(n, 40, triplets);
+    SlicedEllpackMatrix<double> sell(a);
+    ASSERT_GT(sell.storedElements(), a.nonZeros());
+
+    for (double special: {INFINITY, NAN}) {
+        std::vector<double> x(40, 1.0);
+        x[0] = special;
+        std::vector<double> expected(n);
+        std::vector<double> y(n);
+        a.multiply(x, expected);
+        sell.multiply(x, y);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(std::isfinite(y[i]), i % 9 != 0);
+            if (i % 9 != 0) {
+                EXPECT_EQ(y[i], expected[i]);
+            }
+        }
+    }
+}
@@ -308,4 +308,241 @@ TEST_F(VectorTest, LessThanOrEqual)
     EXPECT_TRUE(v1 <= Vec4I64(1, 2, 3, 0));
 
     EXPECT_FALSE(v1 <= Vec2I64(1, 2));
-}
\ No newline at end of file
+}
+
+TEST_F(VectorTest, LargeVectorArithmetic)
+{
+    using Vec100I64 = Vector<int64_t, 100>;
+    Vec100I64 v1(int64_t(2));
+    Vec100I64 v2(int64_t(3));
+
+    Vec100I64 sum = v1 + v2;
+    EXPECT_EQ(sum, Vec100I64(int64_t(5)));
+
+    v1 *= v2;
+    EXPECT_EQ(v1, Vec100I64(int64_t(6)));
+}
+
+TEST_F(VectorTest, LargeVectorDotProduct)
+{
+    Vector<int64_t, 101> v1(int64_t(0));
+    Vector<int64_t, 101> v2(int64_t(0));
+    int64_t expected = 0;
+    for (size_t i = 0; i < 101; ++i) {
+        v1[i] = static_cast<int64_t>(i);
+        v2[i] = static_cast<int64_t>(i % 7) - 3;
+        expected += v1[i] * v2[i];
+    }
+
+    EXPECT_EQ(v1.dot(v2), expected);
+
+    Vector<float, 768> f1(1.0f);
+    Vector<float, 768> f2(0.5f);
+    EXPECT_FLOAT_EQ(f1.dot(f2), 384.0f);
+}
+
+TEST_F(VectorTest, FusedMultiplyAdd)
+{
+    Vec3I64 a(1, 2, 3);
+    Vec3I64 b(4, 5, 6);
+    Vec3I64 c(7, 8, 9);
+
+    EXPECT_EQ(fma(a, b, c), Vec3I64(11, 18, 27));
+    EXPECT_EQ(fma(a, 2, c), Vec3I64(9, 12, 15));
+    EXPECT_EQ(a.madd(b, c), Vec3I64(11, 18, 27));
+
+    axpy(3, a, c);
+    EXPECT_EQ(c, Vec3I64(10, 14, 18));
+}
+
+TEST_F(VectorTest, Lerp)
+{
+    Vector<double, 2> a(1.0, -2.0);
+    Vector<double, 2> b(3.0, 6.0);
+
+    EXPECT_EQ(lerp(a, b, 0.0), a);
+    EXPECT_EQ(lerp(a, b, 1.0), b);
+    EXPECT_EQ(lerp(a, b, 0.5), (Vector<double, 2>(2.0, 2.0)));
+}
+
+TEST_F(VectorTest, BatchedAxpyAndLerp)
+{
+    std::vector<Vec2I64> x = {Vec2I64(1, 2), Vec2I64(3, 4)};
+    std::vector<Vec2I64> y = {Vec2I64(10, 20), Vec2I64(30, 40)};
+
+    axpy(2, x, std::span(y));
+    EXPECT_EQ(y[0], Vec2I64(12, 24));
+    EXPECT_EQ(y[1], Vec2I64(36, 48));
+
+    std::vector<Vec2I64> out(2, Vec2I64(0, 0));
+    lerp(x, y, 1, std::span(out));
+    EXPECT_EQ(out[0], y[0]);
+    EXPECT_EQ(out[1], y[1]);
+}
+
+TEST_F(VectorTest, ComponentWiseComparison)
+{
+    Vec3I64 v1(1, 5, 3);
+    Vec3I64 v2(4, 2, 3);
+
+    Mask<3> lt = lessThan(v1, v2);
+    EXPECT_EQ(lt, Mask<3>({true, false, false}));
+    EXPECT_EQ(lessThanEqual(v1, v2), Mask<3>({true, false, true}));
+    EXPECT_EQ(greaterThan(v1, v2), ~lessThanEqual(v1, v2));
+    EXPECT_EQ(equal(v1, v2), Mask<3>({false, false, true}));
+
+    EXPECT_TRUE(any(lt));
+    EXPECT_FALSE(all(lt));
+    EXPECT_FALSE(none(lt));
+    EXPECT_TRUE(all(lessThanEqual(v1, v1)));
+    EXPECT_TRUE(none(notEqual(v1, v1)));
+}
+
+TEST_F(VectorTest, SelectMinMaxClampAbs)
+{
+    Vec3I64 v1(1, 5, -3);
+    Vec3I64 v2(4, 2, 3);
+
+    EXPECT_EQ(select(lessThan(v1, v2), v1, v2), min(v1, v2));
+    EXPECT_EQ(min(v1, v2), Vec3I64(1, 2, -3));
+    EXPECT_EQ(max(v1, v2), Vec3I64(4, 5, 3));
+    EXPECT_EQ(clamp(v1, 0, 4), Vec3I64(1, 4, 0));
+    EXPECT_EQ(clamp(v1, Vec3I64(2, 2, 2), Vec3I64(3, 3, 3)), Vec3I64(2, 3, 2));
+    EXPECT_EQ(abs(v1), Vec3I64(1, 5, 3));
+}
+
+TEST_F(VectorTest, Reductions)
+{
+    Vec4I64 v(3, -7, 5, 5);
+
+    EXPECT_EQ(v.sum(), 6);
+    EXPECT_EQ(v.product(), -525);
+    EXPECT_EQ(v.minElement(), -7);
+    EXPECT_EQ(v.maxElement(), 5);
+    EXPECT_EQ(v.argmin(), 1u);
+    EXPECT_EQ(v.argmax(), 2u);
+    EXPECT_EQ(v.squaredLength(), 108);
+    EXPECT_DOUBLE_EQ(v.norm<1>(), 20.0);
+    EXPECT_DOUBLE_EQ(v.norm<InfinityNorm>(), 7.0);
+    EXPECT_DOUBLE_EQ(Vec2I64(3, 4).length(), 5.0);
+}
+
+TEST_F(VectorTest, LargeVectorReductions)
+{
+    Vector<float, 256> scores(0.0f);
+    for (size_t i = 0; i < 256; ++i) {
+        scores[i] = static_cast<float>((i * 37) % 101);
+    }
+    scores[200] = 500.0f;
+    scores[17] = -1.0f;
+
+    EXPECT_EQ(scores.argmax(), 200u);
+    EXPECT_EQ(scores.argmin(), 17u);
+    EXPECT_FLOAT_EQ(scores.maxElement(), 500.0f);
+    EXPECT_FLOAT_EQ(scores.minElement(), -1.0f);
+
+    float expected = 0.0f;
+    for (size_t i = 0; i < 256; ++i) {
+        expected += scores[i];
+    }
+    EXPECT_FLOAT_EQ(scores.sum(), expected);
+    EXPECT_FLOAT_EQ(scores.sum<Summation::Deterministic>(), expected);
+    EXPECT_FLOAT_EQ(scores.norm<2>(), std::sqrt(scores.squaredLength()));
+}
+
+TEST_F(VectorTest, SummationPolicies)
+{
+    // One large term followed by many terms that a plain float sum rounds away.
+    Vector<float, 4096> v(0.0f);
+    v[0] = 1.0e8f;
+    double exact = 1.0e8;
+    for (size_t i = 1; i < 4096; ++i) {
+        v[i] = 1.0f + static_cast<float>(i % 3) * 0.25f;
+        exact += static_cast<double>(v[i]);
+    }
+
+    auto error = [&](float value) { return std::abs(static_cast<double>(value) - exact); };
+    const double ulp = 8.0; // Spacing of floats around 1e8.
+
+    EXPECT_LE(error(v.sum<Summation::Kahan>()), ulp);
+    EXPECT_LE(error(v.sum<Summation::Neumaier>()), ulp);
+    EXPECT_LE(error(v.sum<Summation::Widened>()), ulp);
+    EXPECT_LT(error(v.sum<Summation::Pairwise>()), error(v.sum<Summation::Fast>()));
+
+    Vector<float, 4096> ones(1.0f);
+    EXPECT_LE(error(v.dot<Summation::Neumaier>(ones)), ulp);
+    EXPECT_LE(error(v.dot<Summation::Widened>(ones)), ulp);
+    EXPECT_FLOAT_EQ(ones.squaredLength<Summation::Pairwise>(), 4096.0f);
+    EXPECT_FLOAT_EQ((ones.norm<1, Summation::Kahan>()), 4096.0f);
+}
+
+TEST_F(VectorTest, WideningAccumulators)
+{
+    Vector<int8_t, 64> a(int8_t(100));
+    Vector<int8_t, 64> b(int8_t(-100));
+
+    static_assert(std::is_same_v<decltype(a.dot(b)), int32_t>);
+    EXPECT_EQ(a.dot(b), 64 * -10000);
+    EXPECT_EQ(a.sum(), 6400);
+
+    Vector<uint8_t, 3> c(200, 200, 2);
+    EXPECT_EQ(c.sum(), 402u);
+    EXPECT_EQ(c.product(), 80000u);
+}
+
+TEST_F(VectorTest, SaturatingArithmetic)
+{
+    Vector<uint8_t, 20> a(uint8_t(200));
+    Vector<uint8_t, 20> b(uint8_t(100));
+    EXPECT_TRUE(all(equal(addSaturate(a, b), Vector<uint8_t, 20>(uint8_t(255)))));
+    EXPECT_TRUE(all(equal(subSaturate(b, a), Vector<uint8_t, 20>(uint8_t(0)))));
+
+    Vector<int16_t, 3> c(int16_t(30000), int16_t(-30000), int16_t(5));
+    Vector<int16_t, 3> d(int16_t(10000), int16_t(10000), int16_t(5));
+    EXPECT_EQ(addSaturate(c, d), (Vector<int16_t, 3>(int16_t(32767), int16_t(-20000), int16_t(10))));
+    EXPECT_EQ(subSaturate(c, d), (Vector<int16_t, 3>(int16_t(20000), int16_t(-32768), int16_t(0))));
+
+    Vec2I64 e(INT64_MAX - 1, INT64_MIN + 1);
+    EXPECT_EQ(addSaturate(e, Vec2I64(5, -5)), Vec2I64(INT64_MAX, INT64_MIN));
+    EXPECT_EQ(subSaturate(e, Vec2I64(-5, 5)), Vec2I64(INT64_MAX, INT64_MIN));
+}
+
+template<typename V>
+concept HasSwizzleXz = requires(const V &v) { v.xz(); };
+
+template<typename V>
+concept HasSwizzleWzyx = requires(const V &v) { v.wzyx(); };
+
+TEST_F(VectorTest, Swizzles)
+{
+    using Vec4 = Vector<float, 4>;
+    using Vec3 = Vector<float, 3>;
+    using Vec2 = Vector<float, 2>;
+    Vec4 v(1.0f, 2.0f, 3.0f, 4.0f);
+    EXPECT_EQ(v.w, 4.0f);
+    EXPECT_EQ((v.swizzle<2, 1, 0>()), Vec3(3.0f, 2.0f, 1.0f));
+    EXPECT_EQ(v.zyx(), Vec3(3.0f, 2.0f, 1.0f));
+    EXPECT_EQ(v.xxyy(), Vec4(1.0f, 1.0f, 2.0f, 2.0f));
+    EXPECT_EQ(v.wx(), Vec2(4.0f, 1.0f));
+
+    constexpr Vec2I64 a(5, 7);
+    static_assert(a.yx() == Vec2I64(7, 5));
+    static_assert(a.yyy() == Vec3I64(7, 7, 7));
+
+    // Named swizzles only read components the vector has, and only vectors of up to 4 elements have them.
+    static_assert(!HasSwizzleXz<Vec2I64> && HasSwizzleXz<Vec3I64>);
+    static_assert(HasSwizzleWzyx<Vec4> && !HasSwizzleWzyx<Vector<float, 4096>>);
+    static_assert(!HasSwizzleXz<Vector<float, 5>>);
+    Vector<float, 5> large(1.0f, 2.0f, 3.0f, 4.0f, 5.0f);
+    EXPECT_EQ((large.swizzle<4, 0>()), Vec2(5.0f, 1.0f));
+
+    Vec3I64 b(1, 2, 3);
+    b.swizzleRef<2, 0>() = Vec2I64(10, 30);
+    EXPECT_EQ(b, Vec3I64(30, 2, 10));
+    b.swizzleRef<0, 1, 2>() = b.zyx();
+    EXPECT_EQ(b, Vec3I64(10, 2, 30));
+    b.swizzleRef<1, 2>() += Vec2I64(1, 1);
+    EXPECT_EQ(b, Vec3I64(10, 3, 31));
+    Vec2I64 c = b.swizzleRef<2, 1>();
+    EXPECT_EQ(c, Vec2I64(31, 3));
+}